@@ -0,0 +1,469 @@
+/**
+ *
+ *
+ *      @author  Sean Hobeck
+ *       @date 2023-02-16
+ *
+ *
+ **/
+#pragma once
+
+/// @uses: std::atomic, std::atomic_thread_fence
+#include <atomic>
+
+/// @uses: std::thread, std::this_thread::yield
+#include <thread>
+
+/// @uses: std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <exception>
+
+/// @uses: std::tuple, std::apply
+#include <tuple>
+
+/// @uses: std::bit_ceil
+#include <bit>
+
+/// @uses: output_file, format_string, make_format_args
+#include "print.h"
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+    /// @brief What a print to an async_printer does when its queue is full.
+    enum class overflow_policy : unsigned char
+    {
+        /// Wait for the consumer to make room (nothing is lost, the calling thread stalls).
+        block,
+        /// Drop the message.
+        drop,
+        /// Drop the message and count it, the consumer writes how many were dropped once it catches up.
+        count_drops
+    };
+
+
+    namespace __detail {
+        /// @brief Whether an argument is copied into the queue as its characters (strings and character pointers).
+        template<typename T>
+        inline constexpr bool is_async_string_v = std::is_same_v<formatted_type_t<T>, const char*> ||
+            std::is_same_v<formatted_type_t<T>, char*> || is_string_like<formatted_type_t<T>, char>::value;
+
+        /// @brief Whether an argument can be copied into the queue, otherwise the message is formatted on the calling thread.
+        template<typename T>
+        inline constexpr bool is_async_copyable_v = is_async_string_v<T> || std::is_trivially_copyable_v<formatted_type_t<T>>;
+
+        /// @brief The type an argument is copied into the queue as, and handed to the consumer as.
+        template<typename T>
+        using async_stored_t = std::conditional_t<is_async_string_v<T>, std::string_view, formatted_type_t<T>>;
+
+        /// @brief Gets the bytes a stored argument takes in a queue slot.
+        template<typename T>
+        constexpr std::size_t
+        packed_size(const T& __v) noexcept
+        {
+            if constexpr (std::is_same_v<T, std::string_view>)
+                return sizeof(std::size_t) + __v.size();
+            else
+                return sizeof(T);
+        };
+
+        /// @brief Copies a stored argument into a queue slot (strings as their length and characters).
+        /// @param __p Where to copy it.
+        /// @param __v The stored argument.
+        /// @return One past the copy.
+        template<typename T>
+        inline std::byte*
+        pack(std::byte* __p, const T& __v) noexcept
+        {
+            if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                auto __n = __v.size();
+                std::memcpy(__p, &__n, sizeof(__n));
+                std::memcpy(__p + sizeof(__n), __v.data(), __n);
+                return __p + sizeof(__n) + __n;
+            }
+            else
+            {
+                std::memcpy(__p, std::addressof(__v), sizeof(T));
+                return __p + sizeof(T);
+            }
+        };
+
+        /// @brief Reads a stored argument back out of a queue slot (strings are viewed in place).
+        /// @param __p Where to read it, moved past it.
+        /// @return The stored argument.
+        template<typename T>
+        inline T
+        unpack(const std::byte*& __p) noexcept
+        {
+            if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                std::size_t __n;
+                std::memcpy(&__n, __p, sizeof(__n));
+                std::string_view __s(reinterpret_cast<const char*>(__p + sizeof(__n)), __n);
+                __p += sizeof(__n) + __n;
+                return __s;
+            }
+            else
+            {
+                alignas(T) std::byte __b[sizeof(T)];
+                std::memcpy(__b, __p, sizeof(T));
+                __p += sizeof(T);
+                return *std::launder(reinterpret_cast<T*>(__b));
+            }
+        };
+
+        /// @brief A queue slot, one message.
+        ///     The sequence number says whose turn the slot is (Vyukov's bounded queue): it is the position a producer
+        ///     may claim it at, one past that once the message is published, and a lap further once it is written out.
+        struct alignas(64) async_slot
+        {
+            /// The size of a slot.
+            static constexpr std::size_t size = 256;
+
+            /// The sequence number.
+            std::atomic<std::size_t> _seq;
+            /// Writes the message out.
+            void (*_write)(output_file&, const async_slot&);
+            /// The format string, referenced when it is a literal (checked at compile time, it outlives every message).
+            ///     A runtime_format() string may not outlive the print, then this is empty with a null data() and the
+            ///     format string is copied at the start of the message instead.
+            std::string_view _format;
+            /// The message, the stored arguments (or a string formatted on the calling thread).
+            std::byte _data[size - sizeof(std::atomic<std::size_t>) - sizeof(void (*)()) - sizeof(std::string_view)];
+        };
+
+        /// @brief Writes out a message copied into a slot, it is formatted here (on the consumer thread).
+        template<bool newline, typename ... stored_t>
+        void
+        write_packed(output_file& __file, const async_slot& __s)
+        {
+            auto __begin = __file.mark();
+            const std::byte* __p = __s._data;
+            auto __fmt = __s._format.data() != nullptr ? __s._format : unpack<std::string_view>(__p);
+
+            /// Braced initialization unpacks the arguments in order.
+            std::tuple<stored_t...> __args { unpack<stored_t>(__p)... };
+            std::apply([&](const stored_t&... __a)
+            {
+                vformat_to_buffer(__file, __fmt, format_args(make_format_args(__a...)));
+            }, __args);
+            if constexpr (newline)
+                __file.push_back('\n');
+            __file.commit(__begin, newline);
+        };
+
+        /// @brief Writes out a message that was already formatted (on the calling thread).
+        template<bool newline>
+        void
+        write_formatted(output_file& __file, const async_slot& __s)
+        {
+            const std::byte* __p = __s._data;
+            std::unique_ptr<std::string> __str(unpack<std::string*>(__p));
+            auto __begin = __file.mark();
+            __file.append(__str->data(), __str->data() + __str->size());
+            __file.commit(__begin, newline);
+        };
+    };
+
+
+    /// @brief Prints to an output_file from a background thread.
+    ///     A print copies its arguments into a bounded lock-free queue and returns, the consumer thread formats and writes
+    ///     them out in order (in the order of each thread, messages of different threads interleave). The format string is
+    ///     only referenced when it is a literal checked at compile time, a runtime_format() string is copied along.
+    ///     Strings are copied as their characters, other trivially copyable arguments as they are (so pointers in them have to
+    ///     stay valid until the message is written). Messages with other arguments, or too long for a slot, are formatted on
+    ///     the calling thread and handed over as a string.
+    ///     The file is flushed whenever the queue runs empty, and on destruction after everything queued is written out.
+    ///     Prints from any amount of threads are safe, the file must not be used directly while the printer exists.
+    class async_printer
+    {
+    private:
+
+        using slot = __detail::async_slot;
+
+        /// How often the consumer checks for more messages before it waits.
+        static constexpr int spin_count = 64;
+
+        /// The file.
+        output_file& _file;
+        /// What a print does when the queue is full.
+        overflow_policy _policy;
+        /// The amount of slots minus one (it is a power of two).
+        std::size_t _mask;
+        /// The slots.
+        std::unique_ptr<slot[]> _slots;
+        /// The next position producers claim.
+        alignas(64) std::atomic<std::size_t> _tail = 0;
+        /// The next position the consumer writes out (only used by the consumer).
+        alignas(64) std::size_t _head = 0;
+        /// The amount of dropped messages the consumer has reported (only used by the consumer).
+        std::uint64_t _reported = 0;
+        /// Whether the consumer is (about to be) waiting on _signal.
+        std::atomic<bool> _sleeping = false;
+        /// Bumped to wake the consumer up.
+        std::atomic<std::uint32_t> _signal = 0;
+        /// The position everything before has been written out and flushed at.
+        alignas(64) std::atomic<std::size_t> _flushed = 0;
+        /// The amount of dropped messages (with overflow_policy::count_drops).
+        std::atomic<std::uint64_t> _dropped = 0;
+        /// Whether the consumer has to stop once the queue is empty.
+        std::atomic<bool> _stop = false;
+        /// Whether the consumer ran into an error, and the first one.
+        std::atomic<bool> _failed = false;
+        std::exception_ptr _error;
+        /// The consumer.
+        std::thread _consumer;
+
+        /// @brief Claims a slot, applying the overflow policy when the queue is full.
+        /// @return The slot, or nullptr when the message is dropped.
+        slot* claim() noexcept
+        {
+            auto __pos = _tail.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                auto& __s = _slots[__pos & _mask];
+                auto __diff = static_cast<std::ptrdiff_t>(__s._seq.load(std::memory_order_acquire) - __pos);
+                if (__diff == 0)
+                {
+                    if (_tail.compare_exchange_weak(__pos, __pos + 1, std::memory_order_relaxed))
+                        return &__s;
+                }
+                else if (__diff < 0)
+                {
+                    /// The slot still holds the message of the last lap, the queue is full.
+                    if (_policy == overflow_policy::count_drops)
+                        _dropped.fetch_add(1, std::memory_order_relaxed);
+                    if (_policy != overflow_policy::block)
+                        return nullptr;
+                    std::this_thread::yield();
+                    __pos = _tail.load(std::memory_order_relaxed);
+                }
+                else
+                    __pos = _tail.load(std::memory_order_relaxed);
+            }
+        };
+
+        /// @brief Publishes a claimed slot, waking the consumer up if it is waiting.
+        void publish(slot& __s) noexcept
+        {
+            __s._seq.store(__s._seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+            /// Pairs with the fence in run(): either the consumer sees the message, or this sees it sleeping.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_sleeping.load(std::memory_order_relaxed))
+                wake();
+        };
+
+        /// @brief Wakes the consumer up.
+        void wake() noexcept
+        {
+            _signal.fetch_add(1, std::memory_order_release);
+            _signal.notify_one();
+        };
+
+        /// @brief Checks if the next message is published.
+        bool ready() const noexcept
+        {
+            return _slots[_head & _mask]._seq.load(std::memory_order_acquire) == _head + 1;
+        };
+
+        /// @brief Keeps the first error of the consumer, for flush() to rethrow.
+        void fail() noexcept
+        {
+            if (!_failed.load(std::memory_order_relaxed))
+            {
+                _error = std::current_exception();
+                _failed.store(true, std::memory_order_release);
+            }
+        };
+
+        /// @brief Writes out the queued messages, flushes the file when the queue runs empty and then waits for more.
+        void run() noexcept
+        {
+            for (;;)
+            {
+                auto __signal = _signal.load(std::memory_order_acquire);
+                for (; ready(); ++_head)
+                {
+                    auto& __s = _slots[_head & _mask];
+                    try { __s._write(_file, __s); } catch (...) { fail(); }
+                    __s._seq.store(_head + _mask + 1, std::memory_order_release);
+                }
+
+                try
+                {
+                    if (auto __d = _dropped.load(std::memory_order_relaxed); __d != _reported)
+                    {
+                        println(_file, "[{} messages dropped]", __d - _reported);
+                        _reported = __d;
+                    }
+                    _file.flush();
+                }
+                catch (...) { fail(); }
+                _flushed.store(_head, std::memory_order_release);
+                _flushed.notify_all();
+
+                if (_stop.load(std::memory_order_acquire) && !ready())
+                    return;
+
+                /// Waiting costs the producers a system call to wake the consumer up, a burst of prints usually continues soon.
+                for (int __i = 0; __i < spin_count && !ready(); ++__i)
+                    std::this_thread::yield();
+                if (ready())
+                    continue;
+
+                _sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!ready() && !_stop.load(std::memory_order_relaxed))
+                    _signal.wait(__signal, std::memory_order_acquire);
+                _sleeping.store(false, std::memory_order_relaxed);
+            }
+        };
+
+        /// @brief Copies a message into a slot.
+        /// @tparam literal Whether the format string is a literal, only referenced (otherwise it is copied too).
+        /// @return Whether the message fit into a slot (it may have been dropped all the same).
+        template<bool newline, bool literal, typename ... stored_t>
+        bool push_packed(std::string_view __fmt, const stored_t&... __args) noexcept
+        {
+            auto __n = (literal ? 0 : __detail::packed_size(__fmt)) + (std::size_t(0) + ... + __detail::packed_size(__args));
+            if (__n > sizeof(slot::_data))
+                return false;
+            if (auto __s = claim())
+            {
+                auto __p = __s->_data;
+                if constexpr (literal)
+                    __s->_format = __fmt;
+                else
+                {
+                    __s->_format = std::string_view();
+                    __p = __detail::pack(__p, __fmt);
+                }
+                ((__p = __detail::pack(__p, __args)), ...);
+                __s->_write = &__detail::write_packed<newline, stored_t...>;
+                publish(*__s);
+            }
+            return true;
+        };
+
+        /// @brief Formats a message on the calling thread and queues the result.
+        template<bool newline>
+        void push_formatted(std::string_view __fmt, format_args __args)
+        {
+            auto __str = std::make_unique<std::string>();
+            vformat_to(std::back_inserter(*__str), __fmt, __args);
+            if constexpr (newline)
+                __str->push_back('\n');
+            if (auto __s = claim())
+            {
+                __detail::pack(__s->_data, __str.release());
+                __s->_write = &__detail::write_formatted<newline>;
+                publish(*__s);
+            }
+        };
+
+    public:
+
+        /// The default amount of slots.
+        static constexpr std::size_t default_capacity = 4096;
+
+        /// @brief Explicit Constructor, starts the consumer thread.
+        /// @param __file The file to print to (it has to outlive the printer).
+        /// @param __capacity The amount of messages the queue holds (rounded up to a power of two).
+        /// @param __policy What a print does when the queue is full.
+        explicit async_printer(output_file& __file, std::size_t __capacity = default_capacity,
+            overflow_policy __policy = overflow_policy::block)
+            : _file(__file), _policy(__policy), _mask(std::bit_ceil(__capacity < 2 ? 2 : __capacity) - 1),
+              _slots(std::make_unique<slot[]>(_mask + 1))
+        {
+            for (std::size_t __i = 0; __i <= _mask; ++__i)
+                _slots[__i]._seq.store(__i, std::memory_order_relaxed);
+            _consumer = std::thread([this]() { run(); });
+        };
+
+        /// @brief Destructor, writes out everything queued, flushes the file and stops the consumer thread.
+        ///     Prints must have returned on every thread before.
+        ~async_printer()
+        {
+            _stop.store(true, std::memory_order_release);
+            wake();
+            _consumer.join();
+        };
+
+        async_printer(const async_printer&) = delete;
+        async_printer& operator=(const async_printer&) = delete;
+
+        /// @brief Queues a message, used by print() and println().
+        /// @tparam newline Whether a newline follows the message.
+        /// @tparam literal Whether the format string outlives the message (a literal, it is only referenced), otherwise
+        ///     it is copied.
+        /// @param __fmt The format string.
+        /// @param __args The arguments.
+        template<bool newline, bool literal = false, typename ... pargs_t>
+        void push(std::string_view __fmt, const pargs_t&... __args)
+        {
+            if constexpr ((__detail::is_async_copyable_v<pargs_t> && ...))
+            {
+                if (push_packed<newline, literal>(__fmt, __detail::async_stored_t<pargs_t>(__args)...))
+                    return;
+            }
+            push_formatted<newline>(__fmt, format_args(make_format_args(__args...)));
+        };
+
+        /// @brief Waits until everything queued before the call is written out and the file is flushed.
+        ///     Rethrows the first error the consumer ran into (formatting or writing), if any.
+        void flush()
+        {
+            auto __target = _tail.load(std::memory_order_acquire);
+            for (auto __f = _flushed.load(std::memory_order_acquire); __f < __target; __f = _flushed.load(std::memory_order_acquire))
+                _flushed.wait(__f, std::memory_order_acquire);
+            if (_failed.load(std::memory_order_acquire))
+                std::rethrow_exception(_error);
+        };
+
+        /// @brief Get the amount of dropped messages (counted with overflow_policy::count_drops only).
+        std::uint64_t dropped() const noexcept { return _dropped.load(std::memory_order_relaxed); };
+
+        /// @brief Get the overflow policy.
+        overflow_policy policy() const noexcept { return _policy; };
+    };
+
+
+    /// @brief Prints out from a background thread, with formatted args (the arguments are copied, see async_printer).
+    /// @tparam ...pargs_t Packed args (same as virtual arguments).
+    /// @param __printer The printer.
+    /// @param __format The string to be formatted to.
+    /// @param __args Format parameters to format the string.
+    template<typename ... pargs_t>
+    static void
+    print(async_printer& __printer, format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        __detail::count(__detail::counter_print_calls);
+        __printer.template push<false, true>(__format.get(), __args...);
+    };
+    /// @brief Prints out from a background thread, with a runtime format string (copied along with the arguments).
+    template<typename ... pargs_t>
+    static void
+    print(async_printer& __printer, __detail::runtime_format_string<char> __format, pargs_t&&... __args)
+    {
+        __detail::count(__detail::counter_print_calls);
+        __printer.template push<false>(__format._str, __args...);
+    };
+
+    /// @brief Prints a line out from a background thread, with formatted args (the arguments are copied, see async_printer).
+    template<typename ... pargs_t>
+    static void
+    println(async_printer& __printer, format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        __detail::count(__detail::counter_print_calls);
+        __printer.template push<true, true>(__format.get(), __args...);
+    };
+    /// @brief Prints a line out from a background thread, with a runtime format string (copied along with the arguments).
+    template<typename ... pargs_t>
+    static void
+    println(async_printer& __printer, __detail::runtime_format_string<char> __format, pargs_t&&... __args)
+    {
+        __detail::count(__detail::counter_print_calls);
+        __printer.template push<true>(__format._str, __args...);
+    };
+};
@@ -0,0 +1,592 @@
+/**
+ *
+ *
+ *      @author  Sean Hobeck
+ *       @date 2023-02-22
+ *
+ *
+ **/
+#pragma once
+
+/// @uses: std::chrono::system_clock
+#include <chrono>
+
+/// @uses: std::bit_ceil
+#include <bit>
+
+/// @uses: std::vector
+#include <vector>
+
+/// @uses: gmtime_r, time_t
+#include <ctime>
+
+/// @uses: output_file, format_string, make_format_args
+#include "print.h"
+
+/// @uses: flat_hash_map
+#include "flat_hash_map.h"
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+    /// @brief Error for a binary log that is not one, or is damaged.
+    class binary_log_error : public std::runtime_error
+    {
+    public:
+
+        explicit binary_log_error(const char* __what) : std::runtime_error(__what) { };
+    };
+
+
+    namespace __detail {
+        /// @brief The kinds of records in a binary log, every record is its size (a varint) and then its kind.
+        enum class binary_record : unsigned char
+        {
+            /// A format string under an id: the id, the amount of arguments, their kinds, the length and the characters.
+            define = 1,
+            /// A message: the id of its format string, the time (see below) and the arguments, with or without a newline.
+            message,
+            message_line,
+            /// A message formatted when it was logged (it has arguments of user-defined types): the time and the text.
+            text,
+            text_line,
+            /// The time the time of the next record is relative to, in nanoseconds since the epoch.
+            time_base
+        };
+
+        /// The start of a binary log: a magic, the version, and a value that tells the byte order.
+        inline constexpr char binary_log_magic[8] = { 'v', '2', '3', 'b', 'l', 'o', 'g', '\0' };
+        inline constexpr std::uint32_t binary_log_version = 1;
+        inline constexpr std::uint32_t binary_log_order = 0x01020304;
+
+        /// @brief An object per sequence of argument types, its address tells the argument types of a format string apart.
+        template<arg_type ... types_v>
+        inline constexpr char arg_signature = 0;
+
+        /// @brief Appends an unsigned LEB128 varint.
+        inline void
+        put_varint(format_buffer<char>& __buf, std::uint64_t __v)
+        {
+            for (; __v >= 0x80; __v >>= 7)
+                __buf.push_back(static_cast<char>(__v | 0x80));
+            __buf.push_back(static_cast<char>(__v));
+        };
+
+        /// @brief Maps a signed value onto an unsigned one that is small when the value is close to zero.
+        constexpr std::uint64_t
+        zigzag(std::int64_t __v) noexcept
+        {
+            return (static_cast<std::uint64_t>(__v) << 1) ^ static_cast<std::uint64_t>(__v >> 63);
+        };
+        constexpr std::int64_t
+        unzigzag(std::uint64_t __v) noexcept
+        {
+            return static_cast<std::int64_t>(__v >> 1) ^ -static_cast<std::int64_t>(__v & 1);
+        };
+
+        /// @brief Appends an argument the way a binary log stores its kind: integers and pointers as varints, floating
+        ///     point numbers as their bytes, strings as their length and characters.
+        template<typename T>
+        inline void
+        put_binary_arg(format_buffer<char>& __buf, const T& __v)
+        {
+            constexpr auto __t = get_arg_type<char, T>();
+            if constexpr (__t == arg_type::int_type || __t == arg_type::long_long_type)
+                put_varint(__buf, zigzag(static_cast<std::int64_t>(__v)));
+            else if constexpr (__t == arg_type::uint_type || __t == arg_type::ulong_long_type)
+                put_varint(__buf, static_cast<std::uint64_t>(__v));
+            else if constexpr (__t == arg_type::bool_type || __t == arg_type::char_type)
+                __buf.push_back(static_cast<char>(__v));
+            else if constexpr (__t == arg_type::float_type || __t == arg_type::double_type || __t == arg_type::long_double_type)
+            {
+                auto __p = reinterpret_cast<const char*>(std::addressof(__v));
+                __buf.append(__p, __p + sizeof(T));
+            }
+            else if constexpr (__t == arg_type::cstring_type || __t == arg_type::string_type)
+            {
+                std::string_view __s(__v);
+                put_varint(__buf, __s.size());
+                __buf.append(__s.data(), __s.data() + __s.size());
+            }
+            else
+                put_varint(__buf, reinterpret_cast<std::uintptr_t>(static_cast<const void*>(__v)));
+        };
+
+        /// @brief Reads a binary log, throwing binary_log_error past the end.
+        struct binary_cursor
+        {
+            const char* _p;
+            const char* _end;
+
+            bool empty() const noexcept { return _p == _end; };
+            std::size_t left() const noexcept { return static_cast<std::size_t>(_end - _p); };
+
+            unsigned char byte()
+            {
+                if (_p == _end)
+                    throw binary_log_error("binary log: record is cut off");
+                return static_cast<unsigned char>(*_p++);
+            };
+
+            std::uint64_t varint()
+            {
+                std::uint64_t __v = 0;
+                for (int __shift = 0; __shift < 64; __shift += 7)
+                {
+                    auto __b = byte();
+                    __v |= static_cast<std::uint64_t>(__b & 0x7f) << __shift;
+                    if ((__b & 0x80) == 0)
+                        return __v;
+                }
+                throw binary_log_error("binary log: varint is too long");
+            };
+
+            std::string_view bytes(std::uint64_t __n)
+            {
+                if (__n > left())
+                    throw binary_log_error("binary log: record is cut off");
+                std::string_view __s(_p, __n);
+                _p += __n;
+                return __s;
+            };
+
+            template<typename T>
+            T raw()
+            {
+                T __v;
+                std::memcpy(&__v, bytes(sizeof(T)).data(), sizeof(T));
+                return __v;
+            };
+        };
+    };
+
+
+    /// @brief A sink for binary print() and println(): instead of formatting, a message is stored as the id of its format
+    ///     string, the time and the raw arguments (see __detail::binary_record), and rendered to text later with
+    ///     binary_log_reader or decode_binary_log(). A format string is registered under an id the first time it is
+    ///     logged with some argument types, by its address: the format strings logged have to stay alive and unchanged
+    ///     while the log is.
+    ///     Messages with arguments of user-defined types are formatted right away and stored as text.
+    ///
+    ///     The records go either into an output_file (use a flush policy other than line, the records are not text),
+    ///     or into a ring of a fixed size in memory that keeps the most recent messages and is written out with dump().
+    ///     Not synchronized, use one per thread (or lock around it).
+    class binary_log
+    {
+    private:
+
+        /// @brief A format string by its address, its size and the types of its arguments: two format strings at one
+        ///     address are not the same, nor is one literal logged with other argument types (it is defined again for them).
+        struct format_key
+        {
+            const char* _ptr;
+            std::size_t _size;
+            /// The arg_signature of the argument types.
+            const void* _signature;
+
+            bool operator==(const format_key&) const = default;
+        };
+
+        /// @brief Hash of a format_key.
+        struct format_key_hash
+        {
+            std::size_t operator()(const format_key& __k) const noexcept
+            {
+                auto __h = std::hash<const void*>()(__k._ptr);
+                __h ^= std::hash<const void*>()(__k._signature) + 0x9e3779b97f4a7c15ull + (__h << 6) + (__h >> 2);
+                return __h ^ (__k._size + 0x9e3779b97f4a7c15ull + (__h << 6) + (__h >> 2));
+            };
+        };
+
+        /// The file, or nullptr for a ring.
+        output_file* _file = nullptr;
+        /// The ring: its bytes, its size minus one, the position of the oldest record and the one past the newest (the
+        /// positions only grow, they are masked to index the bytes).
+        std::unique_ptr<char[]> _ring;
+        std::size_t _mask = 0;
+        std::uint64_t _head = 0;
+        std::uint64_t _tail = 0;
+        /// The define records of a ring (it never evicts them, dump() writes them first).
+        basic_memory_buffer<char> _defines;
+        /// The time of the last record written, and the time before the oldest record a ring keeps.
+        std::int64_t _last = 0;
+        std::int64_t _base = 0;
+        /// The amount of records evicted from the ring (or too big for it).
+        std::uint64_t _evicted = 0;
+        /// The format string ids, by address, size and argument types.
+        flat_hash_map<format_key, std::uint32_t, format_key_hash> _ids;
+        /// The record being written.
+        basic_memory_buffer<char, 256> _record;
+
+        /// @brief Gets the byte of the ring at a position.
+        unsigned char ring_byte(std::uint64_t __pos) const noexcept
+        {
+            return static_cast<unsigned char>(_ring[__pos & _mask]);
+        };
+
+        /// @brief Reads a varint of the ring.
+        /// @param __pos Where to read it, moved past it.
+        std::uint64_t ring_varint(std::uint64_t& __pos) const noexcept
+        {
+            std::uint64_t __v = 0;
+            for (int __shift = 0;; __shift += 7)
+            {
+                auto __b = ring_byte(__pos++);
+                __v |= static_cast<std::uint64_t>(__b & 0x7f) << __shift;
+                if ((__b & 0x80) == 0)
+                    return __v;
+            }
+        };
+
+        /// @brief Copies bytes into the ring at the tail.
+        void ring_append(const char* __p, std::size_t __n) noexcept
+        {
+            auto __at = static_cast<std::size_t>(_tail & _mask);
+            auto __first = std::min(__n, _mask + 1 - __at);
+            std::memcpy(_ring.get() + __at, __p, __first);
+            std::memcpy(_ring.get(), __p + __first, __n - __first);
+            _tail += __n;
+        };
+
+        /// @brief Evicts the oldest record of the ring, moving the time base past it.
+        void evict() noexcept
+        {
+            auto __pos = _head;
+            auto __size = ring_varint(__pos);
+            auto __next = __pos + __size;
+            auto __kind = static_cast<__detail::binary_record>(ring_byte(__pos++));
+            if (__kind == __detail::binary_record::message || __kind == __detail::binary_record::message_line)
+                ring_varint(__pos);
+            if (__kind != __detail::binary_record::define && __kind != __detail::binary_record::time_base)
+                _base += __detail::unzigzag(ring_varint(__pos));
+            _head = __next;
+            ++_evicted;
+        };
+
+        /// @brief Writes a record out (its size first).
+        /// @param __define Whether it is a define record (a ring keeps those in _defines).
+        /// @return Whether it was written (a record bigger than the ring is not).
+        bool emit(const basic_memory_buffer<char, 256>& __rec, bool __define = false)
+        {
+            if (_file != nullptr)
+            {
+                auto __begin = _file->mark();
+                __detail::put_varint(*_file, __rec.size());
+                _file->append(__rec.data(), __rec.data() + __rec.size());
+                _file->commit(__begin);
+                return true;
+            }
+            if (__define)
+            {
+                __detail::put_varint(_defines, __rec.size());
+                _defines.append(__rec.data(), __rec.data() + __rec.size());
+                return true;
+            }
+
+            basic_memory_buffer<char, 10> __size;
+            __detail::put_varint(__size, __rec.size());
+            auto __n = __size.size() + __rec.size();
+            if (__n > _mask + 1)
+            {
+                ++_evicted;
+                return false;
+            }
+            while (_tail + __n - _head > _mask + 1)
+                evict();
+            ring_append(__size.data(), __size.size());
+            ring_append(__rec.data(), __rec.size());
+            return true;
+        };
+
+        /// @brief Gets the id of a format string, defining it on first use.
+        template<typename ... pargs_t>
+        std::uint32_t id_of(std::string_view __fmt)
+        {
+            format_key __key { __fmt.data(), __fmt.size(), &__detail::arg_signature<__detail::get_arg_type<char, pargs_t>()...> };
+            if (auto __it = _ids.find(__key); __it != _ids.end())
+                return __it->second;
+
+            auto __id = static_cast<std::uint32_t>(_ids.size());
+            basic_memory_buffer<char, 256> __rec;
+            __rec.push_back(static_cast<char>(__detail::binary_record::define));
+            __detail::put_varint(__rec, __id);
+            __rec.push_back(static_cast<char>(sizeof...(pargs_t)));
+            (__rec.push_back(static_cast<char>(__detail::get_arg_type<char, pargs_t>())), ...);
+            __detail::put_varint(__rec, __fmt.size());
+            __rec.append(__fmt.data(), __fmt.data() + __fmt.size());
+            emit(__rec, true);
+            _ids.insert(__key, __id);
+            return __id;
+        };
+
+    public:
+
+        /// @brief Explicit Constructor, logs into a file (it has to outlive the log), the header is written right away.
+        /// @param __file The file.
+        explicit binary_log(output_file& __file) : _file(&__file)
+        {
+            auto __begin = _file->mark();
+            _file->append(__detail::binary_log_magic, __detail::binary_log_magic + sizeof(__detail::binary_log_magic));
+            for (auto __v : { __detail::binary_log_version, __detail::binary_log_order })
+                _file->append(reinterpret_cast<const char*>(&__v), reinterpret_cast<const char*>(&__v) + sizeof(__v));
+            _file->commit(__begin);
+        };
+
+        /// @brief Explicit Constructor, logs into a ring in memory that keeps the most recent messages.
+        /// @param __size The size of the ring in bytes (rounded up to a power of two).
+        explicit binary_log(std::size_t __size)
+            : _ring(std::make_unique_for_overwrite<char[]>(std::bit_ceil(__size < 64 ? 64 : __size))),
+              _mask(std::bit_ceil(__size < 64 ? 64 : __size) - 1) { };
+
+        binary_log(const binary_log&) = delete;
+        binary_log& operator=(const binary_log&) = delete;
+
+        /// @brief Logs a message, used by print() and println().
+        /// @tparam newline Whether a newline follows the message.
+        /// @param __fmt The format string (it has to stay alive and unchanged while the log is).
+        /// @param __args The arguments.
+        template<bool newline, typename ... pargs_t>
+        void write(std::string_view __fmt, const pargs_t&... __args)
+        {
+            using __detail::binary_record;
+            std::int64_t __now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            if constexpr (((__detail::get_arg_type<char, pargs_t>() == __detail::arg_type::custom_type) || ...))
+            {
+                __detail::print_buffer<char> __pb;
+                auto& __text = __detail::vformat_to_print(__pb, __fmt, format_args(make_format_args(__args...)));
+                _record.clear();
+                _record.push_back(static_cast<char>(newline ? binary_record::text_line : binary_record::text));
+                __detail::put_varint(_record, __detail::zigzag(__now - _last));
+                __detail::put_varint(_record, __text.size());
+                _record.append(__text.data(), __text.data() + __text.size());
+            }
+            else
+            {
+                auto __id = id_of<pargs_t...>(__fmt);
+                _record.clear();
+                _record.push_back(static_cast<char>(newline ? binary_record::message_line : binary_record::message));
+                __detail::put_varint(_record, __id);
+                __detail::put_varint(_record, __detail::zigzag(__now - _last));
+                (__detail::put_binary_arg(_record, __args), ...);
+            }
+            if (emit(_record))
+                _last = __now;
+        };
+
+        /// @brief Writes the log a ring holds out (the header, the format strings and the messages it keeps), the ring
+        ///     is left as it is.
+        /// @param __out Where to write it (an output_file, a memory buffer, ...).
+        void dump(__detail::format_buffer<char>& __out) const
+        {
+            __out.append(__detail::binary_log_magic, __detail::binary_log_magic + sizeof(__detail::binary_log_magic));
+            for (auto __v : { __detail::binary_log_version, __detail::binary_log_order })
+                __out.append(reinterpret_cast<const char*>(&__v), reinterpret_cast<const char*>(&__v) + sizeof(__v));
+            __out.append(_defines.data(), _defines.data() + _defines.size());
+
+            __out.push_back(static_cast<char>(1 + sizeof(_base)));
+            __out.push_back(static_cast<char>(__detail::binary_record::time_base));
+            __out.append(reinterpret_cast<const char*>(&_base), reinterpret_cast<const char*>(&_base) + sizeof(_base));
+            if (_file == nullptr && _tail != _head)
+            {
+                auto __at = static_cast<std::size_t>(_head & _mask);
+                auto __n = static_cast<std::size_t>(_tail - _head);
+                auto __first = std::min(__n, _mask + 1 - __at);
+                __out.append(_ring.get() + __at, _ring.get() + __at + __first);
+                __out.append(_ring.get(), _ring.get() + (__n - __first));
+            }
+        };
+
+        /// @brief Get the amount of messages a ring has evicted (or not kept as they were bigger than it).
+        std::uint64_t evicted() const noexcept { return _evicted; };
+
+        /// @brief Get the amount of format strings registered.
+        std::size_t formats() const noexcept { return _ids.size(); };
+    };
+
+
+    /// @brief Renders the messages of a binary log back to text, formatting them with the format strings they were logged with.
+    class binary_log_reader
+    {
+    private:
+
+        /// @brief A format string, and the kinds of its arguments.
+        struct format_entry
+        {
+            std::string_view _str;
+            std::string_view _types;
+        };
+
+        /// The rest of the log.
+        __detail::binary_cursor _in;
+        /// The format strings, by id.
+        std::vector<format_entry> _formats;
+        /// The time of the last record.
+        std::int64_t _last = 0;
+        /// The arguments of the message being rendered.
+        std::vector<basic_format_arg<char>> _args;
+
+        /// @brief Reads an argument of a kind.
+        basic_format_arg<char> read_arg(__detail::binary_cursor& __in, __detail::arg_type __t)
+        {
+            using __detail::arg_type;
+            switch (__t)
+            {
+                case arg_type::int_type: return make_format_arg<char>(static_cast<int>(__detail::unzigzag(__in.varint())));
+                case arg_type::long_long_type: return make_format_arg<char>(static_cast<long long>(__detail::unzigzag(__in.varint())));
+                case arg_type::uint_type: return make_format_arg<char>(static_cast<unsigned int>(__in.varint()));
+                case arg_type::ulong_long_type: return make_format_arg<char>(static_cast<unsigned long long>(__in.varint()));
+                case arg_type::bool_type: return make_format_arg<char>(__in.byte() != 0);
+                case arg_type::char_type: return make_format_arg<char>(static_cast<char>(__in.byte()));
+                case arg_type::float_type: return make_format_arg<char>(__in.raw<float>());
+                case arg_type::double_type: return make_format_arg<char>(__in.raw<double>());
+                case arg_type::long_double_type: return make_format_arg<char>(__in.raw<long double>());
+                case arg_type::cstring_type:
+                case arg_type::string_type: return make_format_arg<char>(__in.bytes(__in.varint()));
+                case arg_type::pointer_type: return make_format_arg<char>(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(__in.varint())));
+                default: throw binary_log_error("binary log: unknown argument kind");
+            }
+        };
+
+    public:
+
+        /// @brief Explicit Constructor, checks the header.
+        /// @param __data The log (it has to outlive the reader, the strings of the messages are read in place).
+        explicit binary_log_reader(std::string_view __data) : _in { __data.data(), __data.data() + __data.size() }
+        {
+            if (_in.left() < sizeof(__detail::binary_log_magic) + 2 * sizeof(std::uint32_t) ||
+                std::memcmp(_in.bytes(sizeof(__detail::binary_log_magic)).data(), __detail::binary_log_magic, sizeof(__detail::binary_log_magic)) != 0)
+                throw binary_log_error("binary log: not a binary log");
+            if (_in.raw<std::uint32_t>() != __detail::binary_log_version)
+                throw binary_log_error("binary log: unsupported version");
+            if (_in.raw<std::uint32_t>() != __detail::binary_log_order)
+                throw binary_log_error("binary log: written with another byte order");
+        };
+
+        /// @brief Renders the next message.
+        /// @param __out Where to render it.
+        /// @param __time Set to the time the message was logged, in nanoseconds since the epoch.
+        /// @return Whether there was a message, false at the end of the log (or at a record cut off by a crash).
+        bool next(__detail::format_buffer<char>& __out, std::int64_t& __time)
+        {
+            using __detail::binary_record;
+            while (!_in.empty())
+            {
+                /// A record cut off at the end is where the program writing the log stopped.
+                auto __start = _in;
+                std::uint64_t __size;
+                try { __size = _in.varint(); } catch (const binary_log_error&) { _in = __start; return false; }
+                if (__size > _in.left())
+                {
+                    _in = __start;
+                    return false;
+                }
+                __detail::binary_cursor __rec { _in._p, _in._p + __size };
+                _in._p += __size;
+
+                switch (static_cast<binary_record>(__rec.byte()))
+                {
+                    case binary_record::define:
+                    {
+                        auto __id = __rec.varint();
+                        if (__id >= 0x1000000)
+                            throw binary_log_error("binary log: format string id is too big");
+                        auto __types = __rec.bytes(__rec.byte());
+                        auto __str = __rec.bytes(__rec.varint());
+                        if (__id >= _formats.size())
+                            _formats.resize(__id + 1);
+                        _formats[__id] = { __str, __types };
+                        break;
+                    }
+                    case binary_record::time_base:
+                        _last = __rec.raw<std::int64_t>();
+                        break;
+                    case binary_record::message:
+                    case binary_record::message_line:
+                    {
+                        bool __line = __rec._p[-1] == static_cast<char>(binary_record::message_line);
+                        auto __id = __rec.varint();
+                        if (__id >= _formats.size() || _formats[__id]._str.data() == nullptr)
+                            throw binary_log_error("binary log: message of an undefined format string");
+                        __time = _last += __detail::unzigzag(__rec.varint());
+                        const auto& __f = _formats[__id];
+                        _args.clear();
+                        for (char __t : __f._types)
+                            _args.push_back(read_arg(__rec, static_cast<__detail::arg_type>(__t)));
+                        __detail::vformat_to_buffer(__out, __f._str, format_args(_args.data(), _args.size()));
+                        if (__line)
+                            __out.push_back('\n');
+                        return true;
+                    }
+                    case binary_record::text:
+                    case binary_record::text_line:
+                    {
+                        bool __line = __rec._p[-1] == static_cast<char>(binary_record::text_line);
+                        __time = _last += __detail::unzigzag(__rec.varint());
+                        auto __text = __rec.bytes(__rec.varint());
+                        __out.append(__text.data(), __text.data() + __text.size());
+                        if (__line)
+                            __out.push_back('\n');
+                        return true;
+                    }
+                    default:
+                        /// Records of later versions are skipped.
+                        break;
+                }
+            }
+            return false;
+        };
+    };
+
+
+    /// @brief Renders a binary log as text.
+    /// @param __data The log.
+    /// @param __out Where to render it (an output_file, a memory buffer, ...).
+    /// @param __timestamps Whether to start every message with the UTC time it was logged at.
+    /// @return The amount of messages.
+    static std::size_t
+    decode_binary_log(std::string_view __data, __detail::format_buffer<char>& __out, bool __timestamps = false)
+    {
+        binary_log_reader __reader(__data);
+        basic_memory_buffer<char> __msg;
+        std::int64_t __time;
+        std::size_t __n = 0;
+        for (; __reader.next(__msg, __time); ++__n, __msg.clear())
+        {
+            if (__timestamps)
+            {
+                std::time_t __s = static_cast<std::time_t>(__time / 1000000000 - (__time % 1000000000 < 0));
+                auto __ns = (__time % 1000000000 + 1000000000) % 1000000000;
+                std::tm __tm;
+                ::gmtime_r(&__s, &__tm);
+                __detail::vformat_to_buffer(__out, std::string_view("{:04}-{:02}-{:02} {:02}:{:02}:{:02}.{:09} "), format_args(make_format_args(
+                    __tm.tm_year + 1900, __tm.tm_mon + 1, __tm.tm_mday, __tm.tm_hour, __tm.tm_min, __tm.tm_sec, __ns)));
+            }
+            __out.append(__msg.data(), __msg.data() + __msg.size());
+        }
+        return __n;
+    };
+
+
+    /// @brief Logs a message into a binary log, with its args stored as they are (see binary_log).
+    /// @tparam ...pargs_t Packed args (same as virtual arguments).
+    /// @param __log The log.
+    /// @param __format The string to be formatted to (when the log is read).
+    /// @param __args Format parameters to store.
+    template<typename ... pargs_t>
+    static void
+    print(binary_log& __log, format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        __detail::count(__detail::counter_print_calls);
+        __log.template write<false>(__format.get(), __args...);
+    };
+
+    /// @brief Logs a line into a binary log, with its args stored as they are (see binary_log).
+    template<typename ... pargs_t>
+    static void
+    println(binary_log& __log, format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        __detail::count(__detail::counter_print_calls);
+        __log.template write<true>(__format.get(), __args...);
+    };
+};
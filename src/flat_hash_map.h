@@ -0,0 +1,754 @@
+/**
+ * 
+ * 
+ *      @author  Sean Hobeck
+ *       @date 2023-02-18
+ * 
+ * 
+ **/
+#pragma once
+
+/// @uses: std::hash, std::equal_to, std::pair, std::initializer_list, std::forward_iterator_tag
+#include <bits/stdc++.h>
+
+#if defined(__SSE2__)
+/// @uses: _mm_loadu_si128, _mm_cmpeq_epi8, _mm_set1_epi8, _mm_movemask_epi8
+#include <emmintrin.h>
+#endif
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+
+    namespace __detail {
+        /// @brief The control byte of an empty slot.
+        inline constexpr std::int8_t ctrl_empty = -128;
+        /// @brief The control byte of an erased slot (probing continues past it, inserting may reuse it).
+        inline constexpr std::int8_t ctrl_deleted = -2;
+        /// @brief The amount of control bytes probed at once. Full slots have the low 7 bits of their hash as control
+        ///     byte (the sign bit clear), so one compare of a group finds the candidates among 16 slots.
+        inline constexpr std::size_t group_width = 16;
+
+        /// @brief A group of control bytes, matched a whole group at a time (SSE2, or a loop without it).
+        class hash_group {
+        private:
+
+#if defined(__SSE2__)
+            /// The control bytes.
+            __m128i _ctrl;
+#else
+            /// The control bytes.
+            std::int8_t _ctrl[group_width];
+#endif
+
+        public:
+
+            /// @brief Explicit Constructor, loads the group starting at a control byte.
+            /// @param _p The control byte.
+            explicit hash_group(const std::int8_t* _p) {
+#if defined(__SSE2__)
+                _ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p));
+#else
+                std::memcpy(_ctrl, _p, group_width);
+#endif
+            };
+
+            /// @brief Gets a bit per slot whose control byte is a value.
+            std::uint32_t match(std::int8_t _b) const {
+#if defined(__SSE2__)
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(_b), _ctrl)));
+#else
+                std::uint32_t _r = 0;
+                for (std::size_t _i = 0; _i < group_width; ++_i)
+                    _r |= static_cast<std::uint32_t>(_ctrl[_i] == _b) << _i;
+                return _r;
+#endif
+            };
+
+            /// @brief Gets a bit per empty or erased slot (the sign bit of the control byte is set).
+            std::uint32_t match_free() const {
+#if defined(__SSE2__)
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_ctrl));
+#else
+                std::uint32_t _r = 0;
+                for (std::size_t _i = 0; _i < group_width; ++_i)
+                    _r |= static_cast<std::uint32_t>(_ctrl[_i] < 0) << _i;
+                return _r;
+#endif
+            };
+
+            /// @brief Gets a bit per empty slot (probing for a key stops at a group with one).
+            std::uint32_t match_empty() const {
+                return match(ctrl_empty);
+            };
+        };
+
+        /// @brief How a flat_hash_map stores its elements, a pair per slot handed out as a pair of references.
+        template <typename k, typename v>
+        struct hash_map_policy {
+            using key_type = k;
+            using slot_type = std::pair<k, v>;
+            using value_type = std::pair<k, v>;
+            template <bool _const>
+            using reference = std::pair<const k&, std::conditional_t<_const, const v&, v&>>;
+
+            static const k& key(const slot_type& _s) { return _s.first; };
+            template <bool _const>
+            static reference<_const> ref(std::conditional_t<_const, const slot_type&, slot_type&> _s) { return { _s.first, _s.second }; };
+        };
+
+        /// @brief How a flat_hash_set stores its elements, a key per slot handed out as a constant reference.
+        template <typename k>
+        struct hash_set_policy {
+            using key_type = k;
+            using slot_type = k;
+            using value_type = k;
+            template <bool _const>
+            using reference = const k&;
+
+            static const k& key(const slot_type& _s) { return _s; };
+            template <bool _const>
+            static const k& ref(const slot_type& _s) { return _s; };
+        };
+
+        /// @brief Iterator over the full slots of a hash table.
+        /// @tparam policy_t The storage policy.
+        /// @tparam _const Whether it is a constant iterator.
+        template <typename policy_t, bool _const>
+        class hash_table_iterator {
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using iterator_concept = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = typename policy_t::value_type;
+            using reference = typename policy_t::template reference<_const>;
+
+            /// @brief The reference, for operator->.
+            struct pointer {
+                reference _ref;
+                auto operator->() { return std::addressof(_ref); };
+            };
+
+        private:
+
+            using slot_ptr = std::conditional_t<_const, const typename policy_t::slot_type*, typename policy_t::slot_type*>;
+
+            /// The control byte of the slot, and one past the last control byte.
+            const std::int8_t* _ctrl = nullptr;
+            const std::int8_t* _end = nullptr;
+            /// The slot.
+            slot_ptr _slot = nullptr;
+
+            /// @brief Steps forward to the next full slot.
+            void skip() { for (; _ctrl != _end && *_ctrl < 0; ++_ctrl) ++_slot; };
+
+        public:
+
+            hash_table_iterator() = default;
+
+            /// @brief Constructor, at the first full slot from a slot on.
+            /// @param _c The control byte of the slot.
+            /// @param _e One past the last control byte.
+            /// @param _s The slot.
+            hash_table_iterator(const std::int8_t* _c, const std::int8_t* _e, slot_ptr _s) : _ctrl(_c), _end(_e), _slot(_s) { skip(); };
+
+            /// @brief Converting Constructor (iterator to const iterator).
+            template <bool _o>
+                requires (_const && !_o)
+            hash_table_iterator(const hash_table_iterator<policy_t, _o>& _it) : _ctrl(_it._ctrl), _end(_it._end), _slot(_it._slot) { };
+
+            reference operator*() const { return policy_t::template ref<_const>(*_slot); };
+            pointer operator->() const { return { **this }; };
+
+            hash_table_iterator& operator++() { ++_ctrl; ++_slot; skip(); return *this; };
+            hash_table_iterator operator++(int) { auto _t = *this; ++*this; return _t; };
+
+            friend bool operator==(const hash_table_iterator& _a, const hash_table_iterator& _b) { return _a._slot == _b._slot; };
+
+            template <typename, bool>
+            friend class hash_table_iterator;
+            template <typename, typename, typename>
+            friend class hash_table;
+        };
+
+        /// @brief An open addressing hash table (Swiss table): a control byte per slot in one array, the slots in another.
+        ///     A hash is split in the position probing starts at (h1) and 7 bits kept in the control byte (h2). Probing
+        ///     compares the control bytes of a group of slots at once, keys are only compared for matching control bytes,
+        ///     and a group with an empty slot ends the probe. Groups are probed quadratically, at most 7/8 of the slots are used.
+        /// @tparam policy_t The storage policy.
+        /// @tparam hash_t Hash typename.
+        /// @tparam eq_t Key equality typename.
+        template <typename policy_t, typename hash_t, typename eq_t>
+        class hash_table {
+        public:
+
+            using key_type = typename policy_t::key_type;
+            using value_type = typename policy_t::value_type;
+            using hasher = hash_t;
+            using key_equal = eq_t;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using iterator = hash_table_iterator<policy_t, false>;
+            using const_iterator = hash_table_iterator<policy_t, true>;
+
+        protected:
+
+            using slot_type = typename policy_t::slot_type;
+
+            /// The control bytes, the first group_width are repeated after the last so a group can be loaded at any slot.
+            std::int8_t* _ctrl = nullptr;
+            /// The slots.
+            slot_type* _slots = nullptr;
+            /// The amount of slots (zero or a power of two, at least group_width).
+            std::size_t _capacity = 0;
+            /// The amount of full slots.
+            std::size_t _size = 0;
+            /// The amount of empty slots that may still be filled before the table grows.
+            std::size_t _growth_left = 0;
+            /// The hash.
+            [[no_unique_address]] hash_t _hash;
+            /// The key equality.
+            [[no_unique_address]] eq_t _eq;
+
+            /// @brief The alignment of the allocation (the control bytes come first, the slots after them).
+            static constexpr std::size_t alignment = std::max(alignof(slot_type), std::size_t(16));
+
+            /// @brief Gets the offset of the slots in an allocation.
+            static std::size_t slots_offset(std::size_t _cap) {
+                return (_cap + group_width + alignof(slot_type) - 1) / alignof(slot_type) * alignof(slot_type);
+            };
+
+            /// @brief Gets the amount of slots that may be full with a capacity (7/8 of them).
+            static std::size_t max_full(std::size_t _cap) {
+                return _cap - _cap / 8;
+            };
+
+            /// @brief Mixes a hash, so that hashes that only differ in a few bits (std::hash of integers is the integer)
+            ///     spread over h1 and h2.
+            static std::size_t mix(std::size_t _h) {
+                auto _p = static_cast<unsigned __int128>(_h) * 0x9E3779B97F4A7C15ull;
+                return static_cast<std::size_t>(_p >> 64) ^ static_cast<std::size_t>(_p);
+            };
+
+            /// @brief Sets the control byte of a slot (and its copy after the last group).
+            void set_ctrl(std::size_t _i, std::int8_t _b) {
+                _ctrl[_i] = _b;
+                if (_i < group_width)
+                    _ctrl[_capacity + _i] = _b;
+            };
+
+            /// @brief Gets the index of the slot of a key.
+            /// @return The index, or _capacity if the key is not in the table.
+            std::size_t find_index(const key_type& _k) const {
+                if (_capacity == 0) [[unlikely]]
+                    return 0;
+                auto _h = mix(_hash(_k));
+                auto _h2 = static_cast<std::int8_t>(_h & 0x7f);
+                auto _mask = _capacity - 1;
+                std::size_t _pos = (_h >> 7) & _mask, _step = 0;
+                for (;;) {
+                    hash_group _g(_ctrl + _pos);
+                    for (auto _bits = _g.match(_h2); _bits != 0; _bits &= _bits - 1) {
+                        auto _i = (_pos + static_cast<std::size_t>(std::countr_zero(_bits))) & _mask;
+                        if (_eq(policy_t::key(_slots[_i]), _k)) [[likely]]
+                            return _i;
+                    }
+                    if (_g.match_empty() != 0) [[likely]]
+                        return _capacity;
+                    _step += group_width;
+                    _pos = (_pos + _step) & _mask;
+                }
+            };
+
+            /// @brief Gets the first empty or erased slot on the probe sequence of a hash.
+            std::size_t find_free(std::size_t _h) const {
+                auto _mask = _capacity - 1;
+                std::size_t _pos = (_h >> 7) & _mask, _step = 0;
+                for (;;) {
+                    if (auto _bits = hash_group(_ctrl + _pos).match_free(); _bits != 0)
+                        return (_pos + static_cast<std::size_t>(std::countr_zero(_bits))) & _mask;
+                    _step += group_width;
+                    _pos = (_pos + _step) & _mask;
+                }
+            };
+
+            /// @brief Finds the slot of a key, or claims one for it (the caller constructs the element, or calls abandon()).
+            /// @return The index of the slot, and whether it was claimed.
+            std::pair<std::size_t, bool> find_or_claim(const key_type& _k) {
+                if (auto _i = find_index(_k); _i != _capacity)
+                    return { _i, false };
+                if (_growth_left == 0)
+                    make_room();
+                auto _h = mix(_hash(_k));
+                auto _i = find_free(_h);
+                if (_ctrl[_i] == ctrl_empty)
+                    --_growth_left;
+                set_ctrl(_i, static_cast<std::int8_t>(_h & 0x7f));
+                ++_size;
+                return { _i, true };
+            };
+
+            /// @brief Gives a claimed slot back (its element could not be constructed).
+            void abandon(std::size_t _i) {
+                set_ctrl(_i, ctrl_deleted);
+                --_size;
+            };
+
+            /// @brief Destroys the element of a slot and marks it erased.
+            void erase_index(std::size_t _i) {
+                std::destroy_at(_slots + _i);
+                set_ctrl(_i, ctrl_deleted);
+                --_size;
+            };
+
+            /// @brief Makes room for an insertion: rehashes in place if erased slots take up the room, otherwise doubles.
+            void make_room() {
+                if (_capacity != 0 && _size < max_full(_capacity) / 2)
+                    rehash(_capacity);
+                else
+                    rehash(_capacity == 0 ? group_width : _capacity * 2);
+            };
+
+            /// @brief Moves every element into a new table of a capacity.
+            void rehash(std::size_t _cap) {
+                auto* _mem = static_cast<std::byte*>(::operator new(slots_offset(_cap) + _cap * sizeof(slot_type), std::align_val_t(alignment)));
+                auto* _old_ctrl = _ctrl;
+                auto* _old_slots = _slots;
+                auto _old_cap = _capacity;
+
+                _ctrl = reinterpret_cast<std::int8_t*>(_mem);
+                _slots = reinterpret_cast<slot_type*>(_mem + slots_offset(_cap));
+                _capacity = _cap;
+                std::memset(_ctrl, static_cast<unsigned char>(ctrl_empty), _cap + group_width);
+                for (std::size_t _i = 0; _i < _old_cap; ++_i) {
+                    if (_old_ctrl[_i] < 0)
+                        continue;
+                    auto _h = mix(_hash(policy_t::key(_old_slots[_i])));
+                    auto _j = find_free(_h);
+                    set_ctrl(_j, static_cast<std::int8_t>(_h & 0x7f));
+                    ::new (static_cast<void*>(_slots + _j)) slot_type(std::move(_old_slots[_i]));
+                    std::destroy_at(_old_slots + _i);
+                }
+                _growth_left = max_full(_cap) - _size;
+                if (_old_cap != 0)
+                    ::operator delete(_old_ctrl, std::align_val_t(alignment));
+            };
+
+            /// @brief Destroys every element and frees the table.
+            void release() {
+                if (_capacity == 0)
+                    return;
+                if constexpr (!std::is_trivially_destructible_v<slot_type>)
+                    for (std::size_t _i = 0; _i < _capacity; ++_i)
+                        if (_ctrl[_i] >= 0)
+                            std::destroy_at(_slots + _i);
+                ::operator delete(_ctrl, std::align_val_t(alignment));
+                _ctrl = nullptr;
+                _slots = nullptr;
+                _capacity = _size = _growth_left = 0;
+            };
+
+            /// @brief Gets the iterator at a slot.
+            iterator at_index(std::size_t _i) {
+                return iterator(_ctrl + _i, _ctrl + _capacity, _slots + _i);
+            };
+            const_iterator at_index(std::size_t _i) const {
+                return const_iterator(_ctrl + _i, _ctrl + _capacity, _slots + _i);
+            };
+
+            hash_table() = default;
+
+            /// @brief Explicit Constructor
+            /// @param _h The hash.
+            /// @param _e The key equality.
+            explicit hash_table(const hash_t& _h, const eq_t& _e = eq_t()) : _hash(_h), _eq(_e) { };
+
+            /// @brief Copy Constructor, a copy that throws destroys the elements copied so far and frees the table.
+            hash_table(const hash_table& _o) : _hash(_o._hash), _eq(_o._eq) {
+                reserve(_o._size);
+                try {
+                    for (std::size_t _i = 0; _i < _o._capacity; ++_i) {
+                        if (_o._ctrl[_i] < 0)
+                            continue;
+                        auto _h = mix(_hash(policy_t::key(_o._slots[_i])));
+                        auto _j = find_free(_h);
+                        ::new (static_cast<void*>(_slots + _j)) slot_type(_o._slots[_i]);
+                        set_ctrl(_j, static_cast<std::int8_t>(_h & 0x7f));
+                        ++_size;
+                        --_growth_left;
+                    }
+                }
+                catch (...) {
+                    release();
+                    throw;
+                }
+            };
+
+            /// @brief Move Constructor
+            hash_table(hash_table&& _o) noexcept
+                : _ctrl(std::exchange(_o._ctrl, nullptr)), _slots(std::exchange(_o._slots, nullptr)),
+                  _capacity(std::exchange(_o._capacity, 0)), _size(std::exchange(_o._size, 0)),
+                  _growth_left(std::exchange(_o._growth_left, 0)), _hash(_o._hash), _eq(_o._eq) { };
+
+            /// @brief Assignment (copy or move, through the by value argument).
+            hash_table& operator=(hash_table _o) noexcept {
+                std::swap(_ctrl, _o._ctrl);
+                std::swap(_slots, _o._slots);
+                std::swap(_capacity, _o._capacity);
+                std::swap(_size, _o._size);
+                std::swap(_growth_left, _o._growth_left);
+                std::swap(_hash, _o._hash);
+                std::swap(_eq, _o._eq);
+                return *this;
+            };
+
+            ~hash_table() {
+                release();
+            };
+
+        public:
+
+            ///------------- @section Member functions. -------------///
+
+
+            /// @brief Finding the element of a key.
+            /// @param _k The key.
+            /// @return The element, or end().
+            iterator find(const key_type& _k) {
+                auto _i = find_index(_k);
+                return _i == _capacity ? end() : at_index(_i);
+            };
+            const_iterator find(const key_type& _k) const {
+                auto _i = find_index(_k);
+                return _i == _capacity ? end() : at_index(_i);
+            };
+
+            /// @brief Checking if the container contains a key.
+            /// @param _k The key.
+            /// @return If the container contains the key.
+            bool contains(const key_type& _k) const {
+                return find_index(_k) != _capacity;
+            };
+
+            /// @brief Counting the elements of a key.
+            /// @param _k The key.
+            /// @return The amount of elements (0 or 1).
+            std::size_t count(const key_type& _k) const {
+                return contains(_k) ? 1 : 0;
+            };
+
+            /// @brief Erasing the element of a key.
+            /// @param _k The key.
+            /// @return The amount of erased elements (0 or 1).
+            std::size_t erase(const key_type& _k) {
+                auto _i = find_index(_k);
+                if (_i == _capacity)
+                    return 0;
+                erase_index(_i);
+                return 1;
+            };
+
+            /// @brief Erasing the element at an iterator.
+            /// @param _it The iterator.
+            /// @return The iterator after the erased element.
+            iterator erase(const_iterator _it) {
+                auto _i = static_cast<std::size_t>(_it._slot - _slots);
+                erase_index(_i);
+                return at_index(_i + 1);
+            };
+
+            /// @brief Erasing all elements (the slots are kept).
+            void clear() {
+                if (_size == 0)
+                    return;
+                if constexpr (!std::is_trivially_destructible_v<slot_type>)
+                    for (std::size_t _i = 0; _i < _capacity; ++_i)
+                        if (_ctrl[_i] >= 0)
+                            std::destroy_at(_slots + _i);
+                std::memset(_ctrl, static_cast<unsigned char>(ctrl_empty), _capacity + group_width);
+                _size = 0;
+                _growth_left = max_full(_capacity);
+            };
+
+            /// @brief Making room for an amount of elements without growing again.
+            /// @param _n The amount of elements.
+            void reserve(std::size_t _n) {
+                std::size_t _cap = _capacity == 0 ? group_width : _capacity;
+                while (max_full(_cap) < _n)
+                    _cap *= 2;
+                if (_cap != _capacity && max_full(_cap) - _size > _growth_left)
+                    rehash(_cap);
+            };
+
+            /// @brief Get the size of the container.
+            /// @return The size of the container.
+            std::size_t size() const {
+                return _size;
+            };
+
+            /// @brief Checking if the container is empty.
+            bool empty() const {
+                return _size == 0;
+            };
+
+            /// @brief Get the amount of slots.
+            std::size_t capacity() const {
+                return _capacity;
+            };
+
+            /// @brief Get the share of slots that are full.
+            float load_factor() const {
+                return _capacity == 0 ? 0.0f : static_cast<float>(_size) / static_cast<float>(_capacity);
+            };
+
+            /// @brief Get the hash.
+            hash_t hash_function() const {
+                return _hash;
+            };
+
+            /// @brief Get the key equality.
+            eq_t key_eq() const {
+                return _eq;
+            };
+
+
+            ///------------- @section Container functions. -------------///
+
+
+            /// @brief Get the begin iterator of the container.
+            /// @return The begin iterator.
+            iterator begin() {
+                return at_index(0);
+            };
+            const_iterator begin() const {
+                return at_index(0);
+            };
+
+            /// @brief Get the end iterator of the container.
+            /// @return The ending iterator.
+            iterator end() {
+                return at_index(_capacity);
+            };
+            const_iterator end() const {
+                return at_index(_capacity);
+            };
+
+            /// @brief Get the constant begin iterator of the container.
+            /// @return The begin iterator.
+            const_iterator cbegin() const {
+                return begin();
+            };
+
+            /// @brief Get the constant end iterator of the container.
+            /// @return The ending iterator.
+            const_iterator cend() const {
+                return end();
+            };
+        };
+    };
+
+    /// @brief Flat hash map container, an open addressing hash table with the interface of flat_map (the elements are in
+    ///     no particular order). Probing compares 16 control bytes at once, and each slot costs its pair plus one byte.
+    ///     Inserting may move every element (iterators and references are invalidated), erasing moves none.
+    /// @tparam k Key typename.
+    /// @tparam v Value typename.
+    /// @tparam hash_t Hash typename.
+    /// @tparam eq_t Key equality typename.
+    template <typename k, typename v,
+        typename hash_t = std::hash<k>,
+        typename eq_t = std::equal_to<k>>
+    class flat_hash_map : public __detail::hash_table<__detail::hash_map_policy<k, v>, hash_t, eq_t> {
+    private:
+
+        using base = __detail::hash_table<__detail::hash_map_policy<k, v>, hash_t, eq_t>;
+
+    public:
+
+        using mapped_type = v;
+        using reference = std::pair<const k&, v&>;
+        using const_reference = std::pair<const k&, const v&>;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        flat_hash_map() = default;
+
+        /// @brief Explicit Constructor
+        /// @param _h The hash.
+        /// @param _e The key equality.
+        explicit flat_hash_map(const hash_t& _h, const eq_t& _e = eq_t()) : base(_h, _e) { };
+
+        /// @brief Constructor, from a range of key-value pairs (the last value of equal keys is kept).
+        /// @param _first The first pair.
+        /// @param _last One past the last pair.
+        template <std::input_iterator it_t>
+        flat_hash_map(it_t _first, it_t _last) {
+            insert(_first, _last);
+        };
+
+        /// @brief Constructor, from a list of key-value pairs (the last value of equal keys is kept).
+        flat_hash_map(std::initializer_list<value_type> _l) : flat_hash_map(_l.begin(), _l.end()) { };
+
+
+        ///------------- @section Member functions. -------------///
+
+
+        /// @brief Inserting a key and value pair into the map, the value is replaced if the key exists.
+        /// @param _k Key
+        /// @param _v Value
+        /// @return The element, and whether the key was inserted.
+        std::pair<iterator, bool> insert(const k& _k, const v& _v) {
+            auto [_i, _claimed] = this->find_or_claim(_k);
+            if (!_claimed)
+                this->_slots[_i].second = _v;
+            else
+                construct(_i, _k, _v);
+            return { this->at_index(_i), _claimed };
+        };
+
+        /// @brief Inserting a range of key-value pairs (later values replace earlier ones).
+        /// @param _first The first pair.
+        /// @param _last One past the last pair.
+        template <std::input_iterator it_t>
+        void insert(it_t _first, it_t _last) {
+            if constexpr (std::forward_iterator<it_t>)
+                this->reserve(this->_size + static_cast<std::size_t>(std::distance(_first, _last)));
+            for (; _first != _last; ++_first) {
+                auto&& _e = *_first;
+                insert(_e.first, _e.second);
+            }
+        };
+
+        /// @brief Inserting a key and a value constructed in place, unless the key exists.
+        /// @param _k Key
+        /// @param _args Value constructor arguments.
+        /// @return The element, and whether the key was inserted.
+        template <typename ... args_t>
+        std::pair<iterator, bool> try_emplace(const k& _k, args_t&&... _args) {
+            auto [_i, _claimed] = this->find_or_claim(_k);
+            if (_claimed)
+                construct(_i, _k, std::forward<args_t>(_args)...);
+            return { this->at_index(_i), _claimed };
+        };
+
+        /// @brief Get the value of a key.
+        /// @param _k The key.
+        /// @return The value, throws std::out_of_range if the key does not exist.
+        v& at(const k& _k) {
+            auto _i = this->find_index(_k);
+            if (_i == this->_capacity)
+                throw std::out_of_range("flat_hash_map::at: key not found");
+            return this->_slots[_i].second;
+        };
+        const v& at(const k& _k) const {
+            auto _i = this->find_index(_k);
+            if (_i == this->_capacity)
+                throw std::out_of_range("flat_hash_map::at: key not found");
+            return this->_slots[_i].second;
+        };
+
+
+        ///------------- @section Operator functions. -------------///
+
+
+        /// @brief Get the value of a key, a default constructed value is inserted if the key does not exist.
+        v& operator[](const k& _k) {
+            auto [_i, _claimed] = this->find_or_claim(_k);
+            if (_claimed)
+                construct(_i, _k);
+            return this->_slots[_i].second;
+        };
+
+        /// @brief Get the value of a key, throws std::out_of_range if the key does not exist.
+        const v& operator[](const k& _k) const {
+            return at(_k);
+        };
+
+    private:
+
+        /// @brief Constructs the element of a claimed slot.
+        template <typename ... args_t>
+        void construct(std::size_t _i, const k& _k, args_t&&... _args) {
+            try {
+                ::new (static_cast<void*>(this->_slots + _i)) std::pair<k, v>(std::piecewise_construct,
+                    std::forward_as_tuple(_k), std::forward_as_tuple(std::forward<args_t>(_args)...));
+            }
+            catch (...) {
+                this->abandon(_i);
+                throw;
+            }
+        };
+    };
+
+    /// @brief Flat hash set container, the keys of a flat_hash_map without values.
+    /// @tparam k Key typename.
+    /// @tparam hash_t Hash typename.
+    /// @tparam eq_t Key equality typename.
+    template <typename k,
+        typename hash_t = std::hash<k>,
+        typename eq_t = std::equal_to<k>>
+    class flat_hash_set : public __detail::hash_table<__detail::hash_set_policy<k>, hash_t, eq_t> {
+    private:
+
+        using base = __detail::hash_table<__detail::hash_set_policy<k>, hash_t, eq_t>;
+
+    public:
+
+        using reference = const k&;
+        using const_reference = const k&;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        flat_hash_set() = default;
+
+        /// @brief Explicit Constructor
+        /// @param _h The hash.
+        /// @param _e The key equality.
+        explicit flat_hash_set(const hash_t& _h, const eq_t& _e = eq_t()) : base(_h, _e) { };
+
+        /// @brief Constructor, from a range of keys.
+        /// @param _first The first key.
+        /// @param _last One past the last key.
+        template <std::input_iterator it_t>
+        flat_hash_set(it_t _first, it_t _last) {
+            insert(_first, _last);
+        };
+
+        /// @brief Constructor, from a list of keys.
+        flat_hash_set(std::initializer_list<k> _l) : flat_hash_set(_l.begin(), _l.end()) { };
+
+
+        ///------------- @section Member functions. -------------///
+
+
+        /// @brief Inserting a key into the set.
+        /// @param _k Key
+        /// @return The element, and whether the key was inserted.
+        std::pair<iterator, bool> insert(const k& _k) {
+            auto [_i, _claimed] = this->find_or_claim(_k);
+            if (_claimed) {
+                try {
+                    ::new (static_cast<void*>(this->_slots + _i)) k(_k);
+                }
+                catch (...) {
+                    this->abandon(_i);
+                    throw;
+                }
+            }
+            return { this->at_index(_i), _claimed };
+        };
+
+        /// @brief Inserting a range of keys.
+        /// @param _first The first key.
+        /// @param _last One past the last key.
+        template <std::input_iterator it_t>
+        void insert(it_t _first, it_t _last) {
+            if constexpr (std::forward_iterator<it_t>)
+                this->reserve(this->_size + static_cast<std::size_t>(std::distance(_first, _last)));
+            for (; _first != _last; ++_first)
+                insert(*_first);
+        };
+    };
+};
@@ -8,192 +8,1369 @@
  **/
 #pragma once
 
-/// @uses: std::int64_t, std::map, std::vector
+/// @uses: std::map, std::vector, std::lower_bound, std::upper_bound, std::pair, std::pmr::vector, std::make_obj_using_allocator, std::byteswap
 #include <bits/stdc++.h>
 
 
 /// @brief Namespace for the "gnu/linux c++23 standard".
 namespace __gnu_cxx::v23 {
 
-    /// @brief Flat map container.
+    namespace __detail {
+        /// @brief Checks if the keys of a flat map can be searched with the integer search kernels below: integral keys
+        ///     in contiguous storage, ordered by std::less.
+        template <typename k, typename k_compare, typename k_container>
+        inline constexpr bool is_integral_search_v = std::is_integral_v<k> && !std::is_same_v<k, bool> &&
+            (std::is_same_v<k_compare, std::less<k>> || std::is_same_v<k_compare, std::less<>>) &&
+            std::contiguous_iterator<typename k_container::const_iterator>;
+
+        /// @brief The width of the vectors the linear search compares at once (what the target can do in one instruction).
+#if defined(__AVX2__)
+        inline constexpr std::size_t search_vector_size = 32;
+#else
+        inline constexpr std::size_t search_vector_size = 16;
+#endif
+
+        /// @brief Up to how many keys a linear scan beats a binary search (a few vector compares, no mispredictions).
+        template <typename k>
+        inline constexpr std::size_t linear_search_max = 4 * search_vector_size / sizeof(k);
+
+        /// @brief Counts the keys less than (or with _upper, not greater than) a key in a short sorted array, which is its
+        ///     lower (or upper) bound. Compares a vector of keys at a time with GNU vector extensions, without branches.
+        /// @param _p The keys.
+        /// @param _n The amount of keys.
+        /// @param _k The key.
+        /// @return The amount of keys less than (not greater than) the key.
+        template <bool _upper, typename k>
+        inline std::size_t
+        linear_search(const k* _p, std::size_t _n, k _k) {
+            constexpr std::size_t _lanes = search_vector_size / sizeof(k);
+            typedef k vector_t __attribute__((vector_size(search_vector_size)));
+
+            std::size_t _i = 0, _r = 0;
+            if (_n >= _lanes) {
+                auto _kv = vector_t{} + _k;
+                decltype(_kv < _kv) _acc{};
+                for (; _i + _lanes <= _n; _i += _lanes) {
+                    vector_t _v;
+                    std::memcpy(&_v, _p + _i, sizeof(_v));
+                    /// A true lane is all ones (-1), subtracting counts it.
+                    if constexpr (_upper)
+                        _acc -= _v <= _kv;
+                    else
+                        _acc -= _v < _kv;
+                }
+                for (std::size_t _j = 0; _j < _lanes; ++_j)
+                    _r += static_cast<std::size_t>(_acc[_j]);
+            }
+            for (; _i < _n; ++_i)
+                _r += _upper ? _p[_i] <= _k : _p[_i] < _k;
+            return _r;
+        };
+
+        /// @brief Finds the lower (or with _upper, upper) bound of a key in a sorted array.
+        ///     Short arrays are scanned linearly, longer ones binary searched without branches: the half to continue in is
+        ///     picked arithmetically (a conditional move), so there are no mispredictions, and both possible next probes
+        ///     are prefetched once the array outgrows the cache.
+        /// @param _p The keys.
+        /// @param _n The amount of keys.
+        /// @param _k The key.
+        /// @return The index of the bound.
+        template <bool _upper, typename k>
+        inline std::size_t
+        integral_search(const k* _p, std::size_t _n, k _k) {
+            if (_n <= linear_search_max<k>)
+                return linear_search<_upper>(_p, _n, _k);
+
+            const k* _base = _p;
+            constexpr std::size_t _prefetch_min = (256 * 1024) / sizeof(k);
+            if (_n >= _prefetch_min) {
+                while (_n > 1) {
+                    auto _half = _n / 2;
+                    __builtin_prefetch(_base + _half / 2);
+                    __builtin_prefetch(_base + _half + _half / 2);
+                    _base += (_upper ? _base[_half] <= _k : _base[_half] < _k) ? _half : 0;
+                    _n -= _half;
+                }
+            }
+            else {
+                while (_n > 1) {
+                    auto _half = _n / 2;
+                    _base += (_upper ? _base[_half] <= _k : _base[_half] < _k) ? _half : 0;
+                    _n -= _half;
+                }
+            }
+            return static_cast<std::size_t>(_base - _p) + (_upper ? *_base <= _k : *_base < _k);
+        };
+    };
+
+    namespace __detail {
+        /// @brief Iterator over the key and value containers of a flat map, it dereferences to a pair of references.
+        ///     It steps over elements erased from a flat_map that has not been compacted yet, the arithmetic operators
+        ///     included: they count the elements that are not erased, a word of positions at a time (so std::distance()
+        ///     agrees with size() and count(), and algorithms never land on an erased element).
+        /// @tparam k_it Key iterator (always constant, keys are not modifiable in place).
+        /// @tparam v_it Value iterator.
+        template <typename k_it, typename v_it>
+        class flat_map_iterator {
+        public:
+
+            using iterator_category = std::random_access_iterator_tag;
+            using iterator_concept = std::random_access_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = std::pair<std::iter_value_t<k_it>, std::iter_value_t<v_it>>;
+            using reference = std::pair<std::iter_reference_t<k_it>, std::iter_reference_t<v_it>>;
+
+            /// @brief The pair of references, for operator->.
+            struct pointer {
+                reference _ref;
+                reference* operator->() { return std::addressof(_ref); };
+            };
+
+        private:
+
+            /// Key iterator.
+            k_it _kit{};
+            /// Value iterator.
+            v_it _vit{};
+            /// The erased positions, a bit each (nullptr when there are none).
+            const std::uint64_t* _dead = nullptr;
+            /// The position, and the amount of positions (only kept up with when there are erased positions).
+            std::size_t _i = 0, _n = 0;
+
+            /// @brief Checks if a position is erased.
+            bool dead_at(std::size_t _p) const { return _dead != nullptr && _p < _n && (_dead[_p / 64] >> (_p % 64)) & 1; };
+
+            /// @brief Steps forward over erased positions.
+            void skip() { for (; dead_at(_i); ++_i) { ++_kit; ++_vit; } };
+
+            /// @brief Get the positions of a word that are not erased (the bits past the last position are clear).
+            std::uint64_t live_word(std::size_t _w) const {
+                auto _l = ~_dead[_w];
+                if ((_w + 1) * 64 > _n)
+                    _l &= (std::uint64_t(1) << (_n % 64)) - 1;
+                return _l;
+            };
+
+            /// @brief Get the amount of erased positions in [_b, _e).
+            std::size_t dead_between(std::size_t _b, std::size_t _e) const {
+                std::size_t _r = 0;
+                for (; _b < _e; _b = (_b / 64 + 1) * 64) {
+                    auto _bits = _dead[_b / 64] & (~std::uint64_t(0) << (_b % 64));
+                    if (_e - _b / 64 * 64 < 64)
+                        _bits &= (std::uint64_t(1) << (_e % 64)) - 1;
+                    _r += static_cast<std::size_t>(std::popcount(_bits));
+                }
+                return _r;
+            };
+
+            /// @brief Steps over an amount of elements that are not erased, a word of positions at a time.
+            void advance(difference_type _m) {
+                if (_dead == nullptr) {
+                    _kit += _m;
+                    _vit += _m;
+                    return;
+                }
+                std::size_t _p = _i;
+                if (_m > 0) {
+                    auto _r = static_cast<std::size_t>(_m);
+                    for (; _p < _n; _p = (_p / 64 + 1) * 64) {
+                        auto _live = live_word(_p / 64) & (~std::uint64_t(0) << (_p % 64));
+                        auto _c = static_cast<std::size_t>(std::popcount(_live));
+                        if (_c > _r) {
+                            for (; _r != 0; --_r)
+                                _live &= _live - 1;
+                            _p = _p / 64 * 64 + static_cast<std::size_t>(std::countr_zero(_live));
+                            break;
+                        }
+                        _r -= _c;
+                    }
+                    _p = std::min(_p, _n);
+                }
+                else if (_m < 0) {
+                    auto _r = static_cast<std::size_t>(-_m);
+                    for (std::size_t _e = _i; _e != 0; _e = (_e - 1) / 64 * 64) {
+                        auto _w = (_e - 1) / 64;
+                        auto _live = live_word(_w) & (~std::uint64_t(0) >> (63 - (_e - 1) % 64));
+                        auto _c = static_cast<std::size_t>(std::popcount(_live));
+                        if (_c >= _r) {
+                            for (; _r > 1; --_r)
+                                _live &= ~(std::uint64_t(1) << (63 - std::countl_zero(_live)));
+                            _p = _w * 64 + 63 - static_cast<std::size_t>(std::countl_zero(_live));
+                            break;
+                        }
+                        _r -= _c;
+                    }
+                }
+                auto _d = static_cast<difference_type>(_p) - static_cast<difference_type>(_i);
+                _kit += _d;
+                _vit += _d;
+                _i = _p;
+            };
+
+        public:
+
+            flat_map_iterator() = default;
+
+            /// @brief Constructor
+            /// @param _k The key iterator.
+            /// @param _v The value iterator.
+            flat_map_iterator(k_it _k, v_it _v) : _kit(_k), _vit(_v) { };
+
+            /// @brief Constructor, at the first element not erased from a position on.
+            /// @param _k The key iterator.
+            /// @param _v The value iterator.
+            /// @param _d The erased positions.
+            /// @param _p The position.
+            /// @param _c The amount of positions.
+            flat_map_iterator(k_it _k, v_it _v, const std::uint64_t* _d, std::size_t _p, std::size_t _c)
+                : _kit(_k), _vit(_v), _dead(_d), _i(_p), _n(_c) { skip(); };
+
+            /// @brief Converting Constructor (iterator to const iterator).
+            template <typename o_it>
+                requires (!std::is_same_v<o_it, v_it> && std::is_convertible_v<o_it, v_it>)
+            flat_map_iterator(const flat_map_iterator<k_it, o_it>& _o) : _kit(_o.key_iterator()), _vit(_o.value_iterator()),
+                _dead(_o._dead), _i(_o._i), _n(_o._n) { };
+
+            /// @brief Get the key iterator.
+            k_it key_iterator() const { return _kit; };
+            /// @brief Get the value iterator.
+            v_it value_iterator() const { return _vit; };
+
+            reference operator*() const { return { *_kit, *_vit }; };
+            pointer operator->() const { return { **this }; };
+            reference operator[](difference_type _m) const { return *(*this + _m); };
+
+            flat_map_iterator& operator++() { ++_kit; ++_vit; ++_i; skip(); return *this; };
+            flat_map_iterator operator++(int) { auto _t = *this; ++*this; return _t; };
+            flat_map_iterator& operator--() { do { --_kit; --_vit; } while (dead_at(--_i)); return *this; };
+            flat_map_iterator operator--(int) { auto _t = *this; --*this; return _t; };
+            flat_map_iterator& operator+=(difference_type _m) { advance(_m); return *this; };
+            flat_map_iterator& operator-=(difference_type _m) { advance(-_m); return *this; };
+
+            friend flat_map_iterator operator+(flat_map_iterator _it, difference_type _n) { return _it += _n; };
+            friend flat_map_iterator operator+(difference_type _n, flat_map_iterator _it) { return _it += _n; };
+            friend flat_map_iterator operator-(flat_map_iterator _it, difference_type _n) { return _it -= _n; };
+            friend difference_type operator-(const flat_map_iterator& _a, const flat_map_iterator& _b) {
+                auto _d = _a._kit - _b._kit;
+                if (_a._dead == nullptr || _b._dead == nullptr)
+                    return _d;
+                if (_d >= 0)
+                    return _d - static_cast<difference_type>(_a.dead_between(_b._i, _a._i));
+                return _d + static_cast<difference_type>(_a.dead_between(_a._i, _b._i));
+            };
+            friend bool operator==(const flat_map_iterator& _a, const flat_map_iterator& _b) { return _a._kit == _b._kit; };
+            friend auto operator<=>(const flat_map_iterator& _a, const flat_map_iterator& _b) { return _a._kit <=> _b._kit; };
+
+            template <typename, typename>
+            friend class flat_map_iterator;
+        };
+    };
+
+    /// @brief Tag for inputs whose keys are sorted and unique, they are adopted without any comparisons.
+    struct sorted_unique_t { explicit sorted_unique_t() = default; };
+    inline constexpr sorted_unique_t sorted_unique{};
+
+    /// @brief Tag for inputs whose keys are sorted (equal keys allowed), they are adopted without any comparisons.
+    struct sorted_equivalent_t { explicit sorted_equivalent_t() = default; };
+    inline constexpr sorted_equivalent_t sorted_equivalent{};
+
+    /// @brief A string key that keeps its first 8 characters in an integer next to the string (big-endian, zero padded,
+    ///     so integers order like the strings), then comparisons of keys that differ in them, most of the comparisons of
+    ///     a binary search, do not touch the characters of long strings on the heap.
+    ///     Compares with std::string_view (and a std::string or a const char*), so flat_map<prefixed_string, v, std::less<>>
+    ///     is looked up with any of them without constructing a key.
+    class prefixed_string {
+    private:
+
+        /// The first 8 characters, the first one in the highest byte.
+        std::uint64_t _prefix = 0;
+        /// The string.
+        std::string _str;
+
+        /// @brief Compares two strings and their prefixes.
+        static std::strong_ordering compare(std::uint64_t _pa, std::string_view _a, std::uint64_t _pb, std::string_view _b) {
+            if (_pa != _pb)
+                return _pa <=> _pb;
+            /// Equal prefixes and one of the strings fits in them: it is the start of the other one.
+            if (_a.size() <= 8 || _b.size() <= 8)
+                return _a.size() <=> _b.size();
+            return _a.substr(8).compare(_b.substr(8)) <=> 0;
+        };
+
+    public:
+
+        prefixed_string() = default;
+
+        /// @brief Constructor
+        /// @param _s The string.
+        explicit prefixed_string(std::string _s) : _prefix(prefix_of(_s)), _str(std::move(_s)) { };
+        explicit prefixed_string(std::string_view _s) : prefixed_string(std::string(_s)) { };
+        explicit prefixed_string(const char* _s) : prefixed_string(std::string(_s)) { };
+
+        /// @brief Gets the prefix of a string, its first 8 characters as a big-endian integer.
+        static std::uint64_t prefix_of(std::string_view _s) {
+            std::uint64_t _p = 0;
+            if (!_s.empty())
+                std::memcpy(&_p, _s.data(), std::min<std::size_t>(_s.size(), 8));
+            if constexpr (std::endian::native == std::endian::little)
+                _p = std::byteswap(_p);
+            return _p;
+        };
+
+        /// @brief Get the string.
+        const std::string& str() const { return _str; };
+        /// @brief Get a view of the string.
+        std::string_view view() const { return _str; };
+        /// @brief Get the cached prefix.
+        std::uint64_t prefix() const { return _prefix; };
+        /// @brief Get the length of the string.
+        std::size_t size() const { return _str.size(); };
+
+        friend bool operator==(const prefixed_string& _a, const prefixed_string& _b) {
+            return _a._prefix == _b._prefix && _a._str == _b._str;
+        };
+        friend bool operator==(const prefixed_string& _a, std::string_view _b) {
+            return _a._prefix == prefix_of(_b) && _a.view() == _b;
+        };
+        friend std::strong_ordering operator<=>(const prefixed_string& _a, const prefixed_string& _b) {
+            return compare(_a._prefix, _a._str, _b._prefix, _b._str);
+        };
+        friend std::strong_ordering operator<=>(const prefixed_string& _a, std::string_view _b) {
+            return compare(_a._prefix, _a._str, prefix_of(_b), _b);
+        };
+    };
+
+
+    namespace __detail {
+        /// @brief The allocator of a container rebound to another element type (std::allocator for a container without one),
+        ///     so the scratch space of a flat map comes from the same place as its elements.
+        template <typename c, typename t>
+        struct rebind_alloc { using type = std::allocator<t>; };
+        template <typename c, typename t>
+            requires requires { typename c::allocator_type; }
+        struct rebind_alloc<c, t> { using type = typename std::allocator_traits<typename c::allocator_type>::template rebind_alloc<t>; };
+        template <typename c, typename t>
+        using rebind_alloc_t = typename rebind_alloc<c, t>::type;
+
+        /// @brief Checks if an allocator can construct both containers of a flat map.
+        template <typename alloc_t, typename k_container, typename v_container>
+        concept container_allocator = std::uses_allocator_v<k_container, alloc_t> && std::uses_allocator_v<v_container, alloc_t>;
+
+        /// @brief Checks if a key comparison is transparent, then keys are looked up with anything it compares them with
+        ///     (a std::string_view or a const char* for std::string keys and std::less<>) without constructing a key.
+        template <typename k_compare>
+        concept transparent_compare = requires { typename k_compare::is_transparent; };
+
+        /// @brief The storage and lookups shared by flat_map and flat_multi_map: a key container sorted by k_compare and a
+        ///     value container kept in step with it.
+        /// @tparam k Key typename.
+        /// @tparam v Value typename.
+        /// @tparam k_compare Key comparison typename.
+        /// @tparam k_container Key container typename.
+        /// @tparam v_container Value container typename.
+        template <typename k, typename v, typename k_compare, typename k_container, typename v_container>
+        class flat_storage {
+        public:
+
+            using key_type = k;
+            using mapped_type = v;
+            using value_type = std::pair<k, v>;
+            using key_compare = k_compare;
+            using reference = std::pair<const k&, v&>;
+            using const_reference = std::pair<const k&, const v&>;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using key_container_type = k_container;
+            using mapped_container_type = v_container;
+            using iterator = flat_map_iterator<typename k_container::const_iterator, typename v_container::iterator>;
+            using const_iterator = flat_map_iterator<typename k_container::const_iterator, typename v_container::const_iterator>;
+
+        protected:
+
+            /// Sorted keys.
+            k_container _keys;
+            /// Values, in the order of their keys.
+            v_container _values;
+            /// Key comparison.
+            [[no_unique_address]] k_compare _cmp;
+            /// The erased positions a bit each, elements erased from a flat_map stay in place until it is compacted
+            ///     (the bits are only allocated while there are any).
+            std::vector<std::uint64_t, rebind_alloc_t<k_container, std::uint64_t>> _dead;
+            /// The amount of erased positions.
+            std::size_t _tombstones = 0;
+            /// The share of erased positions that triggers a compaction.
+            float _max_tombstones = 0.25f;
+
+            flat_storage() = default;
+            explicit flat_storage(const k_compare& _c) : _cmp(_c) { };
+
+            /// @brief Constructor, adopts a key and a value container (they are not sorted here).
+            flat_storage(k_container&& _k, v_container&& _v, const k_compare& _c) : _keys(std::move(_k)), _values(std::move(_v)), _cmp(_c) {
+                if (_keys.size() != _values.size())
+                    throw std::invalid_argument("flat_map: the key and value containers differ in size");
+            };
+
+            /// @brief Constructor, both containers (and the erased bits) allocate with an allocator.
+            template <container_allocator<k_container, v_container> alloc_t>
+            flat_storage(const k_compare& _c, const alloc_t& _a)
+                : _keys(std::make_obj_using_allocator<k_container>(_a)), _values(std::make_obj_using_allocator<v_container>(_a)), _cmp(_c),
+                  _dead(std::make_obj_using_allocator<decltype(_dead)>(_a)) { };
+
+            /// @brief Constructor, copies the elements of another container into storage of an allocator.
+            template <container_allocator<k_container, v_container> alloc_t>
+            flat_storage(const flat_storage& _o, const alloc_t& _a)
+                : _keys(std::make_obj_using_allocator<k_container>(_a, _o._keys)),
+                  _values(std::make_obj_using_allocator<v_container>(_a, _o._values)), _cmp(_o._cmp),
+                  _dead(std::make_obj_using_allocator<decltype(_dead)>(_a, _o._dead)), _tombstones(_o._tombstones),
+                  _max_tombstones(_o._max_tombstones) { };
+
+            /// @brief Constructor, moves the elements of another container into storage of an allocator (they are copied
+            ///     one by one if the allocators differ).
+            template <container_allocator<k_container, v_container> alloc_t>
+            flat_storage(flat_storage&& _o, const alloc_t& _a)
+                : _keys(std::make_obj_using_allocator<k_container>(_a, std::move(_o._keys))),
+                  _values(std::make_obj_using_allocator<v_container>(_a, std::move(_o._values))), _cmp(_o._cmp),
+                  _dead(std::make_obj_using_allocator<decltype(_dead)>(_a, std::move(_o._dead))),
+                  _tombstones(std::exchange(_o._tombstones, 0)), _max_tombstones(_o._max_tombstones) { };
+
+            /// @brief Gets an empty container that allocates like another one.
+            template <typename c>
+            static c empty_like(const c& _o) {
+                if constexpr (requires { c(_o.get_allocator()); })
+                    return c(_o.get_allocator());
+                else
+                    return c();
+            };
+
+            /// @brief Gets the allocator of the keys, rebound to scratch space of another type.
+            template <typename t>
+            rebind_alloc_t<k_container, t> scratch_allocator() const {
+                if constexpr (requires { rebind_alloc_t<k_container, t>(_keys.get_allocator()); })
+                    return rebind_alloc_t<k_container, t>(_keys.get_allocator());
+                else
+                    return {};
+            };
+
+            /// @brief Gets the index of the first key not less than a key (or anything a transparent k_compare compares keys with).
+            template <typename q>
+            std::size_t lower_index(const q& _k) const {
+                if constexpr (is_integral_search_v<k, k_compare, k_container> && std::is_same_v<q, k>)
+                    return integral_search<false>(std::to_address(_keys.begin()), _keys.size(), _k);
+                else
+                    return static_cast<std::size_t>(std::lower_bound(_keys.begin(), _keys.end(), _k, _cmp) - _keys.begin());
+            };
+
+            /// @brief Gets the index of the first key greater than a key.
+            template <typename q>
+            std::size_t upper_index(const q& _k) const {
+                if constexpr (is_integral_search_v<k, k_compare, k_container> && std::is_same_v<q, k>)
+                    return integral_search<true>(std::to_address(_keys.begin()), _keys.size(), _k);
+                else
+                    return static_cast<std::size_t>(std::upper_bound(_keys.begin(), _keys.end(), _k, _cmp) - _keys.begin());
+            };
+
+            /// @brief Gets the indices of the first key not less than and the first key greater than a key.
+            ///     The end of the run of equal keys is galloped to from its start (probing 1, 2, 4, ... keys ahead, then a
+            ///     binary search in the last step), so it costs the logarithm of the run rather than of the container.
+            template <typename q>
+            std::pair<std::size_t, std::size_t> equal_indices(const q& _k) const {
+                auto _b = lower_index(_k), _n = _keys.size();
+                if (!equal_at(_b, _k))
+                    return { _b, _b };
+                std::size_t _lo = _b + 1, _step = 1;
+                while (_lo + _step <= _n && !_cmp(_k, _keys[_lo + _step - 1])) {
+                    _lo += _step;
+                    _step *= 2;
+                }
+                auto _hi = std::min(_lo + _step, _n);
+                auto _e = std::upper_bound(_keys.begin() + _lo, _keys.begin() + _hi, _k, _cmp) - _keys.begin();
+                return { _b, static_cast<std::size_t>(_e) };
+            };
+
+            /// @brief Checks if the key at an index is equal to a key, erased or not.
+            template <typename q>
+            bool key_at(std::size_t _i, const q& _k) const {
+                return _i < _keys.size() && !_cmp(_k, _keys[_i]);
+            };
+
+            /// @brief Checks if the element at an index has a key equal to a key (and is not erased).
+            template <typename q>
+            bool equal_at(std::size_t _i, const q& _k) const {
+                return key_at(_i, _k) && !is_dead(_i);
+            };
+
+            /// @brief Checks if the element at an index is erased.
+            bool is_dead(std::size_t _i) const {
+                return _tombstones != 0 && (_dead[_i / 64] >> (_i % 64)) & 1;
+            };
+
+            /// @brief Erases the element at an index by marking it, compacting once the share of erased elements is too high.
+            /// @return Whether it compacted.
+            bool mark_dead(std::size_t _i) {
+                if (_dead.empty())
+                    _dead.assign((_keys.size() + 63) / 64, 0);
+                _dead[_i / 64] |= std::uint64_t(1) << (_i % 64);
+                ++_tombstones;
+                if (static_cast<float>(_tombstones) <= _max_tombstones * static_cast<float>(_keys.size()))
+                    return false;
+                compact();
+                return true;
+            };
+
+            /// @brief Brings an erased element back (its value is assigned right after).
+            void revive(std::size_t _i) {
+                _dead[_i / 64] &= ~(std::uint64_t(1) << (_i % 64));
+                if (--_tombstones == 0)
+                    _dead.clear();
+            };
+
+            /// @brief Gets the amount of erased elements before an index.
+            std::size_t dead_before(std::size_t _i) const {
+                if (_tombstones == 0)
+                    return 0;
+                std::size_t _r = 0;
+                for (std::size_t _w = 0; _w < _i / 64; ++_w)
+                    _r += static_cast<std::size_t>(std::popcount(_dead[_w]));
+                if (_i % 64 != 0)
+                    _r += static_cast<std::size_t>(std::popcount(_dead[_i / 64] & ((std::uint64_t(1) << (_i % 64)) - 1)));
+                return _r;
+            };
+
+            /// @brief Drops everything from an index on, and the erased positions (after a compacting pass).
+            void shrink_to(std::size_t _n) {
+                _keys.erase(_keys.begin() + _n, _keys.end());
+                _values.erase(_values.begin() + _n, _values.end());
+                _dead.clear();
+                _tombstones = 0;
+            };
+
+            /// @brief Gets the iterator at an index (or the first element after it that is not erased).
+            iterator at_index(std::size_t _i) {
+                if (_tombstones != 0)
+                    return iterator(_keys.cbegin() + _i, _values.begin() + _i, _dead.data(), _i, _keys.size());
+                return iterator(_keys.cbegin() + _i, _values.begin() + _i);
+            };
+            const_iterator at_index(std::size_t _i) const {
+                if (_tombstones != 0)
+                    return const_iterator(_keys.cbegin() + _i, _values.cbegin() + _i, _dead.data(), _i, _keys.size());
+                return const_iterator(_keys.cbegin() + _i, _values.cbegin() + _i);
+            };
+
+            /// @brief Inserts a key and a value (constructed from _args) at an index, keeping both containers in step.
+            template <typename ... args_t>
+            iterator insert_at(std::size_t _i, const k& _k, args_t&&... _args) {
+                _keys.insert(_keys.begin() + _i, _k);
+                try {
+                    _values.emplace(_values.begin() + _i, std::forward<args_t>(_args)...);
+                }
+                catch (...) {
+                    _keys.erase(_keys.begin() + _i);
+                    throw;
+                }
+                return at_index(_i);
+            };
+
+            /// @brief Inserts a key that is not in a flat_map (with a value constructed from _args) at its lower bound index.
+            ///     An erased position right before or at the index takes it without moving anything (the key sorts between
+            ///     its neighbours there as well), otherwise erased elements are compacted away before inserting.
+            template <typename ... args_t>
+            iterator place(std::size_t _i, const k& _k, args_t&&... _args) {
+                if (_tombstones != 0) {
+                    std::size_t _slot = _i > 0 && is_dead(_i - 1) ? _i - 1 : _i;
+                    if (_slot < _keys.size() && is_dead(_slot)) {
+                        _values[_slot] = v(std::forward<args_t>(_args)...);
+                        _keys[_slot] = _k;
+                        revive(_slot);
+                        return at_index(_slot);
+                    }
+                    compact();
+                    _i = lower_index(_k);
+                }
+                return insert_at(_i, _k, std::forward<args_t>(_args)...);
+            };
+
+            /// @brief Appends a range of key-value pairs after the sorted elements (merge_appended() sorts them in).
+            template <typename it_t>
+            void append(it_t _first, it_t _last) {
+                compact();
+                auto _old = _keys.size();
+                if constexpr (std::forward_iterator<it_t>) {
+                    auto _n = static_cast<std::size_t>(std::distance(_first, _last));
+                    if constexpr (requires { _keys.reserve(_n); _values.reserve(_n); }) {
+                        _keys.reserve(_old + _n);
+                        _values.reserve(_old + _n);
+                    }
+                }
+                try {
+                    for (; _first != _last; ++_first) {
+                        auto&& _e = *_first;
+                        _keys.emplace_back(_e.first);
+                        _values.emplace_back(_e.second);
+                    }
+                }
+                catch (...) {
+                    _keys.erase(_keys.begin() + _old, _keys.end());
+                    _values.erase(_values.begin() + _old, _values.end());
+                    throw;
+                }
+            };
+
+            /// @brief Sorts the elements appended after index _old in with the ones before it, in a single pass over all of them.
+            ///     Equal keys keep their order (the ones before _old first), with _unique only the last of them is kept.
+            /// @param _old The amount of sorted elements before the appended ones.
+            /// @param _unique Whether equal keys are collapsed.
+            /// @param _sorted Whether the appended keys are known to be sorted (and unique, with _unique).
+            void merge_appended(std::size_t _old, bool _unique, bool _sorted) {
+                auto _n = _keys.size();
+                if (_old == _n)
+                    return;
+                auto _kb = _keys.begin() + _old;
+                if (!_sorted)
+                    _sorted = _unique ? std::adjacent_find(_kb, _keys.end(), [&](const k& _a, const k& _b) { return !_cmp(_a, _b); }) == _keys.end()
+                                      : std::is_sorted(_kb, _keys.end(), _cmp);
+
+                /// Sorted input that goes after everything there is (rebuilding from sorted data, or appending) is already in place.
+                if (_sorted && (_old == 0 || (_unique ? _cmp(_keys[_old - 1], _keys[_old]) : !_cmp(_keys[_old], _keys[_old - 1]))))
+                    return;
+
+                /// Otherwise sort the keys next to their positions, the values move once at the end. All of the scratch
+                ///     space is allocated before any key moves: if that throws the appended elements are dropped, and the
+                ///     sorted ones before them are left as they were.
+                using scratch_t = std::vector<std::pair<k, std::size_t>, rebind_alloc_t<k_container, std::pair<k, std::size_t>>>;
+                scratch_t _s(scratch_allocator<std::pair<k, std::size_t>>());
+                scratch_t _m(_s.get_allocator());
+                auto _nk = empty_like(_keys);
+                auto _nv = empty_like(_values);
+                try {
+                    _s.reserve(_n);
+                    if (_old != 0)
+                        _m.reserve(_n);
+                    if constexpr (requires { _nk.reserve(_n); _nv.reserve(_n); }) {
+                        _nk.reserve(_n);
+                        _nv.reserve(_n);
+                    }
+                }
+                catch (...) {
+                    _keys.erase(_kb, _keys.end());
+                    _values.erase(_values.begin() + _old, _values.end());
+                    throw;
+                }
+
+                for (std::size_t _i = 0; _i < _n; ++_i)
+                    _s.emplace_back(std::move(_keys[_i]), _i);
+                auto _by_key = [&](const auto& _a, const auto& _b) { return _cmp(_a.first, _b.first); };
+                if (!_sorted)
+                    std::sort(_s.begin() + _old, _s.end(), [&](const auto& _a, const auto& _b) {
+                        return _cmp(_a.first, _b.first) || (!_cmp(_b.first, _a.first) && _a.second < _b.second);
+                    });
+                /// Merged into scratch space of the same allocator (std::inplace_merge would take its buffer from the heap).
+                if (_old != 0) {
+                    std::merge(std::make_move_iterator(_s.begin()), std::make_move_iterator(_s.begin() + _old),
+                        std::make_move_iterator(_s.begin() + _old), std::make_move_iterator(_s.end()), std::back_inserter(_m), _by_key);
+                    _s.swap(_m);
+                }
+
+                for (std::size_t _i = 0; _i < _n; ++_i) {
+                    if (_unique && _i + 1 < _n && !_cmp(_s[_i].first, _s[_i + 1].first))
+                        continue;
+                    _nk.emplace_back(std::move(_s[_i].first));
+                    _nv.emplace_back(std::move(_values[_s[_i].second]));
+                }
+                _keys = std::move(_nk);
+                _values = std::move(_nv);
+            };
+
+        public:
+
+            ///------------- @section Member functions. -------------///
+
+
+            /// @brief Erasing the element at an iterator.
+            /// @param _it The iterator.
+            /// @return The iterator after the erased element.
+            iterator erase(const_iterator _it) {
+                auto _i = static_cast<std::size_t>(_it.key_iterator() - _keys.cbegin());
+                _keys.erase(_keys.begin() + _i);
+                _values.erase(_values.begin() + _i);
+                return at_index(_i);
+            };
+
+            /// @brief Erasing all elements.
+            void clear() {
+                _keys.clear();
+                _values.clear();
+                _dead.clear();
+                _tombstones = 0;
+            };
+
+            /// @brief Erasing the elements a predicate is true for, in a single pass (that compacts as well).
+            /// @param _pred The predicate, gets a const_reference.
+            /// @return The amount of erased elements.
+            template <typename pred_t>
+            std::size_t erase_if(pred_t _pred) {
+                std::size_t _w = 0, _i = 0, _n = _keys.size(), _erased = 0;
+                auto _keep = [&]() {
+                    if (_w != _i) {
+                        _keys[_w] = std::move(_keys[_i]);
+                        _values[_w] = std::move(_values[_i]);
+                    }
+                    ++_w;
+                };
+                try {
+                    for (; _i < _n; ++_i) {
+                        if (is_dead(_i))
+                            continue;
+                        if (_pred(const_reference(_keys[_i], _values[_i])))
+                            ++_erased;
+                        else
+                            _keep();
+                    }
+                }
+                catch (...) {
+                    /// Keeps the rest, so the containers stay sorted and in step.
+                    for (; _i < _n; ++_i)
+                        if (!is_dead(_i))
+                            _keep();
+                    shrink_to(_w);
+                    throw;
+                }
+                shrink_to(_w);
+                return _erased;
+            };
+
+            /// @brief Removes erased elements (of a flat_map) for good, in a single pass. Happens by itself once their
+            ///     share passes max_tombstone_ratio(), and before anything is inserted at a new position.
+            void compact() {
+                if (_tombstones == 0)
+                    return;
+                std::size_t _w = 0;
+                for (std::size_t _i = 0, _n = _keys.size(); _i < _n; ++_i) {
+                    if (is_dead(_i))
+                        continue;
+                    if (_w != _i) {
+                        _keys[_w] = std::move(_keys[_i]);
+                        _values[_w] = std::move(_values[_i]);
+                    }
+                    ++_w;
+                }
+                shrink_to(_w);
+            };
+
+            /// @brief Get the share of erased elements that triggers a compaction.
+            float max_tombstone_ratio() const {
+                return _max_tombstones;
+            };
+
+            /// @brief Set the share of erased elements that triggers a compaction (0 compacts on every erase).
+            void max_tombstone_ratio(float _r) {
+                _max_tombstones = _r;
+            };
+
+            /// @brief Finding the (first) element of a key.
+            /// @param _k The key (or, with a transparent k_compare, anything it compares keys with).
+            /// @return The element, or end().
+            iterator find(const k& _k) {
+                auto _i = lower_index(_k);
+                return equal_at(_i, _k) ? at_index(_i) : end();
+            };
+            const_iterator find(const k& _k) const {
+                auto _i = lower_index(_k);
+                return equal_at(_i, _k) ? at_index(_i) : end();
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            iterator find(const q& _k) {
+                auto _i = lower_index(_k);
+                return equal_at(_i, _k) ? at_index(_i) : end();
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            const_iterator find(const q& _k) const {
+                auto _i = lower_index(_k);
+                return equal_at(_i, _k) ? at_index(_i) : end();
+            };
+
+            /// @brief Finding the first element whose key is not less than a key.
+            iterator lower_bound(const k& _k) {
+                return at_index(lower_index(_k));
+            };
+            const_iterator lower_bound(const k& _k) const {
+                return at_index(lower_index(_k));
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            iterator lower_bound(const q& _k) {
+                return at_index(lower_index(_k));
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            const_iterator lower_bound(const q& _k) const {
+                return at_index(lower_index(_k));
+            };
+
+            /// @brief Finding the first element whose key is greater than a key.
+            iterator upper_bound(const k& _k) {
+                return at_index(upper_index(_k));
+            };
+            const_iterator upper_bound(const k& _k) const {
+                return at_index(upper_index(_k));
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            iterator upper_bound(const q& _k) {
+                return at_index(upper_index(_k));
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            const_iterator upper_bound(const q& _k) const {
+                return at_index(upper_index(_k));
+            };
+
+            /// @brief Finding the elements of a key.
+            /// @param _k The key.
+            /// @return The first element of the key and the element after its last (both lower_bound() if there are none).
+            std::pair<iterator, iterator> equal_range(const k& _k) {
+                auto [_b, _e] = equal_indices(_k);
+                return { at_index(_b), at_index(_e) };
+            };
+            std::pair<const_iterator, const_iterator> equal_range(const k& _k) const {
+                auto [_b, _e] = equal_indices(_k);
+                return { at_index(_b), at_index(_e) };
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            std::pair<iterator, iterator> equal_range(const q& _k) {
+                auto [_b, _e] = equal_indices(_k);
+                return { at_index(_b), at_index(_e) };
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            std::pair<const_iterator, const_iterator> equal_range(const q& _k) const {
+                auto [_b, _e] = equal_indices(_k);
+                return { at_index(_b), at_index(_e) };
+            };
+
+            /// @brief Checking if the container contains a key.
+            /// @param _k The key.
+            /// @return If the container contains the key.
+            bool contains(const k& _k) const {
+                return equal_at(lower_index(_k), _k);
+            };
+            template <typename q> requires transparent_compare<k_compare>
+            bool contains(const q& _k) const {
+                return equal_at(lower_index(_k), _k);
+            };
+
+            /// @brief Get the size of the container.
+            /// @return The size of the container.
+            std::size_t size() const {
+                return _keys.size() - _tombstones;
+            };
+
+            /// @brief Checking if the container is empty.
+            bool empty() const {
+                return size() == 0;
+            };
+
+            /// @brief Get the sorted keys (erased ones included, until compact()).
+            const k_container& keys() const {
+                return _keys;
+            };
+
+            /// @brief Get the values, in the order of their keys (erased ones included, until compact()).
+            const v_container& values() const {
+                return _values;
+            };
+
+            /// @brief Get the key comparison.
+            k_compare key_comp() const {
+                return _cmp;
+            };
+
+
+            ///------------- @section Container functions. -------------///
+
+
+            /// @brief Get the begin iterator of the container.
+            /// @return The begin iterator.
+            iterator begin() {
+                return at_index(0);
+            };
+            const_iterator begin() const {
+                return at_index(0);
+            };
+
+            /// @brief Get the end iterator of the container.
+            /// @return The ending iterator.
+            iterator end() {
+                return at_index(_keys.size());
+            };
+            const_iterator end() const {
+                return at_index(_keys.size());
+            };
+
+            /// @brief Get the constant begin iterator of the container.
+            /// @return The begin iterator.
+            const_iterator cbegin() const {
+                return begin();
+            };
+
+            /// @brief Get the constant end iterator of the container.
+            /// @return The ending iterator.
+            const_iterator cend() const {
+                return end();
+            };
+        };
+    };
+
+    /// @brief Flat map container, the keys and values are kept in two containers sorted by key (like std::flat_map).
+    ///     Lookups are a binary search over contiguous keys, inserting and erasing shift the elements after the position.
+    ///     Bulk construction and insertion append and then sort everything in one pass.
     /// @tparam k Key typename.
     /// @tparam v Value typename.
-    /// @tparam k_map Key map typename.
-    /// @tparam v_container Value vector typename.
-    /// @tparam kv_it Key-value iterator.
-    /// @tparam kv_cit Key-value const iterator.
+    /// @tparam k_compare Key comparison typename.
+    /// @tparam k_container Key container typename.
+    /// @tparam v_container Value container typename.
     template <typename k, typename v,
-        typename k_map = std::map<k, std::size_t>,
-        typename v_container = std::vector<v>,
-        typename kv_it = v_container::iterator,
-        typename kv_cit = v_container::const_iterator>
-    class flat_map {
+        typename k_compare = std::less<k>,
+        typename k_container = std::vector<k>,
+        typename v_container = std::vector<v>>
+    class flat_map : public __detail::flat_storage<k, v, k_compare, k_container, v_container> {
     private:
 
-        /// Key-index map.
-        k_map _map;
-        /// Values container.
-        v_container _vec;
+        using base = __detail::flat_storage<k, v, k_compare, k_container, v_container>;
 
     public:
 
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
         flat_map() = default;
 
+        /// @brief Explicit Constructor
+        /// @param _c The key comparison.
+        explicit flat_map(const k_compare& _c) : base(_c) { };
+
+        /// @brief Constructor, adopts a key and a value container and sorts them (the last value of equal keys is kept).
+        /// @param _k The keys.
+        /// @param _v The values, in the order of the keys.
+        /// @param _c The key comparison.
+        flat_map(k_container _k, v_container _v, const k_compare& _c = k_compare()) : base(std::move(_k), std::move(_v), _c) {
+            this->merge_appended(0, true, false);
+        };
+
+        /// @brief Constructor, adopts a key and a value container that are already sorted and unique (no comparisons).
+        flat_map(sorted_unique_t, k_container _k, v_container _v, const k_compare& _c = k_compare()) : base(std::move(_k), std::move(_v), _c) { };
+
+        /// @brief Constructor, from a range of key-value pairs (the last value of equal keys is kept).
+        /// @param _first The first pair.
+        /// @param _last One past the last pair.
+        /// @param _c The key comparison.
+        template <std::input_iterator it_t>
+        flat_map(it_t _first, it_t _last, const k_compare& _c = k_compare()) : base(_c) {
+            insert(_first, _last);
+        };
+
+        /// @brief Constructor, from a range of key-value pairs that is already sorted and unique (no comparisons).
+        template <std::input_iterator it_t>
+        flat_map(sorted_unique_t, it_t _first, it_t _last, const k_compare& _c = k_compare()) : base(_c) {
+            this->append(_first, _last);
+        };
+
+        /// @brief Constructor, from a list of key-value pairs (the last value of equal keys is kept).
+        flat_map(std::initializer_list<value_type> _l, const k_compare& _c = k_compare()) : flat_map(_l.begin(), _l.end(), _c) { };
+
+        /// @brief Constructor, the containers allocate with an allocator (a std::pmr::polymorphic_allocator for the pmr aliases).
+        /// @param _a The allocator.
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        explicit flat_map(const alloc_t& _a) : base(k_compare(), _a) { };
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_map(const k_compare& _c, const alloc_t& _a) : base(_c, _a) { };
+
+        /// @brief Constructor, from a range of key-value pairs (the last value of equal keys is kept), into containers of an allocator.
+        template <std::input_iterator it_t, __detail::container_allocator<k_container, v_container> alloc_t>
+        flat_map(it_t _first, it_t _last, const alloc_t& _a) : flat_map(_first, _last, k_compare(), _a) { };
+        template <std::input_iterator it_t, __detail::container_allocator<k_container, v_container> alloc_t>
+        flat_map(it_t _first, it_t _last, const k_compare& _c, const alloc_t& _a) : base(_c, _a) {
+            insert(_first, _last);
+        };
+
+        /// @brief Constructor, from a list of key-value pairs (the last value of equal keys is kept), into containers of an allocator.
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_map(std::initializer_list<value_type> _l, const alloc_t& _a) : flat_map(_l.begin(), _l.end(), k_compare(), _a) { };
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_map(std::initializer_list<value_type> _l, const k_compare& _c, const alloc_t& _a) : flat_map(_l.begin(), _l.end(), _c, _a) { };
+
+        /// @brief Copy and Move Constructors, into containers of an allocator.
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_map(const flat_map& _o, const alloc_t& _a) : base(_o, _a) { };
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_map(flat_map&& _o, const alloc_t& _a) : base(std::move(_o), _a) { };
+
 
         ///------------- @section Member functions. -------------///
 
 
-        /// @brief Inserting a key and value pair into the map.
+        /// @brief Inserting a key and value pair into the map, the value is replaced if the key exists.
         /// @param _k Key
         /// @param _v Value
-        void insert(const k& _k, const v& _v) {
-            auto it = _map.find(_k); 
-
-            if (it == _map.end()) {
-                _map.emplace(_k, _vec.size());
-                _vec.emplace_back(_v);
+        /// @return The element, and whether the key was inserted.
+        std::pair<iterator, bool> insert(const k& _k, const v& _v) {
+            auto _i = this->lower_index(_k);
+            if (this->key_at(_i, _k)) {
+                bool _erased = this->is_dead(_i);
+                this->_values[_i] = _v;
+                if (_erased)
+                    this->revive(_i);
+                return { this->at_index(_i), _erased };
             }
-            else
-                _vec[it->second] = _v;
+            return { this->place(_i, _k, _v), true };
         };
 
-        /// @brief Checking if the container contains a key.
-        /// @param _k The key.
-        /// @return If the flat map contains the key.
-        bool contains(const k& _k) const {
-            return _map.count(_k) > 0;
+        /// @brief Inserting a range of key-value pairs, like inserting them one by one (later values replace earlier ones)
+        ///     but in O(n + m log m) for m new pairs: they are appended, sorted and merged in one pass.
+        /// @param _first The first pair.
+        /// @param _last One past the last pair.
+        template <std::input_iterator it_t>
+        void insert(it_t _first, it_t _last) {
+            auto _old = this->size();
+            this->append(_first, _last);
+            this->merge_appended(_old, true, false);
         };
 
-        /// @brief Get the size of the flat map container.
-        /// @return The size of the flat map container.
-        std::size_t size() const {
-            return _vec.size();
+        /// @brief Inserting a range of key-value pairs that is already sorted and unique, only the merge is done.
+        template <std::input_iterator it_t>
+        void insert(sorted_unique_t, it_t _first, it_t _last) {
+            auto _old = this->size();
+            this->append(_first, _last);
+            this->merge_appended(_old, true, true);
         };
 
+        /// @brief Inserting a key and a value constructed in place, unless the key exists.
+        /// @param _k Key
+        /// @param _args Value constructor arguments.
+        /// @return The element, and whether the key was inserted.
+        template <typename ... args_t>
+        std::pair<iterator, bool> try_emplace(const k& _k, args_t&&... _args) {
+            auto _i = this->lower_index(_k);
+            if (this->key_at(_i, _k)) {
+                if (!this->is_dead(_i))
+                    return { this->at_index(_i), false };
+                this->_values[_i] = v(std::forward<args_t>(_args)...);
+                this->revive(_i);
+                return { this->at_index(_i), true };
+            }
+            return { this->place(_i, _k, std::forward<args_t>(_args)...), true };
+        };
 
-        ///------------- @section Container functions. -------------///
+        /// @brief Inserting a key and a value constructed in place, unless the key exists, with a transparent k_compare
+        ///     the key is only constructed (from _k) when it is inserted.
+        template <typename q, typename ... args_t>
+            requires __detail::transparent_compare<k_compare> && std::is_constructible_v<k, q&&> &&
+                (!std::is_convertible_v<q&&, const_iterator>) && (!std::is_convertible_v<q&&, iterator>)
+        std::pair<iterator, bool> try_emplace(q&& _k, args_t&&... _args) {
+            auto _i = this->lower_index(_k);
+            if (this->key_at(_i, _k)) {
+                if (!this->is_dead(_i))
+                    return { this->at_index(_i), false };
+                this->_values[_i] = v(std::forward<args_t>(_args)...);
+                this->revive(_i);
+                return { this->at_index(_i), true };
+            }
+            return { this->place(_i, k(std::forward<q>(_k)), std::forward<args_t>(_args)...), true };
+        };
 
+        /// @brief Erasing the element of a key, it is only marked as erased (see compact()).
+        /// @param _k The key.
+        /// @return The amount of erased elements (0 or 1).
+        std::size_t erase(const k& _k) {
+            auto _i = this->lower_index(_k);
+            if (!this->equal_at(_i, _k))
+                return 0;
+            this->mark_dead(_i);
+            return 1;
+        };
+
+        /// @brief Erasing the element at an iterator, it is only marked as erased (see compact()).
+        /// @param _it The iterator.
+        /// @return The iterator after the erased element.
+        iterator erase(const_iterator _it) {
+            auto _i = static_cast<std::size_t>(_it.key_iterator() - this->_keys.cbegin());
+            auto _live = _i - this->dead_before(_i);
+            return this->mark_dead(_i) ? this->at_index(_live) : this->at_index(_i + 1);
+        };
 
-        /// @brief Get the begin iterator of the flat map container.
-        /// @return The begin iterator.
-        kv_it begin() const {
-            return _vec.begin();
+        /// @brief Erasing the elements in a range (for good, erased elements are compacted away at the same time).
+        /// @param _first The first element.
+        /// @param _last One past the last element.
+        /// @return The iterator after the erased elements.
+        iterator erase(const_iterator _first, const_iterator _last) {
+            auto _b = static_cast<std::size_t>(_first.key_iterator() - this->_keys.cbegin());
+            auto _e = static_cast<std::size_t>(_last.key_iterator() - this->_keys.cbegin());
+            if (_b == _e)
+                return this->at_index(_b);
+
+            /// Ranges go at once: compacting and moving the elements after the range down are two linear passes.
+            _b -= this->dead_before(_b);
+            _e -= this->dead_before(_e);
+            this->compact();
+            this->_keys.erase(this->_keys.begin() + _b, this->_keys.begin() + _e);
+            this->_values.erase(this->_values.begin() + _b, this->_values.begin() + _e);
+            return this->at_index(_b);
         };
 
-        /// @brief Get the end iterator of the flat map container.
-        /// @return The ending iterator.
-        kv_it end() const {
-            return _vec.end();
+        /// @brief Counting the elements of a key.
+        /// @param _k The key.
+        /// @return The amount of elements (0 or 1).
+        std::size_t count(const k& _k) const {
+            return this->contains(_k) ? 1 : 0;
         };
-        
-        /// @brief Get the begin iterator of the flat map container.
-        /// @return The begin iterator.
-        kv_cit cbegin() const {
-            return _vec.cbegin();
+        template <typename q> requires __detail::transparent_compare<k_compare>
+        std::size_t count(const q& _k) const {
+            return this->contains(_k) ? 1 : 0;
         };
 
-        /// @brief Get the end iterator of the flat map container.
-        /// @return The ending iterator.
-        kv_cit cend() const {
-            return _vec.cend();
+        /// @brief Get the value of a key.
+        /// @param _k The key.
+        /// @return The value, throws std::out_of_range if the key does not exist.
+        v& at(const k& _k) {
+            auto _i = this->lower_index(_k);
+            if (!this->equal_at(_i, _k))
+                throw std::out_of_range("flat_map::at: key not found");
+            return this->_values[_i];
+        };
+        const v& at(const k& _k) const {
+            auto _i = this->lower_index(_k);
+            if (!this->equal_at(_i, _k))
+                throw std::out_of_range("flat_map::at: key not found");
+            return this->_values[_i];
+        };
+        template <typename q> requires __detail::transparent_compare<k_compare>
+        v& at(const q& _k) {
+            auto _i = this->lower_index(_k);
+            if (!this->equal_at(_i, _k))
+                throw std::out_of_range("flat_map::at: key not found");
+            return this->_values[_i];
+        };
+        template <typename q> requires __detail::transparent_compare<k_compare>
+        const v& at(const q& _k) const {
+            auto _i = this->lower_index(_k);
+            if (!this->equal_at(_i, _k))
+                throw std::out_of_range("flat_map::at: key not found");
+            return this->_values[_i];
         };
 
 
         ///------------- @section Operator functions. -------------///
 
-    
+
+        /// @brief Get the value of a key, a default constructed value is inserted if the key does not exist.
+        v& operator[](const k& _k) {
+            return *try_emplace(_k).first.value_iterator();
+        };
+
+        /// @brief Get the value of a key, throws std::out_of_range if the key does not exist.
         const v& operator[](const k& _k) const {
-            return _vec[_map.at(_k)];
+            return at(_k);
         };
-        v& operator[](const k& _k) const {
-            return _vec[_map.at(_k)];
+
+        /// @brief Get the value of anything a transparent k_compare compares keys with, a key is only constructed (from _k)
+        ///     if it does not exist.
+        template <typename q> requires __detail::transparent_compare<k_compare> && std::is_constructible_v<k, q&&>
+        v& operator[](q&& _k) {
+            return *try_emplace(std::forward<q>(_k)).first.value_iterator();
+        };
+        template <typename q> requires __detail::transparent_compare<k_compare>
+        const v& operator[](const q& _k) const {
+            return at(_k);
         };
     };
 
-    /// @brief Flat multi map container.
+    /// @brief Flat multi map container, like flat_map but a key can have any amount of values.
+    ///     Equal keys are next to each other, in the order they were inserted.
     /// @tparam k Key typename.
     /// @tparam v Value typename.
-    /// @tparam k_map Key map typename.
-    /// @tparam v_container Value vector typename.
-    /// @tparam kv_it Key-value iterator.
-    /// @tparam kv_cit Key-value const iterator.
+    /// @tparam k_compare Key comparison typename.
+    /// @tparam k_container Key container typename.
+    /// @tparam v_container Value container typename.
     template <typename k, typename v,
-        typename k_map = std::map<k, std::vector<std::size_t>>,
-        typename v_container = std::vector<v>,
-        typename kv_it = v_container::iterator,
-        typename kv_cit = v_container::const_iterator>
-    class flat_multi_map {
+        typename k_compare = std::less<k>,
+        typename k_container = std::vector<k>,
+        typename v_container = std::vector<v>>
+    class flat_multi_map : public __detail::flat_storage<k, v, k_compare, k_container, v_container> {
     private:
 
-        /// Key-index map.
-        k_map _map;
-        /// Values container.
-        v_container _vec;
+        using base = __detail::flat_storage<k, v, k_compare, k_container, v_container>;
+
+        /// @brief A view over a run of values.
+        template <typename it_t>
+        using view_t = std::conditional_t<std::contiguous_iterator<it_t>,
+            std::span<std::remove_reference_t<std::iter_reference_t<it_t>>>, std::ranges::subrange<it_t>>;
 
     public:
 
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+        using values_view = view_t<typename v_container::iterator>;
+        using const_values_view = view_t<typename v_container::const_iterator>;
+
         flat_multi_map() = default;
 
+        /// @brief Explicit Constructor
+        /// @param _c The key comparison.
+        explicit flat_multi_map(const k_compare& _c) : base(_c) { };
 
-        ///------------- @section Member functions. -------------///
+        /// @brief Constructor, adopts a key and a value container and sorts them (equal keys keep their order).
+        /// @param _k The keys.
+        /// @param _v The values, in the order of the keys.
+        /// @param _c The key comparison.
+        flat_multi_map(k_container _k, v_container _v, const k_compare& _c = k_compare()) : base(std::move(_k), std::move(_v), _c) {
+            this->merge_appended(0, false, false);
+        };
 
+        /// @brief Constructor, adopts a key and a value container that are already sorted (no comparisons).
+        flat_multi_map(sorted_equivalent_t, k_container _k, v_container _v, const k_compare& _c = k_compare())
+            : base(std::move(_k), std::move(_v), _c) { };
 
-        /// @brief Inserting a key and value pair into the multi map.
-        /// @param _k Key
-        /// @param _v Value
-        void insert(const k& _k, const v& _v) {
-            _map[_k].emplace_back(_vec.size());
-            _vec.emplace_back(_v);
+        /// @brief Constructor, from a range of key-value pairs (equal keys keep their order).
+        /// @param _first The first pair.
+        /// @param _last One past the last pair.
+        /// @param _c The key comparison.
+        template <std::input_iterator it_t>
+        flat_multi_map(it_t _first, it_t _last, const k_compare& _c = k_compare()) : base(_c) {
+            insert(_first, _last);
+        };
+
+        /// @brief Constructor, from a range of key-value pairs that is already sorted (no comparisons).
+        template <std::input_iterator it_t>
+        flat_multi_map(sorted_equivalent_t, it_t _first, it_t _last, const k_compare& _c = k_compare()) : base(_c) {
+            this->append(_first, _last);
         };
 
-        /// @brief Get the count of the flat map container.
-        /// @return The count of the flat map container.
-        std::size_t count() const {
-            auto it = _map.find(key);
-            return it == _map.end() ? 0 : it->second.size();
+        /// @brief Constructor, from a list of key-value pairs (equal keys keep their order).
+        flat_multi_map(std::initializer_list<value_type> _l, const k_compare& _c = k_compare()) : flat_multi_map(_l.begin(), _l.end(), _c) { };
+
+        /// @brief Constructor, the containers allocate with an allocator (a std::pmr::polymorphic_allocator for the pmr aliases).
+        /// @param _a The allocator.
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        explicit flat_multi_map(const alloc_t& _a) : base(k_compare(), _a) { };
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_multi_map(const k_compare& _c, const alloc_t& _a) : base(_c, _a) { };
+
+        /// @brief Constructor, from a range of key-value pairs (equal keys keep their order), into containers of an allocator.
+        template <std::input_iterator it_t, __detail::container_allocator<k_container, v_container> alloc_t>
+        flat_multi_map(it_t _first, it_t _last, const alloc_t& _a) : flat_multi_map(_first, _last, k_compare(), _a) { };
+        template <std::input_iterator it_t, __detail::container_allocator<k_container, v_container> alloc_t>
+        flat_multi_map(it_t _first, it_t _last, const k_compare& _c, const alloc_t& _a) : base(_c, _a) {
+            insert(_first, _last);
         };
 
+        /// @brief Constructor, from a list of key-value pairs (equal keys keep their order), into containers of an allocator.
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_multi_map(std::initializer_list<value_type> _l, const alloc_t& _a) : flat_multi_map(_l.begin(), _l.end(), k_compare(), _a) { };
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_multi_map(std::initializer_list<value_type> _l, const k_compare& _c, const alloc_t& _a) : flat_multi_map(_l.begin(), _l.end(), _c, _a) { };
 
-        ///------------- @section Container functions. -------------///
+        /// @brief Copy and Move Constructors, into containers of an allocator.
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_multi_map(const flat_multi_map& _o, const alloc_t& _a) : base(_o, _a) { };
+        template <__detail::container_allocator<k_container, v_container> alloc_t>
+        flat_multi_map(flat_multi_map&& _o, const alloc_t& _a) : base(std::move(_o), _a) { };
 
 
-        /// @brief Get the begin iterator of the flat multi map container.
-        /// @return The begin iterator.
-        kv_it begin() const {
-            return _vec.begin();
+        ///------------- @section Member functions. -------------///
+
+
+        /// @brief Inserting a key and value pair into the multi map, after the values the key already has.
+        /// @param _k Key
+        /// @param _v Value
+        /// @return The inserted element.
+        iterator insert(const k& _k, const v& _v) {
+            return this->insert_at(this->upper_index(_k), _k, _v);
         };
 
-        /// @brief Get the end iterator of the flat multi map container.
-        /// @return The ending iterator.
-        kv_it end() const {
-            return _vec.end();
+        /// @brief Inserting a range of key-value pairs, like inserting them one by one but in O(n + m log m) for m new
+        ///     pairs: they are appended, sorted and merged in one pass.
+        /// @param _first The first pair.
+        /// @param _last One past the last pair.
+        template <std::input_iterator it_t>
+        void insert(it_t _first, it_t _last) {
+            auto _old = this->size();
+            this->append(_first, _last);
+            this->merge_appended(_old, false, false);
         };
-        
-        /// @brief Get the constant begin iterator of the flat multi map container.
-        /// @return The begin iterator.
-        kv_cit cbegin() const {
-            return _vec.cbegin();
+
+        /// @brief Inserting a range of key-value pairs that is already sorted, only the merge is done.
+        template <std::input_iterator it_t>
+        void insert(sorted_equivalent_t, it_t _first, it_t _last) {
+            auto _old = this->size();
+            this->append(_first, _last);
+            this->merge_appended(_old, false, true);
         };
 
-        /// @brief Get the constant end iterator of the flat multi map container.
-        /// @return The ending iterator.
-        kv_cit cend() const {
-            return _vec.cend();
+        using base::erase;
+
+        /// @brief Erasing the elements of a key.
+        /// @param _k The key.
+        /// @return The amount of erased elements.
+        std::size_t erase(const k& _k) {
+            auto [_b, _e] = this->equal_indices(_k);
+            this->_keys.erase(this->_keys.begin() + _b, this->_keys.begin() + _e);
+            this->_values.erase(this->_values.begin() + _b, this->_values.begin() + _e);
+            return _e - _b;
         };
 
+        /// @brief Get the count of a key in the flat multi map container.
+        /// @param _k The key.
+        /// @return The count of the key.
+        std::size_t count(const k& _k) const {
+            auto [_b, _e] = this->equal_indices(_k);
+            return _e - _b;
+        };
+        template <typename q> requires __detail::transparent_compare<k_compare>
+        std::size_t count(const q& _k) const {
+            auto [_b, _e] = this->equal_indices(_k);
+            return _e - _b;
+        };
 
-        ///------------- @section Operator functions. -------------///
 
+        ///------------- @section Operator functions. -------------///
 
-        std::vector<v> operator[](const k& _k) const {
-            std::vector<v> _r;
-            
-            if (auto it = _map.find(_k); it != _map.end()) {
-                for (std::size_t idx : it->second)
-                    _r.emplace_back(_vec[idx]);
-            }
 
-            return _r;
+        /// @brief Get the values of a key, a view into the value container (nothing is copied), in the order they were
+        ///     inserted. It is invalidated by anything that modifies the multi map.
+        /// @param _k The key.
+        /// @return The values (a std::span over a contiguous value container).
+        values_view operator[](const k& _k) {
+            auto [_b, _e] = this->equal_indices(_k);
+            return values_view(this->_values.begin() + _b, this->_values.begin() + _e);
+        };
+        const_values_view operator[](const k& _k) const {
+            auto [_b, _e] = this->equal_indices(_k);
+            return const_values_view(this->_values.begin() + _b, this->_values.begin() + _e);
+        };
+        template <typename q> requires __detail::transparent_compare<k_compare>
+        values_view operator[](const q& _k) {
+            auto [_b, _e] = this->equal_indices(_k);
+            return values_view(this->_values.begin() + _b, this->_values.begin() + _e);
+        };
+        template <typename q> requires __detail::transparent_compare<k_compare>
+        const_values_view operator[](const q& _k) const {
+            auto [_b, _e] = this->equal_indices(_k);
+            return const_values_view(this->_values.begin() + _b, this->_values.begin() + _e);
         };
     };
-};
\ No newline at end of file
+
+    /// @brief The flat maps over std::pmr::vector, so the elements (and the scratch space of bulk inserts and erases)
+    ///     are carved from a std::pmr::memory_resource such as a per-request arena, and released along with it.
+    namespace pmr {
+        template <typename k, typename v, typename k_compare = std::less<k>>
+        using flat_map = v23::flat_map<k, v, k_compare, std::pmr::vector<k>, std::pmr::vector<v>>;
+
+        template <typename k, typename v, typename k_compare = std::less<k>>
+        using flat_multi_map = v23::flat_multi_map<k, v, k_compare, std::pmr::vector<k>, std::pmr::vector<v>>;
+    };
+};
+
+/// @brief The flat maps take an allocator when both of their containers do, so containers of flat maps
+///     (a std::pmr::vector of pmr::flat_map, say) pass theirs on.
+template <typename k, typename v, typename k_compare, typename k_container, typename v_container, typename alloc_t>
+struct std::uses_allocator<__gnu_cxx::v23::flat_map<k, v, k_compare, k_container, v_container>, alloc_t>
+    : std::bool_constant<__gnu_cxx::v23::__detail::container_allocator<alloc_t, k_container, v_container>> { };
+template <typename k, typename v, typename k_compare, typename k_container, typename v_container, typename alloc_t>
+struct std::uses_allocator<__gnu_cxx::v23::flat_multi_map<k, v, k_compare, k_container, v_container>, alloc_t>
+    : std::bool_constant<__gnu_cxx::v23::__detail::container_allocator<alloc_t, k_container, v_container>> { };
@@ -8,33 +8,3211 @@
  **/
 #pragma once
 
-/// @uses: std::snprintf(), std::string
+/// @uses: std::string, std::wstring, std::char_traits
 #include <string>
 
-/// @uses: std::shared_ptr, std::unique_ptr
+/// @uses: std::basic_string_view
+#include <string_view>
+
+/// @uses: std::shared_ptr, std::allocator_arg_t
 #include <memory>
 
-/// @uses: std::optional, std::nullopt
-#include <optional>
+/// @uses: std::pmr::memory_resource, std::pmr::polymorphic_allocator, std::pmr::string
+#include <memory_resource>
+
+/// @uses: std::optional, std::nullopt
+#include <optional>
+
+/// @uses: std::runtime_error
+#include <stdexcept>
+
+/// @uses: std::to_chars, std::chars_format
+#include <charconv>
+
+/// @uses: std::convertible_to
+#include <concepts>
+
+/// @uses: std::remove_cvref_t, std::type_identity_t, std::make_unsigned_t
+#include <type_traits>
+
+/// @uses: std::monostate, std::variant
+#include <variant>
+
+/// @uses: std::vector
+#include <vector>
+
+/// @uses: std::forward_as_tuple
+#include <tuple>
+
+/// @uses: std::index_sequence
+#include <utility>
+
+/// @uses: std::signbit, std::isnan, std::isinf
+#include <cmath>
+
+/// @uses: std::uintptr_t
+#include <cstdint>
+
+/// @uses: std::numeric_limits
+#include <limits>
+
+/// @uses: std::output_iterator_tag
+#include <iterator>
+
+/// @uses: std::max, std::min
+#include <algorithm>
+
+/// @uses: std::ranges::range, std::ranges::range_reference_t
+#include <ranges>
+
+/// @uses: count_digits, format_decimal, format_base2e, to_decimal_shortest, exact_digits
+#include "charconv.h"
+
+/// @uses: count, count_flushed, format_mark, count_format, count_string
+#include "instrument.h"
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+    /// @brief A format error.
+    class format_error : public std::runtime_error 
+    {
+    public:
+
+        /// @brief Explicit Constructor
+        /// @param what What the error is.
+        explicit format_error(const std::string& what) : std::runtime_error(what) { };
+
+        /// @brief Explicit Constructor
+        /// @param what What the error is.
+        explicit format_error(const char* what) : std::runtime_error(what) { };
+    };
+
+    template<typename char_t> class basic_format_parse_context;
+    template<typename char_t> class basic_format_context;
+    template<typename char_t> class basic_format_arg;
+    template<typename char_t> class basic_format_args;
+
+    /// @brief Formatter for a type, specialize this to make your own types formattable.
+    ///     The primary template is disabled, which is what makes an unsupported argument a compile-time error.
+    /// @tparam T The type being formatted.
+    /// @tparam char_t The character type of the output.
+    template<typename T, typename char_t = char>
+    struct formatter
+    {
+        formatter() = delete;
+        formatter(const formatter&) = delete;
+        formatter& operator=(const formatter&) = delete;
+    };
+
+
+
+    ///-------------------------------------------------- @section Format buffers ------------------------------------------------------------///
+
+
+
+    namespace __detail {
+        /// @brief Throws a format error.
+        ///     This is deliberately not constexpr, reaching it while checking a format string at compile time
+        ///     is what turns a malformed format string into a compile error (with __what in the diagnostic).
+        /// @param __what What the error is.
+        [[noreturn]] inline void
+        throw_format_error(const char* __what)
+        {
+            throw format_error(__what);
+        };
+
+        /// @brief A contiguous output buffer every formatting call writes into.
+        ///     Derived buffers decide what happens when it fills up (reallocate, flush to an iterator, etc.),
+        ///     the formatting code itself only ever sees this type.
+        /// @tparam char_t The character type.
+        template<typename char_t>
+        class format_buffer
+        {
+        protected:
+
+            /// Pointer to the storage.
+            char_t* _ptr;
+            /// Amount of characters written.
+            std::size_t _size;
+            /// Amount of characters that fit in the storage.
+            std::size_t _capacity;
+
+            /// @brief Constructor
+            /// @param __p The storage.
+            /// @param __sz The amount of characters already written.
+            /// @param __cap The capacity of the storage.
+            constexpr format_buffer(char_t* __p = nullptr, std::size_t __sz = 0, std::size_t __cap = 0) noexcept
+                : _ptr(__p), _size(__sz), _capacity(__cap) { };
+            ~format_buffer() = default;
+
+            format_buffer(const format_buffer&) = delete;
+            format_buffer& operator=(const format_buffer&) = delete;
+
+            /// @brief Makes room for at least __n characters, or flushes the buffer so that there is room for at least one.
+            /// @param __n The requested capacity.
+            virtual void grow(std::size_t __n) = 0;
+
+            /// @brief Sets the storage.
+            /// @param __p The storage.
+            /// @param __cap The capacity of the storage.
+            void set(char_t* __p, std::size_t __cap) noexcept
+            {
+                _ptr = __p;
+                _capacity = __cap;
+            };
+
+        public:
+
+            using value_type = char_t;
+
+            /// @brief Get the amount of characters in the buffer.
+            /// @return The amount of characters in the buffer.
+            std::size_t size() const noexcept { return _size; };
+
+            /// @brief Get the capacity of the buffer.
+            /// @return The capacity of the buffer.
+            std::size_t capacity() const noexcept { return _capacity; };
+
+            /// @brief Get the data of the buffer.
+            /// @return The pointer to the first character.
+            char_t* data() noexcept { return _ptr; };
+            const char_t* data() const noexcept { return _ptr; };
+
+            /// @brief Clears the buffer (keeping the storage).
+            void clear() noexcept { _size = 0; };
+
+            /// @brief Tries to reserve room for __n characters.
+            /// @param __n The amount of characters.
+            void try_reserve(std::size_t __n)
+            {
+                if (__n > _capacity)
+                    grow(__n);
+            };
+
+            /// @brief Tries to resize the buffer to __n characters.
+            /// @param __n The amount of characters.
+            void try_resize(std::size_t __n)
+            {
+                try_reserve(__n);
+                _size = __n <= _capacity ? __n : _capacity;
+            };
+
+            /// @brief Appends a character.
+            /// @param __c The character.
+            void push_back(char_t __c)
+            {
+                if (_size == _capacity)
+                    grow(_size + 1);
+                _ptr[_size++] = __c;
+            };
+
+            /// @brief Appends a range of characters.
+            /// @param __b The first character.
+            /// @param __e One past the last character.
+            void append(const char_t* __b, const char_t* __e)
+            {
+                while (__b != __e)
+                {
+                    auto __count = static_cast<std::size_t>(__e - __b);
+                    try_reserve(_size + __count);
+
+                    /// Bounded buffers may only be able to take part of it before flushing again.
+                    if (auto __free = _capacity - _size; __free < __count)
+                        __count = __free;
+                    std::char_traits<char_t>::copy(_ptr + _size, __b, __count);
+                    _size += __count;
+                    __b += __count;
+                }
+            };
+
+            /// @brief Appends __n copies of a character.
+            /// @param __n The amount of characters.
+            /// @param __c The character.
+            void fill(std::size_t __n, char_t __c)
+            {
+                while (__n != 0)
+                {
+                    auto __count = __n;
+                    try_reserve(_size + __count);
+
+                    if (auto __free = _capacity - _size; __free < __count)
+                        __count = __free;
+                    std::char_traits<char_t>::assign(_ptr + _size, __count, __c);
+                    _size += __count;
+                    __n -= __count;
+                }
+            };
+
+            char_t& operator[](std::size_t __i) noexcept { return _ptr[__i]; };
+            const char_t& operator[](std::size_t __i) const noexcept { return _ptr[__i]; };
+        };
+
+        /// @brief Output iterator that appends into a format buffer.
+        /// @tparam char_t The character type.
+        template<typename char_t>
+        class buffer_appender
+        {
+        private:
+
+            /// The buffer being appended to.
+            format_buffer<char_t>* _buf;
+
+        public:
+
+            using iterator_category = std::output_iterator_tag;
+            using value_type = void;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = void;
+
+            buffer_appender() = default;
+            explicit buffer_appender(format_buffer<char_t>& __buf) noexcept : _buf(&__buf) { };
+
+            buffer_appender& operator=(char_t __c) { _buf->push_back(__c); return *this; };
+            buffer_appender& operator*() noexcept { return *this; };
+            buffer_appender& operator++() noexcept { return *this; };
+            buffer_appender operator++(int) noexcept { return *this; };
+
+            /// @brief Get the buffer this iterator appends to.
+            /// @return The buffer.
+            format_buffer<char_t>& buffer() const noexcept { return *_buf; };
+        };
+
+        /// @brief Format buffer writing straight into a contiguous container (std::basic_string, std::vector),
+        ///     appending to what is already there and reusing its capacity.
+        /// @tparam container_t The container type.
+        template<typename container_t>
+        class container_buffer final : public format_buffer<typename container_t::value_type>
+        {
+        private:
+
+            /// The container being written to.
+            container_t& _c;
+
+            void grow(std::size_t __n) override
+            {
+                auto __cap = std::max({ __n, this->_capacity + this->_capacity / 2, _c.capacity() });
+                count(counter_buffer_grows);
+                if (__cap > _c.capacity())
+                    count(counter_allocations);
+                _c.resize(__cap);
+                this->set(_c.data(), _c.size());
+            };
+
+        public:
+
+            /// @brief Explicit Constructor
+            /// @param __c The container to append to.
+            explicit container_buffer(container_t& __c)
+                : format_buffer<typename container_t::value_type>(__c.data(), __c.size(), __c.size()), _c(__c) { };
+
+            /// @brief Trims the container down to what was actually written.
+            ~container_buffer() { _c.resize(this->_size); };
+        };
+
+        /// @brief Checks if an output iterator is a std::back_insert_iterator into a contiguous container of char_t.
+        template<typename out_t, typename char_t>
+        struct is_contiguous_back_inserter : std::false_type { };
+        template<typename container_t, typename char_t>
+            requires std::is_same_v<typename container_t::value_type, char_t> && (!std::is_base_of_v<format_buffer<char_t>, container_t>) &&
+                requires (container_t& __c) { __c.data(); __c.resize(0); }
+        struct is_contiguous_back_inserter<std::back_insert_iterator<container_t>, char_t> : std::true_type { };
+
+        /// @brief Checks if an output iterator is a std::back_insert_iterator into a format buffer (basic_memory_buffer).
+        template<typename out_t, typename char_t>
+        struct is_buffer_back_inserter : std::false_type { };
+        template<typename container_t, typename char_t>
+            requires std::is_base_of_v<format_buffer<char_t>, container_t>
+        struct is_buffer_back_inserter<std::back_insert_iterator<container_t>, char_t> : std::true_type { };
+
+        /// @brief Gets the container behind a std::back_insert_iterator.
+        template<typename container_t>
+        container_t&
+        get_container(std::back_insert_iterator<container_t> __it) noexcept
+        {
+            struct accessor : std::back_insert_iterator<container_t>
+            {
+                explicit accessor(std::back_insert_iterator<container_t> __i) : std::back_insert_iterator<container_t>(__i) { };
+                container_t& get() const noexcept { return *this->container; };
+            };
+            return accessor(__it).get();
+        };
+
+        /// @brief Format buffer staging output in a small array and flushing it to an output iterator,
+        ///     optionally keeping only the first __limit characters (format_to_n).
+        /// @tparam out_t The output iterator type.
+        /// @tparam char_t The character type.
+        template<typename out_t, typename char_t>
+        class iterator_buffer final : public format_buffer<char_t>
+        {
+        private:
+
+            /// The output.
+            out_t _out;
+            /// The maximum amount of characters written to the output.
+            std::size_t _limit;
+            /// The amount of characters already flushed (or discarded past the limit).
+            std::size_t _count = 0;
+            /// The staging area.
+            char_t _data[256];
+
+            void grow(std::size_t) override { flush(); };
+
+            void flush()
+            {
+                auto __n = this->_size;
+                if (auto __left = _count < _limit ? _limit - _count : 0; __n > __left)
+                    __n = __left;
+                if constexpr (is_contiguous_back_inserter<out_t, char_t>::value)
+                {
+                    auto& __c = get_container(_out);
+                    __c.insert(__c.end(), _data, _data + __n);
+                }
+                else
+                    _out = std::copy_n(_data, __n, _out);
+                count_flushed(this->_size);
+                _count += this->_size;
+                this->_size = 0;
+            };
+
+        public:
+
+            /// @brief Explicit Constructor
+            /// @param __out The output.
+            /// @param __limit The maximum amount of characters written to the output.
+            explicit iterator_buffer(out_t __out, std::size_t __limit = static_cast<std::size_t>(-1))
+                : format_buffer<char_t>(_data, 0, 256), _out(__out), _limit(__limit) { };
+
+            /// @brief Flushes what is left and gets the output iterator.
+            /// @return The output iterator past the last written character.
+            out_t out() { flush(); return _out; };
+
+            /// @brief Get the total amount of characters formatted (including the ones past the limit).
+            std::size_t count() const noexcept { return _count + this->_size; };
+        };
+
+        /// @brief Format buffer writing straight into a character array, optionally keeping only the first
+        ///     __limit characters, after that the output is formatted into a scratch area and only counted.
+        /// @tparam char_t The character type.
+        template<typename char_t>
+        class iterator_buffer<char_t*, char_t> final : public format_buffer<char_t>
+        {
+        private:
+
+            /// The output.
+            char_t* _out;
+            /// The amount of characters written to the output before the limit was reached.
+            std::size_t _written = 0;
+            /// The amount of characters discarded past the limit.
+            std::size_t _discarded = 0;
+            /// The scratch area used past the limit.
+            char_t _scratch[128];
+
+            void grow(std::size_t) override
+            {
+                /// Fill the array up to the limit before switching to the scratch area.
+                if (this->_ptr != _scratch && this->_size < this->_capacity)
+                    return;
+                count_flushed(this->_size);
+                if (this->_ptr != _scratch)
+                    _written = this->_size;
+                else
+                    _discarded += this->_size;
+                this->set(_scratch, sizeof(_scratch) / sizeof(char_t));
+                this->_size = 0;
+            };
+
+        public:
+
+            /// @brief Explicit Constructor
+            /// @param __out The output.
+            /// @param __limit The maximum amount of characters written to the output.
+            explicit iterator_buffer(char_t* __out, std::size_t __limit = static_cast<std::size_t>(-1) / sizeof(char_t))
+                : format_buffer<char_t>(__out, 0, __limit), _out(__out) { };
+
+            /// @brief Gets the output iterator.
+            /// @return The pointer past the last written character.
+            char_t* out() const noexcept { return _out + (this->_ptr == _scratch ? _written : this->_size); };
+
+            /// @brief Get the total amount of characters formatted (including the ones past the limit).
+            std::size_t count() const noexcept
+            {
+                return this->_ptr == _scratch ? _written + _discarded + this->_size : this->_size;
+            };
+        };
+
+        /// @brief Format buffer that only counts characters (formatted_size).
+        /// @tparam char_t The character type.
+        template<typename char_t>
+        class counting_buffer final : public format_buffer<char_t>
+        {
+        private:
+
+            /// The amount of characters counted so far.
+            std::size_t _count = 0;
+            /// The scratch area.
+            char_t _data[128];
+
+            void grow(std::size_t) override
+            {
+                count_flushed(this->_size);
+                _count += this->_size;
+                this->_size = 0;
+            };
+
+        public:
+
+            counting_buffer() noexcept : format_buffer<char_t>(_data, 0, 128) { };
+
+            /// @brief Get the amount of characters formatted.
+            std::size_t count() const noexcept { return _count + this->_size; };
+        };
+    };
+
+
+
+    /// @brief A format buffer with N characters of inline storage, it only allocates once a message outgrows it.
+    ///     Formatting into one of these on the stack costs no allocations at all for the common short message.
+    /// @tparam char_t The character type.
+    /// @tparam N The amount of inline characters.
+    /// @tparam alloc_t The allocator used once the inline storage is exceeded.
+    template<typename char_t, std::size_t N = 500, typename alloc_t = std::allocator<char_t>>
+    class basic_memory_buffer final : public __detail::format_buffer<char_t>
+    {
+        static_assert(N > 0, "basic_memory_buffer needs inline storage");
+
+    private:
+
+        /// The allocator.
+        [[no_unique_address]] alloc_t _alloc;
+        /// The inline storage.
+        char_t _store[N];
+
+        void grow(std::size_t __n) override
+        {
+            auto __cap = this->_capacity + this->_capacity / 2;
+            if (__n > __cap)
+                __cap = __n;
+
+            char_t* __p = std::allocator_traits<alloc_t>::allocate(_alloc, __cap);
+            __detail::count(__detail::counter_buffer_grows);
+            __detail::count(__detail::counter_allocations);
+            std::char_traits<char_t>::copy(__p, this->_ptr, this->_size);
+            deallocate();
+            this->set(__p, __cap);
+        };
+
+        /// @brief Frees the heap storage (if any).
+        void deallocate() noexcept
+        {
+            if (this->_ptr != _store)
+                std::allocator_traits<alloc_t>::deallocate(_alloc, this->_ptr, this->_capacity);
+        };
+
+        /// @brief Takes over the contents of another buffer, leaving it empty.
+        void move_from(basic_memory_buffer& __o) noexcept
+        {
+            if (__o._ptr == __o._store)
+            {
+                std::char_traits<char_t>::copy(_store, __o._store, __o._size);
+                this->set(_store, N);
+            }
+            else
+            {
+                this->set(__o._ptr, __o._capacity);
+                __o.set(__o._store, N);
+            }
+            this->_size = __o._size;
+            __o._size = 0;
+        };
+
+    public:
+
+        /// @brief Explicit Constructor
+        /// @param __alloc The allocator.
+        explicit basic_memory_buffer(const alloc_t& __alloc = alloc_t()) noexcept
+            : __detail::format_buffer<char_t>(nullptr, 0, N), _alloc(__alloc) { this->set(_store, N); };
+
+        /// @brief Move Constructor
+        basic_memory_buffer(basic_memory_buffer&& __o) noexcept
+            : __detail::format_buffer<char_t>(nullptr, 0, N), _alloc(__o._alloc) { move_from(__o); };
+
+        /// @brief Move Assignment (the allocators have to compare equal).
+        basic_memory_buffer& operator=(basic_memory_buffer&& __o) noexcept
+        {
+            if (this != &__o)
+            {
+                deallocate();
+                move_from(__o);
+            }
+            return *this;
+        };
+
+        ~basic_memory_buffer() { deallocate(); };
+
+        /// @brief Resizes the buffer (new characters are uninitialized).
+        /// @param __n The amount of characters.
+        void resize(std::size_t __n) { this->try_resize(__n); };
+
+        /// @brief Reserves room for at least __n characters.
+        /// @param __n The amount of characters.
+        void reserve(std::size_t __n) { this->try_reserve(__n); };
+
+        /// @brief Get the allocator.
+        alloc_t get_allocator() const noexcept { return _alloc; };
+
+        /// @brief Get a view of the contents.
+        std::basic_string_view<char_t> view() const noexcept { return { this->_ptr, this->_size }; };
+
+        /// @brief Copies the contents into a string.
+        std::basic_string<char_t> str() const { return std::basic_string<char_t>(this->_ptr, this->_size); };
+    };
+    using memory_buffer = basic_memory_buffer<char>;
+    using wmemory_buffer = basic_memory_buffer<wchar_t>;
+
+
+
+    ///----------------------------------------------- @section Format specifications ---------------------------------------------------------///
+
+
+
+    namespace __detail {
+        /// @brief Alignment of a replacement field.
+        enum class align_t : unsigned char { none, left, right, center };
+
+        /// @brief Sign option of a replacement field.
+        enum class sign_t : unsigned char { none, minus, plus, space };
+
+        /// @brief What kind of argument a spec is parsed for, this decides which options are valid.
+        enum class spec_kind : unsigned char { integer, character, boolean, floating, string, pointer };
+
+        /// @brief Type-erased argument kinds.
+        enum class arg_type : unsigned char
+        {
+            none, int_type, uint_type, long_long_type, ulong_long_type, bool_type, char_type,
+            float_type, double_type, long_double_type, cstring_type, string_type, pointer_type, custom_type
+        };
+
+        /// @brief Checks if an argument kind is an integer (for dynamic width and precision).
+        constexpr bool
+        is_integral_arg(arg_type __t) noexcept
+        {
+            return __t >= arg_type::int_type && __t <= arg_type::ulong_long_type;
+        };
+
+        /// @brief A parsed std-format-spec: [[fill]align][sign][#][0][width][.precision][L][type].
+        /// @tparam char_t The character type.
+        template<typename char_t>
+        struct format_specs
+        {
+            /// The width, or the argument index of it when width_arg is set.
+            int width = 0;
+            /// The precision (-1 when none), or the argument index of it when precision_arg is set.
+            int precision = -1;
+            /// The fill character, up to one code point of code units.
+            char_t fill[4] = { char_t(' '), char_t(), char_t(), char_t() };
+            unsigned char fill_size = 1;
+            align_t align = align_t::none;
+            sign_t sign = sign_t::none;
+            bool alt = false;
+            bool zero = false;
+            bool localized = false;
+            /// Whether width and precision come from an argument ('{}' inside of the spec).
+            bool width_arg = false;
+            bool precision_arg = false;
+            /// The presentation type ('\0' when none).
+            char type = 0;
+        };
+
+        /// @brief Gets the length of the code point starting at a code unit.
+        template<typename char_t>
+        constexpr std::size_t
+        code_point_length(const char_t* __p) noexcept
+        {
+            if constexpr (sizeof(char_t) == 1)
+            {
+                auto __c = static_cast<unsigned char>(*__p);
+                return __c < 0xc0 ? 1 : __c < 0xe0 ? 2 : __c < 0xf0 ? 3 : 4;
+            }
+            else
+                return 1;
+        };
+
+        /// @brief Parses a non-negative integer in a format string.
+        /// @return The pointer past the last digit.
+        template<typename char_t>
+        constexpr const char_t*
+        parse_nonnegative_int(const char_t* __p, const char_t* __end, int& __value)
+        {
+            long long __v = 0;
+            for (; __p != __end && *__p >= '0' && *__p <= '9'; ++__p)
+            {
+                __v = __v * 10 + (*__p - '0');
+                if (__v > 0x7fffffff)
+                    throw_format_error("number is too big in format string");
+            }
+            __value = static_cast<int>(__v);
+            return __p;
+        };
+
+        /// @brief Parses a dynamic width/precision reference: '{' [arg-id] '}'.
+        /// @return The pointer past the closing brace.
+        template<typename char_t>
+        constexpr const char_t*
+        parse_dynamic_spec(const char_t* __p, const char_t* __end, int& __value, basic_format_parse_context<char_t>& __ctx)
+        {
+            /// __p points past the '{'.
+            if (__p != __end && *__p == '}')
+                __value = static_cast<int>(__ctx.next_arg_id());
+            else if (__p != __end && *__p >= '0' && *__p <= '9')
+            {
+                __p = parse_nonnegative_int(__p, __end, __value);
+                __ctx.check_arg_id(static_cast<std::size_t>(__value));
+            }
+            else
+                throw_format_error("invalid argument index in format spec");
+
+            if (__p == __end || *__p != '}')
+                throw_format_error("missing '}' in format spec");
+            __ctx.check_dynamic_spec_integral(static_cast<std::size_t>(__value));
+            return __p + 1;
+        };
+
+        /// @brief Parses the [[fill]align] of a spec.
+        /// @return The pointer past it.
+        template<typename char_t>
+        constexpr const char_t*
+        parse_fill_align(const char_t* __p, const char_t* __end, format_specs<char_t>& __specs)
+        {
+            auto __align_of = [](char_t __c)
+            {
+                return __c == '<' ? align_t::left : __c == '>' ? align_t::right : __c == '^' ? align_t::center : align_t::none;
+            };
+
+            if (__p == __end)
+                return __p;
+            if (auto __n = code_point_length(__p); __n < static_cast<std::size_t>(__end - __p) && __align_of(__p[__n]) != align_t::none)
+            {
+                if (*__p == '{' || *__p == '}')
+                    throw_format_error("invalid fill character in format spec");
+                for (std::size_t __i = 0; __i < __n; ++__i)
+                    __specs.fill[__i] = __p[__i];
+                __specs.fill_size = static_cast<unsigned char>(__n);
+                __specs.align = __align_of(__p[__n]);
+                __p += __n + 1;
+            }
+            else if (__align_of(*__p) != align_t::none)
+                __specs.align = __align_of(*__p++);
+            return __p;
+        };
+
+        /// @brief Parses the [width] of a spec (a number, or a dynamic '{' [arg-id] '}').
+        /// @return The pointer past it.
+        template<typename char_t>
+        constexpr const char_t*
+        parse_width(const char_t* __p, const char_t* __end, format_specs<char_t>& __specs, basic_format_parse_context<char_t>& __ctx)
+        {
+            if (__p != __end && *__p >= '0' && *__p <= '9')
+                __p = parse_nonnegative_int(__p, __end, __specs.width);
+            else if (__p != __end && *__p == '{')
+                __p = parse_dynamic_spec(__p + 1, __end, __specs.width, __ctx), __specs.width_arg = true;
+            return __p;
+        };
+
+        /// @brief Parses a std-format-spec and validates it for the argument kind.
+        /// @param __p The start of the spec (past the ':').
+        /// @param __end The end of the format string.
+        /// @param __specs The specs to parse into.
+        /// @param __ctx The parse context (for dynamic width and precision).
+        /// @param __kind The kind of argument the spec is for.
+        /// @return The pointer to the closing '}' of the replacement field.
+        template<typename char_t>
+        constexpr const char_t*
+        parse_format_specs(const char_t* __p, const char_t* __end, format_specs<char_t>& __specs,
+            basic_format_parse_context<char_t>& __ctx, spec_kind __kind)
+        {
+            if (__p == __end || *__p == '}')
+                return __p;
+
+            /// [[fill]align]
+            __p = parse_fill_align(__p, __end, __specs);
+
+            /// [sign]
+            if (__p != __end && (*__p == '+' || *__p == '-' || *__p == ' '))
+                __specs.sign = *__p == '+' ? sign_t::plus : *__p == '-' ? sign_t::minus : sign_t::space, ++__p;
+
+            /// [#][0]
+            if (__p != __end && *__p == '#')
+                __specs.alt = true, ++__p;
+            if (__p != __end && *__p == '0')
+                __specs.zero = true, ++__p;
+
+            /// [width]
+            __p = parse_width(__p, __end, __specs, __ctx);
+
+            /// [.precision]
+            if (__p != __end && *__p == '.')
+            {
+                if (++__p != __end && *__p >= '0' && *__p <= '9')
+                    __p = parse_nonnegative_int(__p, __end, __specs.precision);
+                else if (__p != __end && *__p == '{')
+                    __p = parse_dynamic_spec(__p + 1, __end, __specs.precision, __ctx), __specs.precision_arg = true;
+                else
+                    throw_format_error("missing precision in format spec");
+            }
+
+            /// [L], the engine is locale-free so this is accepted and ignored.
+            if (__p != __end && *__p == 'L')
+                __specs.localized = true, ++__p;
+
+            /// [type]
+            if (__p != __end && *__p != '}')
+            {
+                if (!((*__p >= 'a' && *__p <= 'z') || (*__p >= 'A' && *__p <= 'Z')))
+                    throw_format_error("invalid format spec");
+                __specs.type = static_cast<char>(*__p++);
+            }
+            if (__p != __end && *__p != '}')
+                throw_format_error("invalid format spec");
+
+            /// Validate what was parsed against the kind of argument.
+            auto __t = __specs.type;
+            bool __as_int = __t == 'b' || __t == 'B' || __t == 'd' || __t == 'o' || __t == 'x' || __t == 'X';
+            bool __textual = false;
+            switch (__kind)
+            {
+                case spec_kind::integer:
+                    if (!(__t == 0 || __as_int || __t == 'c'))
+                        throw_format_error("invalid type for an integer argument");
+                    __textual = __t == 'c';
+                    break;
+                case spec_kind::character:
+                    if (!(__t == 0 || __as_int || __t == 'c'))
+                        throw_format_error("invalid type for a character argument");
+                    __textual = !__as_int;
+                    break;
+                case spec_kind::boolean:
+                    if (!(__t == 0 || __as_int || __t == 's'))
+                        throw_format_error("invalid type for a bool argument");
+                    __textual = !__as_int;
+                    break;
+                case spec_kind::floating:
+                    if (!(__t == 0 || __t == 'a' || __t == 'A' || __t == 'e' || __t == 'E' ||
+                          __t == 'f' || __t == 'F' || __t == 'g' || __t == 'G'))
+                        throw_format_error("invalid type for a floating-point argument");
+                    break;
+                case spec_kind::string:
+                    if (!(__t == 0 || __t == 's'))
+                        throw_format_error("invalid type for a string argument");
+                    __textual = true;
+                    break;
+                case spec_kind::pointer:
+                    if (!(__t == 0 || __t == 'p' || __t == 'P'))
+                        throw_format_error("invalid type for a pointer argument");
+                    if (__specs.sign != sign_t::none || __specs.alt)
+                        throw_format_error("sign and '#' are not allowed for a pointer argument");
+                    break;
+            }
+            if (__textual && (__specs.sign != sign_t::none || __specs.alt || __specs.zero))
+                throw_format_error("sign, '#' and '0' are only allowed for numeric presentation types");
+            if (__specs.precision_arg || __specs.precision >= 0)
+            {
+                if (__kind != spec_kind::floating && __kind != spec_kind::string)
+                    throw_format_error("precision is only allowed for floating-point and string arguments");
+            }
+            return __p;
+        };
+    };
+
+
+
+    ///-------------------------------------------------- @section Format contexts -----------------------------------------------------------///
+
+
+
+    /// @brief Parsing state of a format string, handed to formatter::parse().
+    /// @tparam char_t The character type.
+    template<typename char_t>
+    class basic_format_parse_context
+    {
+    private:
+
+        /// The remaining format string.
+        const char_t* _begin;
+        const char_t* _end;
+        /// The indexing mode, 0: unknown, 1: manual, 2: automatic.
+        int _indexing = 0;
+        /// The next automatic argument index.
+        std::size_t _next_arg_id = 0;
+        /// The number of arguments.
+        std::size_t _num_args;
+        /// The argument kinds, only available while checking a format string at compile time.
+        const __detail::arg_type* _types = nullptr;
+
+    public:
+
+        using char_type = char_t;
+        using const_iterator = const char_t*;
+        using iterator = const_iterator;
+
+        /// @brief Explicit Constructor
+        /// @param __fmt The format string.
+        /// @param __num_args The number of arguments.
+        /// @param __types The argument kinds (compile-time checks only).
+        constexpr explicit basic_format_parse_context(std::basic_string_view<char_t> __fmt, std::size_t __num_args = 0,
+            const __detail::arg_type* __types = nullptr) noexcept
+            : _begin(__fmt.data()), _end(__fmt.data() + __fmt.size()), _num_args(__num_args), _types(__types) { };
+
+        basic_format_parse_context(const basic_format_parse_context&) = delete;
+        basic_format_parse_context& operator=(const basic_format_parse_context&) = delete;
+
+        /// @brief Get the beginning of the unparsed format string.
+        constexpr const_iterator begin() const noexcept { return _begin; };
+
+        /// @brief Get the end of the format string.
+        constexpr const_iterator end() const noexcept { return _end; };
+
+        /// @brief Advances the beginning of the unparsed format string.
+        constexpr void advance_to(const_iterator __it) noexcept { _begin = __it; };
+
+        /// @brief Gets the next argument index (automatic indexing).
+        /// @return The argument index.
+        constexpr std::size_t next_arg_id()
+        {
+            if (_indexing == 1)
+                __detail::throw_format_error("cannot switch from manual to automatic argument indexing");
+            _indexing = 2;
+            if (_next_arg_id >= _num_args)
+                __detail::throw_format_error("argument index out of range");
+            return _next_arg_id++;
+        };
+
+        /// @brief Checks a manual argument index.
+        /// @param __id The argument index.
+        constexpr void check_arg_id(std::size_t __id)
+        {
+            if (_indexing == 2)
+                __detail::throw_format_error("cannot switch from automatic to manual argument indexing");
+            _indexing = 1;
+            if (__id >= _num_args)
+                __detail::throw_format_error("argument index out of range");
+        };
+
+        /// @brief Checks that an argument used for a dynamic width or precision is an integer.
+        ///     Only possible at compile time, at runtime the check happens when the value is read.
+        /// @param __id The argument index.
+        constexpr void check_dynamic_spec_integral(std::size_t __id)
+        {
+            if (_types != nullptr && !__detail::is_integral_arg(_types[__id]))
+                __detail::throw_format_error("width/precision argument is not an integer");
+        };
+    };
+    using format_parse_context = basic_format_parse_context<char>;
+    using wformat_parse_context = basic_format_parse_context<wchar_t>;
+
+
+    /// @brief A type-erased formatting argument.
+    /// @tparam char_t The character type.
+    template<typename char_t>
+    class basic_format_arg
+    {
+    public:
+
+        /// @brief Handle to an argument of a user-defined type.
+        class handle
+        {
+        private:
+
+            /// The argument.
+            const void* _ptr;
+            /// Parses the spec and formats the argument with its formatter.
+            void (*_format)(basic_format_parse_context<char_t>&, basic_format_context<char_t>&, const void*);
+
+            template<typename T>
+            static void
+            format_custom(basic_format_parse_context<char_t>& __pc, basic_format_context<char_t>& __fc, const void* __p)
+            {
+                formatter<T, char_t> __f;
+                __pc.advance_to(__f.parse(__pc));
+                __fc.advance_to(__f.format(*static_cast<const T*>(__p), __fc));
+            };
+
+        public:
+
+            template<typename T>
+            explicit handle(const T& __v) noexcept : _ptr(std::addressof(__v)), _format(&format_custom<T>) { };
+
+            /// @brief Formats the argument.
+            /// @param __pc The parse context, positioned at the spec.
+            /// @param __fc The format context.
+            void format(basic_format_parse_context<char_t>& __pc, basic_format_context<char_t>& __fc) const
+            {
+                _format(__pc, __fc, _ptr);
+            };
+        };
+
+    private:
+
+        union {
+            std::monostate _none;
+            int _int;
+            unsigned int _uint;
+            long long _long_long;
+            unsigned long long _ulong_long;
+            bool _bool;
+            char_t _char;
+            float _float;
+            double _double;
+            long double _long_double;
+            const char_t* _cstring;
+            struct { const char_t* _data; std::size_t _size; } _string;
+            const void* _pointer;
+            handle _custom;
+        };
+        /// The kind of argument.
+        __detail::arg_type _type = __detail::arg_type::none;
+
+        template<typename c_t, typename T> friend basic_format_arg<c_t> make_format_arg(const T&) noexcept;
+        template<typename visitor_t, typename c_t> friend decltype(auto) visit_format_arg(visitor_t&&, basic_format_arg<c_t>);
+
+    public:
+
+        basic_format_arg() noexcept : _none() { };
+
+        /// @brief Checks if this holds an argument.
+        explicit operator bool() const noexcept { return _type != __detail::arg_type::none; };
+
+        /// @brief Get the kind of argument.
+        __detail::arg_type type() const noexcept { return _type; };
+    };
+
+
+    namespace __detail {
+        /// @brief Checks if a type is one of the character types (formatted as characters, not integers).
+        template<typename T>
+        inline constexpr bool is_character_v = std::is_same_v<T, char> || std::is_same_v<T, wchar_t> ||
+            std::is_same_v<T, char8_t> || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+        /// @brief Checks if a type is a (non-character, non-bool) integer.
+        template<typename T>
+        inline constexpr bool is_integer_v = std::is_integral_v<T> && !is_character_v<T> && !std::is_same_v<T, bool>;
+
+        template<typename T, typename char_t>
+        struct is_string_like : std::false_type { };
+        template<typename char_t, typename traits_t, typename alloc_t>
+        struct is_string_like<std::basic_string<char_t, traits_t, alloc_t>, char_t> : std::true_type { };
+        template<typename char_t, typename traits_t>
+        struct is_string_like<std::basic_string_view<char_t, traits_t>, char_t> : std::true_type { };
+
+        /// @brief The type an argument is formatted as (arrays decay to pointers).
+        template<typename T>
+        using formatted_type_t = std::conditional_t<std::is_array_v<std::remove_cvref_t<T>>,
+            const std::remove_extent_t<std::remove_cvref_t<T>>*, std::remove_cvref_t<T>>;
+
+        /// @brief Gets the type-erased kind of an argument type.
+        template<typename char_t, typename T>
+        consteval arg_type
+        get_arg_type()
+        {
+            using U = formatted_type_t<T>;
+            if constexpr (std::is_same_v<U, bool>)
+                return arg_type::bool_type;
+            else if constexpr (std::is_same_v<U, char_t> || (std::is_same_v<U, char> && std::is_same_v<char_t, wchar_t>))
+                return arg_type::char_type;
+            else if constexpr (is_integer_v<U> && std::is_signed_v<U>)
+                return sizeof(U) <= sizeof(int) ? arg_type::int_type : arg_type::long_long_type;
+            else if constexpr (is_integer_v<U>)
+                return sizeof(U) <= sizeof(unsigned int) ? arg_type::uint_type : arg_type::ulong_long_type;
+            else if constexpr (std::is_same_v<U, float>)
+                return arg_type::float_type;
+            else if constexpr (std::is_same_v<U, double>)
+                return arg_type::double_type;
+            else if constexpr (std::is_same_v<U, long double>)
+                return arg_type::long_double_type;
+            else if constexpr (std::is_same_v<U, char_t*> || std::is_same_v<U, const char_t*>)
+                return arg_type::cstring_type;
+            else if constexpr (is_string_like<U, char_t>::value)
+                return arg_type::string_type;
+            else if constexpr (std::is_same_v<U, std::nullptr_t> || std::is_same_v<U, void*> || std::is_same_v<U, const void*>)
+                return arg_type::pointer_type;
+            else
+                return arg_type::custom_type;
+        };
+    };
+
+
+    /// @brief Makes a type-erased argument from a value, the value has to outlive the argument.
+    /// @tparam char_t The character type.
+    /// @param __v The value.
+    /// @return The type-erased argument.
+    template<typename char_t, typename T>
+    basic_format_arg<char_t>
+    make_format_arg(const T& __v) noexcept
+    {
+        using __detail::arg_type;
+        basic_format_arg<char_t> __a;
+        constexpr auto __t = __detail::get_arg_type<char_t, T>();
+        __a._type = __t;
+
+        if constexpr (__t == arg_type::bool_type) __a._bool = __v;
+        else if constexpr (__t == arg_type::char_type) __a._char = static_cast<char_t>(__v);
+        else if constexpr (__t == arg_type::int_type) __a._int = static_cast<int>(__v);
+        else if constexpr (__t == arg_type::uint_type) __a._uint = static_cast<unsigned int>(__v);
+        else if constexpr (__t == arg_type::long_long_type) __a._long_long = static_cast<long long>(__v);
+        else if constexpr (__t == arg_type::ulong_long_type) __a._ulong_long = static_cast<unsigned long long>(__v);
+        else if constexpr (__t == arg_type::float_type) __a._float = __v;
+        else if constexpr (__t == arg_type::double_type) __a._double = __v;
+        else if constexpr (__t == arg_type::long_double_type) __a._long_double = __v;
+        else if constexpr (__t == arg_type::cstring_type) __a._cstring = __v;
+        else if constexpr (__t == arg_type::string_type) __a._string = { __v.data(), __v.size() };
+        else if constexpr (__t == arg_type::pointer_type) __a._pointer = static_cast<const void*>(__v);
+        else
+        {
+            static_assert(std::is_default_constructible_v<formatter<T, char_t>>,
+                "argument type is not formattable, specialize __gnu_cxx::v23::formatter for it");
+            ::new (static_cast<void*>(std::addressof(__a._custom))) typename basic_format_arg<char_t>::handle(__v);
+        }
+        return __a;
+    };
+
+    /// @brief Visits a type-erased argument with its real value.
+    /// @param __vis The visitor.
+    /// @param __a The argument.
+    /// @return What the visitor returned.
+    template<typename visitor_t, typename char_t>
+    decltype(auto)
+    visit_format_arg(visitor_t&& __vis, basic_format_arg<char_t> __a)
+    {
+        using __detail::arg_type;
+        switch (__a._type)
+        {
+            case arg_type::none: break;
+            case arg_type::int_type: return __vis(__a._int);
+            case arg_type::uint_type: return __vis(__a._uint);
+            case arg_type::long_long_type: return __vis(__a._long_long);
+            case arg_type::ulong_long_type: return __vis(__a._ulong_long);
+            case arg_type::bool_type: return __vis(__a._bool);
+            case arg_type::char_type: return __vis(__a._char);
+            case arg_type::float_type: return __vis(__a._float);
+            case arg_type::double_type: return __vis(__a._double);
+            case arg_type::long_double_type: return __vis(__a._long_double);
+            case arg_type::cstring_type: return __vis(__a._cstring);
+            case arg_type::string_type: return __vis(std::basic_string_view<char_t>(__a._string._data, __a._string._size));
+            case arg_type::pointer_type: return __vis(__a._pointer);
+            case arg_type::custom_type: return __vis(__a._custom);
+        }
+        return __vis(__a._none);
+    };
+
+
+    /// @brief A view over type-erased formatting arguments.
+    /// @tparam char_t The character type.
+    template<typename char_t>
+    class basic_format_args
+    {
+    private:
+
+        /// The arguments.
+        const basic_format_arg<char_t>* _args = nullptr;
+        /// The amount of arguments.
+        std::size_t _size = 0;
+
+    public:
+
+        basic_format_args() noexcept = default;
+
+        /// @brief Constructor
+        /// @param __args The arguments.
+        /// @param __n The amount of arguments.
+        basic_format_args(const basic_format_arg<char_t>* __args, std::size_t __n) noexcept : _args(__args), _size(__n) { };
+
+        /// @brief Gets an argument.
+        /// @param __i The argument index.
+        /// @return The argument, or an empty one when out of range.
+        basic_format_arg<char_t> get(std::size_t __i) const noexcept
+        {
+            return __i < _size ? _args[__i] : basic_format_arg<char_t>();
+        };
+
+        /// @brief Get the amount of arguments.
+        std::size_t size() const noexcept { return _size; };
+    };
+    using format_args = basic_format_args<char>;
+    using wformat_args = basic_format_args<wchar_t>;
+
+
+    namespace __detail {
+        /// @brief Owning storage for type-erased arguments, convertible to basic_format_args.
+        template<typename char_t, std::size_t N>
+        struct format_arg_store
+        {
+            basic_format_arg<char_t> _args[N == 0 ? 1 : N];
+
+            operator basic_format_args<char_t>() const noexcept { return basic_format_args<char_t>(_args, N); };
+        };
+    };
+
+    /// @brief Type-erases formatting arguments, the arguments have to outlive the result.
+    /// @param __args The arguments.
+    /// @return The argument store.
+    template<typename char_t = char, typename ... pargs_t>
+    __detail::format_arg_store<char_t, sizeof...(pargs_t)>
+    make_format_args(const pargs_t&... __args) noexcept
+    {
+        return { { make_format_arg<char_t>(__args)... } };
+    };
+    /// @brief Type-erases wide formatting arguments, the arguments have to outlive the result.
+    template<typename ... pargs_t>
+    __detail::format_arg_store<wchar_t, sizeof...(pargs_t)>
+    make_wformat_args(const pargs_t&... __args) noexcept
+    {
+        return { { make_format_arg<wchar_t>(__args)... } };
+    };
+
+
+    /// @brief Formatting state, handed to formatter::format().
+    /// @tparam char_t The character type.
+    template<typename char_t>
+    class basic_format_context
+    {
+    public:
+
+        using iterator = __detail::buffer_appender<char_t>;
+        using char_type = char_t;
+        template<typename T> using formatter_type = formatter<T, char_t>;
+
+    private:
+
+        /// The output.
+        iterator _out;
+        /// The arguments.
+        basic_format_args<char_t> _args;
+
+    public:
+
+        /// @brief Constructor
+        /// @param __out The output.
+        /// @param __args The arguments.
+        basic_format_context(iterator __out, basic_format_args<char_t> __args) noexcept : _out(__out), _args(__args) { };
+
+        basic_format_context(const basic_format_context&) = delete;
+        basic_format_context& operator=(const basic_format_context&) = delete;
+
+        /// @brief Gets an argument.
+        basic_format_arg<char_t> arg(std::size_t __id) const noexcept { return _args.get(__id); };
+
+        /// @brief Get the arguments.
+        basic_format_args<char_t> args() const noexcept { return _args; };
+
+        /// @brief Get the output iterator.
+        iterator out() const noexcept { return _out; };
+
+        /// @brief Advances the output iterator.
+        void advance_to(iterator __it) noexcept { _out = __it; };
+    };
+    using format_context = basic_format_context<char>;
+    using wformat_context = basic_format_context<wchar_t>;
+
+
+
+    ///------------------------------------------------------ @section Writers ----------------------------------------------------------------///
+
+
+
+    namespace __detail {
+        /// @brief Appends ASCII characters (widening them for wide buffers).
+        template<typename char_t>
+        inline void
+        write_ascii(format_buffer<char_t>& __buf, const char* __b, const char* __e)
+        {
+            if constexpr (std::is_same_v<char_t, char>)
+                __buf.append(__b, __e);
+            else
+            {
+                __buf.try_reserve(__buf.size() + static_cast<std::size_t>(__e - __b));
+                for (; __b != __e; ++__b)
+                    __buf.push_back(static_cast<char_t>(*__b));
+            }
+        };
+
+        /// @brief Appends __n copies of the fill of a spec.
+        template<typename char_t>
+        inline void
+        write_fill(format_buffer<char_t>& __buf, std::size_t __n, const format_specs<char_t>& __specs)
+        {
+            if (__specs.fill_size == 1)
+                __buf.fill(__n, __specs.fill[0]);
+            else
+            {
+                for (; __n != 0; --__n)
+                    __buf.append(__specs.fill, __specs.fill + __specs.fill_size);
+            }
+        };
+
+        /// @brief Writes something padded to the width of a spec.
+        /// @param __buf The buffer.
+        /// @param __specs The spec.
+        /// @param __width The display width of what is being written.
+        /// @param __default The alignment when the spec has none.
+        /// @param __write Writes the content.
+        template<typename char_t, typename writer_t>
+        inline void
+        write_padded(format_buffer<char_t>& __buf, const format_specs<char_t>& __specs, std::size_t __width,
+            align_t __default, writer_t&& __write)
+        {
+            auto __spec_width = static_cast<std::size_t>(__specs.width);
+            if (__spec_width <= __width)
+            {
+                __write(__buf);
+                return;
+            }
+
+            auto __padding = __spec_width - __width;
+            auto __align = __specs.align == align_t::none ? __default : __specs.align;
+            auto __left = __align == align_t::left ? 0 : __align == align_t::center ? __padding / 2 : __padding;
+            write_fill(__buf, __left, __specs);
+            __write(__buf);
+            write_fill(__buf, __padding - __left, __specs);
+        };
+
+        /// @brief Counts the display width of a string (code points, for UTF-8).
+        template<typename char_t>
+        constexpr std::size_t
+        display_width(const char_t* __p, std::size_t __n) noexcept
+        {
+            if constexpr (sizeof(char_t) == 1)
+            {
+                std::size_t __w = 0;
+                for (std::size_t __i = 0; __i < __n; ++__i)
+                    __w += (static_cast<unsigned char>(__p[__i]) & 0xc0) != 0x80;
+                return __w;
+            }
+            else
+                return __n;
+        };
+
+        /// @brief Gets the amount of code units making up the first __n code points of a string.
+        template<typename char_t>
+        constexpr std::size_t
+        code_units_for(const char_t* __p, std::size_t __size, std::size_t __n) noexcept
+        {
+            if constexpr (sizeof(char_t) == 1)
+            {
+                std::size_t __i = 0;
+                for (; __i < __size; ++__i)
+                    if ((static_cast<unsigned char>(__p[__i]) & 0xc0) != 0x80 && __n-- == 0)
+                        break;
+                return __i;
+            }
+            else
+                return __n < __size ? __n : __size;
+        };
+
+        /// @brief Writes a string with a spec (precision truncates, width pads).
+        template<typename char_t>
+        inline void
+        write_string(format_buffer<char_t>& __buf, std::basic_string_view<char_t> __s, const format_specs<char_t>& __specs)
+        {
+            auto __n = __s.size();
+            if (__specs.precision >= 0)
+                __n = code_units_for(__s.data(), __n, static_cast<std::size_t>(__specs.precision));
+            if (__specs.width == 0)
+            {
+                __buf.append(__s.data(), __s.data() + __n);
+                return;
+            }
+            write_padded(__buf, __specs, display_width(__s.data(), __n), align_t::left,
+                [&](auto& __b) { __b.append(__s.data(), __s.data() + __n); });
+        };
+
+        /// @brief Writes the sign/base prefix and digits of a number, zero-filling or padding to the width.
+        template<typename char_t>
+        inline void
+        write_number(format_buffer<char_t>& __buf, const char* __prefix, std::size_t __prefix_size,
+            const char* __digits, std::size_t __size, const format_specs<char_t>& __specs)
+        {
+            auto __width = __prefix_size + __size;
+            if (__specs.zero && __specs.align == align_t::none)
+            {
+                write_ascii(__buf, __prefix, __prefix + __prefix_size);
+                if (static_cast<std::size_t>(__specs.width) > __width)
+                    __buf.fill(static_cast<std::size_t>(__specs.width) - __width, char_t('0'));
+                write_ascii(__buf, __digits, __digits + __size);
+                return;
+            }
+            write_padded(__buf, __specs, __width, align_t::right, [&](auto& __b)
+            {
+                write_ascii(__b, __prefix, __prefix + __prefix_size);
+                write_ascii(__b, __digits, __digits + __size);
+            });
+        };
+
+        /// @brief Writes a single character with a spec.
+        template<typename char_t>
+        inline void
+        write_char(format_buffer<char_t>& __buf, char_t __c, const format_specs<char_t>& __specs)
+        {
+            write_string(__buf, std::basic_string_view<char_t>(&__c, 1), __specs);
+        };
+
+        /// @brief Gets room to write __n characters in place, or nullptr when the buffer can't give it contiguously
+        ///     (a bounded buffer that is about to run out).
+        template<typename char_t>
+        inline char_t*
+        reserve_in_place(format_buffer<char_t>& __buf, std::size_t __n)
+        {
+            __buf.try_reserve(__buf.size() + __n);
+            auto __size = __buf.size();
+            if (__buf.capacity() - __size < __n)
+                return nullptr;
+            __buf.try_resize(__size + __n);
+            return __buf.data() + __size;
+        };
+
+        /// @brief Writes an integer without a spec, straight into the buffer when it has the room.
+        template<typename char_t, typename uint_t>
+        inline void
+        write_decimal(format_buffer<char_t>& __buf, uint_t __abs, bool __negative)
+        {
+            int __n = count_digits(__abs);
+            auto __size = static_cast<std::size_t>(__n) + __negative;
+            auto __p = reserve_in_place(__buf, __size);
+            if (__p != nullptr)
+            {
+                if (__negative)
+                    *__p++ = char_t('-');
+                format_decimal(__p, __abs, __n);
+                return;
+            }
+
+            char_t __digits[std::numeric_limits<uint_t>::digits10 + 2];
+            __p = __digits;
+            if (__negative)
+                *__p++ = char_t('-');
+            format_decimal(__p, __abs, __n);
+            __buf.append(__digits, __digits + __size);
+        };
+
+        /// @brief Writes an integer with a spec.
+        template<typename char_t, typename int_t>
+        inline void
+        write_int(format_buffer<char_t>& __buf, int_t __v, const format_specs<char_t>& __specs)
+        {
+            using uint_t = std::make_unsigned_t<int_t>;
+
+            bool __negative = false;
+            if constexpr (std::is_signed_v<int_t>)
+                __negative = __v < 0;
+
+            if (__specs.type == 'c')
+            {
+                using uchar_t = std::make_unsigned_t<char_t>;
+                if (__negative || static_cast<unsigned long long>(__v) > std::numeric_limits<uchar_t>::max())
+                    throw_format_error("integer value out of range for the character type");
+                write_char(__buf, static_cast<char_t>(__v), __specs);
+                return;
+            }
+
+            uint_t __abs = static_cast<uint_t>(__v);
+            if (__negative)
+                __abs = uint_t(0) - __abs;
+
+            /// Plain decimal, no prefix or padding to work out.
+            if ((__specs.type == 0 || __specs.type == 'd') && __specs.width == 0 &&
+                (__specs.sign == sign_t::none || __specs.sign == sign_t::minus))
+            {
+                write_decimal(__buf, __abs, __negative);
+                return;
+            }
+
+            char __prefix[4];
+            std::size_t __prefix_size = 0;
+            if (__negative)
+                __prefix[__prefix_size++] = '-';
+            else if (__specs.sign == sign_t::plus)
+                __prefix[__prefix_size++] = '+';
+            else if (__specs.sign == sign_t::space)
+                __prefix[__prefix_size++] = ' ';
+
+            char __digits[sizeof(uint_t) * 8];
+            int __n;
+            switch (__specs.type)
+            {
+                case 'x': case 'X':
+                    __n = count_digits<4>(__abs);
+                    format_base2e<4>(__digits, __abs, __n, __specs.type == 'X');
+                    break;
+                case 'b': case 'B':
+                    __n = count_digits<1>(__abs);
+                    format_base2e<1>(__digits, __abs, __n);
+                    break;
+                case 'o':
+                    __n = count_digits<3>(__abs);
+                    format_base2e<3>(__digits, __abs, __n);
+                    break;
+                default:
+                    __n = count_digits(__abs);
+                    format_decimal(__digits, __abs, __n);
+                    break;
+            }
+            if (__specs.alt && __specs.type != 0 && __specs.type != 'd')
+            {
+                if (__specs.type == 'o')
+                {
+                    if (__abs != 0)
+                        __prefix[__prefix_size++] = '0';
+                }
+                else
+                {
+                    __prefix[__prefix_size++] = '0';
+                    __prefix[__prefix_size++] = __specs.type;
+                }
+            }
+            write_number(__buf, __prefix, __prefix_size, __digits, static_cast<std::size_t>(__n), __specs);
+        };
+
+        /// @brief Lays out digits in fixed notation.
+        /// @param __p Where to write (see fixed_size).
+        /// @param __d The digits, the first one is at 10^__exp, missing ones are zeros.
+        /// @param __n The amount of digits.
+        /// @param __exp The decimal exponent of the first digit.
+        /// @param __frac The amount of digits after the decimal point.
+        /// @param __point Whether to write the decimal point even without digits after it.
+        /// @return One past the last character.
+        inline char*
+        layout_fixed(char* __p, const char* __d, int __n, int __exp, int __frac, bool __point) noexcept
+        {
+            if (__exp < 0)
+                *__p++ = '0';
+            else
+            {
+                int __c = __n < __exp + 1 ? __n : __exp + 1;
+                std::char_traits<char>::copy(__p, __d, static_cast<std::size_t>(__c));
+                std::char_traits<char>::assign(__p + __c, static_cast<std::size_t>(__exp + 1 - __c), '0');
+                __p += __exp + 1;
+            }
+            if (__frac == 0 && !__point)
+                return __p;
+
+            *__p++ = '.';
+            int __z = __exp < 0 ? std::min(-__exp - 1, __frac) : 0;
+            int __i = __exp < 0 ? 0 : __exp + 1;
+            int __c = std::max(std::min(__n - __i, __frac - __z), 0);
+            std::char_traits<char>::assign(__p, static_cast<std::size_t>(__z), '0');
+            std::char_traits<char>::copy(__p + __z, __d + __i, static_cast<std::size_t>(__c));
+            std::char_traits<char>::assign(__p + __z + __c, static_cast<std::size_t>(__frac - __z - __c), '0');
+            return __p + __frac;
+        };
+
+        /// @brief Gets the size of layout_fixed.
+        constexpr std::size_t
+        fixed_size(int __exp, int __frac, bool __point) noexcept
+        {
+            return static_cast<std::size_t>((__exp < 0 ? 1 : __exp + 1) + (__frac != 0 || __point ? __frac + 1 : 0));
+        };
+
+        /// @brief Lays out digits in scientific notation.
+        /// @param __p Where to write (see scientific_size).
+        /// @param __d The digits (at least one), missing ones are zeros.
+        /// @param __n The amount of digits.
+        /// @param __exp The decimal exponent of the first digit.
+        /// @param __frac The amount of digits after the decimal point.
+        /// @param __point Whether to write the decimal point even without digits after it.
+        /// @param __upper Whether the exponent character is uppercase.
+        /// @return One past the last character.
+        inline char*
+        layout_scientific(char* __p, const char* __d, int __n, int __exp, int __frac, bool __point, bool __upper) noexcept
+        {
+            *__p++ = __d[0];
+            if (__frac != 0 || __point)
+            {
+                *__p++ = '.';
+                int __c = std::min(__n - 1, __frac);
+                std::char_traits<char>::copy(__p, __d + 1, static_cast<std::size_t>(__c));
+                std::char_traits<char>::assign(__p + __c, static_cast<std::size_t>(__frac - __c), '0');
+                __p += __frac;
+            }
+            *__p++ = __upper ? 'E' : 'e';
+            *__p++ = __exp < 0 ? '-' : '+';
+            auto __abs = static_cast<unsigned>(__exp < 0 ? -__exp : __exp);
+            if (__abs >= 100)
+            {
+                *__p++ = static_cast<char>('0' + __abs / 100);
+                __abs %= 100;
+            }
+            *__p++ = digit_pairs[__abs * 2];
+            *__p++ = digit_pairs[__abs * 2 + 1];
+            return __p;
+        };
+
+        /// @brief Gets the size of layout_scientific.
+        constexpr std::size_t
+        scientific_size(int __exp, int __frac, bool __point) noexcept
+        {
+            return static_cast<std::size_t>(1 + (__frac != 0 || __point ? __frac + 1 : 0) + (__exp <= -100 || __exp >= 100 ? 5 : 4));
+        };
+
+        /// @brief Gets the correctly rounded digits of a finite, non-zero float or double.
+        ///     The shortest round trip digits are rounded instead of generating exact ones where that gives the same
+        ///     result: they are within half an ulp of the value, so only an exact tie in them (or padding them past
+        ///     digits10 or for a subnormal, where the decimal grid is finer than the binary one) needs the exact digits.
+        /// @param __digits Receives the digits.
+        /// @param __v The value.
+        /// @param __fixed Whether __precision counts digits after the decimal point, rather than after the first digit.
+        /// @param __precision The precision.
+        /// @param __exp Receives the decimal exponent of the first digit.
+        /// @return The amount of digits, zero when the value rounds to zero.
+        template<typename float_t, std::size_t N>
+        inline int
+        exact_float_digits(basic_memory_buffer<char, N>& __digits, float_t __v, bool __fixed, int __precision, int& __exp)
+        {
+            auto __d = to_decimal_shortest(__v);
+            int __size = count_digits(__d.significand);
+            __exp = __d.exponent + __size - 1;
+            int __n = __fixed ? __exp + 1 + __precision : __precision + 1;
+            if (__n < 0)
+                return 0;
+
+            bool __exact = __size <= __n ? __n > std::numeric_limits<float_t>::digits10 || __v < std::numeric_limits<float_t>::min() :
+                __n + 1 == __size && __d.significand % 10 == 5;
+            if (!__exact)
+            {
+                __digits.resize(static_cast<std::size_t>(__size > __n ? __size : __n) + 1);
+                format_decimal(__digits.data(), __d.significand, __size);
+                if (__size <= __n)
+                    return __size;
+                if (__digits[static_cast<std::size_t>(__n)] < '5')
+                    return __n;
+
+                /// Round up (the significand has no trailing zeros, so a '5' followed by anything is above half).
+                for (int __i = __n - 1; __i >= 0; --__i)
+                {
+                    if (__digits[static_cast<std::size_t>(__i)] != '9')
+                    {
+                        ++__digits[static_cast<std::size_t>(__i)];
+                        return __n;
+                    }
+                    __digits[static_cast<std::size_t>(__i)] = '0';
+                }
+                __digits[0] = '1';
+                ++__exp;
+                if (!__fixed)
+                    return __n;
+                __digits[static_cast<std::size_t>(__n)] = __n == 0 ? '1' : '0';
+                return __n + 1;
+            }
+
+            std::uint64_t __m;
+            int __e;
+            decompose_float(__v, __m, __e);
+            exact_digits __g(__m, __e);
+            __exp = __g.exponent();
+            __n = __fixed ? __exp + 1 + __precision : __precision + 1;
+            if (__n < 0)
+                return 0;
+
+            __digits.resize(static_cast<std::size_t>(__n) + 1);
+            if (round_digits(__g, __digits.data(), __n))
+            {
+                ++__exp;
+                /// Fixed notation keeps the same last digit, so carrying into a new first digit adds one.
+                if (__fixed)
+                {
+                    __digits[static_cast<std::size_t>(__n)] = __n == 0 ? '1' : '0';
+                    ++__n;
+                }
+            }
+            return __n;
+        };
+
+        /// @brief Writes the shortest round trip form of a finite float or double without its sign, in whichever of
+        ///     fixed and scientific is shorter (fixed on a tie). That is never more than 24 characters.
+        /// @param __p Where to write.
+        /// @param __v The value.
+        /// @param __point Whether to always write the decimal point.
+        /// @return One past the last character.
+        template<typename float_t>
+        inline char*
+        format_shortest(char* __p, float_t __v, bool __point) noexcept
+        {
+            if (__v == 0)
+            {
+                *__p++ = '0';
+                if (__point)
+                    *__p++ = '.';
+                return __p;
+            }
+
+            auto __d = to_decimal_shortest(__v);
+            int __n = count_digits(__d.significand);
+            int __exp = __d.exponent + __n - 1;
+            auto __sci = scientific_size(__exp, __n - 1, false);
+            auto __fix = fixed_size(__exp, std::max(__n - 1 - __exp, 0), false);
+            if (__fix > __sci)
+            {
+                /// Write the digits one to the right, then pull the first one in front of the decimal point.
+                format_decimal(__p + 1, __d.significand, __n);
+                __p[0] = __p[1];
+                if (__n > 1 || __point)
+                    __p[1] = '.';
+                __p += __n + (__n > 1 || __point);
+                *__p++ = 'e';
+                *__p++ = __exp < 0 ? '-' : '+';
+                auto __abs = static_cast<unsigned>(__exp < 0 ? -__exp : __exp);
+                if (__abs >= 100)
+                {
+                    *__p++ = static_cast<char>('0' + __abs / 100);
+                    __abs %= 100;
+                }
+                *__p++ = digit_pairs[__abs * 2];
+                *__p++ = digit_pairs[__abs * 2 + 1];
+                return __p;
+            }
+
+            if (__exp >= __n)
+            {
+                /// Like std::to_chars, an integer past the shortest digits is written exactly rather than zero padded.
+                std::uint64_t __m;
+                int __e;
+                decompose_float(__v, __m, __e);
+                exact_digits __g(__m, __e);
+                for (int __i = __g.exponent(); __i >= 0; --__i)
+                    *__p++ = static_cast<char>('0' + __g.next());
+            }
+            else if (__exp == __n - 1)
+                __p = format_decimal(__p, __d.significand, __n);
+            else if (__exp >= 0)
+            {
+                format_decimal(__p + 1, __d.significand, __n);
+                for (int __i = 0; __i <= __exp; ++__i)
+                    __p[__i] = __p[__i + 1];
+                __p[__exp + 1] = '.';
+                return __p + __n + 1;
+            }
+            else
+            {
+                *__p++ = '0';
+                *__p++ = '.';
+                for (int __i = -1; __i > __exp; --__i)
+                    *__p++ = '0';
+                return format_decimal(__p, __d.significand, __n);
+            }
+            if (__point)
+                *__p++ = '.';
+            return __p;
+        };
+
+        /// @brief Writes a floating-point value with std::to_chars, for long double and the hexadecimal format.
+        template<typename char_t, typename float_t>
+        inline void
+        write_float_charconv(format_buffer<char_t>& __buf, float_t __v, const format_specs<char_t>& __specs,
+            const char* __prefix, std::size_t __prefix_size, bool __upper)
+        {
+            /// Fixed notation can be up to ~4950 digits long (long double) plus the precision.
+            std::string __heap;
+            char __stack[128];
+            char* __digits = __stack;
+            std::size_t __cap = sizeof(__stack);
+            auto __precision = __specs.precision;
+            if (auto __need = static_cast<std::size_t>(__precision < 0 ? 0 : __precision) +
+                    (__specs.type == 'f' || __specs.type == 'F' ? std::numeric_limits<float_t>::max_exponent10 : 0) + 48; __need > __cap)
+            {
+                __heap.resize(__need);
+                __digits = __heap.data();
+                __cap = __need;
+            }
+
+            std::to_chars_result __r;
+            int __general_precision = -1;
+            switch (__specs.type)
+            {
+                case 'a': case 'A':
+                    __r = __precision < 0 ? std::to_chars(__digits, __digits + __cap, __v, std::chars_format::hex)
+                        : std::to_chars(__digits, __digits + __cap, __v, std::chars_format::hex, __precision);
+                    break;
+                case 'e': case 'E':
+                    __r = std::to_chars(__digits, __digits + __cap, __v, std::chars_format::scientific, __precision < 0 ? 6 : __precision);
+                    break;
+                case 'f': case 'F':
+                    __r = std::to_chars(__digits, __digits + __cap, __v, std::chars_format::fixed, __precision < 0 ? 6 : __precision);
+                    break;
+                case 'g': case 'G':
+                    __general_precision = __precision < 0 ? 6 : __precision;
+                    __r = std::to_chars(__digits, __digits + __cap, __v, std::chars_format::general, __general_precision);
+                    break;
+                default:
+                    if (__precision < 0)
+                        __r = std::to_chars(__digits, __digits + __cap, __v);
+                    else
+                    {
+                        __general_precision = __precision;
+                        __r = std::to_chars(__digits, __digits + __cap, __v, std::chars_format::general, __precision);
+                    }
+                    break;
+            }
+            auto __end = __r.ptr;
+
+            /// '#' always shows the decimal point, and keeps the trailing zeros of the general format.
+            if (__specs.alt)
+            {
+                char __exp_char = __specs.type == 'a' || __specs.type == 'A' ? 'p' : 'e';
+                auto __exp = __digits;
+                while (__exp != __end && *__exp != __exp_char)
+                    ++__exp;
+                auto __dot = __digits;
+                while (__dot != __exp && *__dot != '.')
+                    ++__dot;
+
+                std::size_t __insert = __dot == __exp;
+                if (__general_precision >= 0)
+                {
+                    std::size_t __sig = 0, __all = 0;
+                    bool __nonzero = false;
+                    for (auto __p = __digits; __p != __exp; ++__p)
+                    {
+                        if (*__p == '.') continue;
+                        ++__all;
+                        __nonzero |= *__p != '0';
+                        __sig += __nonzero;
+                    }
+                    if (!__nonzero) __sig = __all;
+                    auto __want = static_cast<std::size_t>(__general_precision == 0 ? 1 : __general_precision);
+                    __insert += __want > __sig ? __want - __sig : 0;
+                }
+                if (__insert != 0)
+                {
+                    std::char_traits<char>::move(__exp + __insert, __exp, static_cast<std::size_t>(__end - __exp));
+                    std::char_traits<char>::assign(__exp, __insert, '0');
+                    if (__dot == __exp)
+                        *__exp = '.';
+                    __end += __insert;
+                }
+            }
+
+            if (__upper)
+            {
+                for (auto __p = __digits; __p != __end; ++__p)
+                    if (*__p >= 'a' && *__p <= 'z')
+                        *__p = static_cast<char>(*__p - 'a' + 'A');
+            }
+            write_number(__buf, __prefix, __prefix_size, __digits, static_cast<std::size_t>(__end - __digits), __specs);
+        };
+
+        /// @brief Writes a floating-point value with a spec.
+        template<typename char_t, typename float_t>
+        inline void
+        write_float(format_buffer<char_t>& __buf, float_t __v, const format_specs<char_t>& __specs)
+        {
+            char __prefix[1];
+            std::size_t __prefix_size = 0;
+            if (std::signbit(__v))
+                __prefix[__prefix_size++] = '-', __v = -__v;
+            else if (__specs.sign == sign_t::plus)
+                __prefix[__prefix_size++] = '+';
+            else if (__specs.sign == sign_t::space)
+                __prefix[__prefix_size++] = ' ';
+
+            bool __upper = __specs.type == 'A' || __specs.type == 'E' || __specs.type == 'F' || __specs.type == 'G';
+
+            /// Infinity and NaN are never zero-filled.
+            if (std::isinf(__v) || std::isnan(__v))
+            {
+                const char* __s = std::isinf(__v) ? (__upper ? "INF" : "inf") : (__upper ? "NAN" : "nan");
+                auto __specs_nz = __specs;
+                __specs_nz.zero = false;
+                write_number(__buf, __prefix, __prefix_size, __s, 3, __specs_nz);
+                return;
+            }
+
+            if constexpr (std::is_same_v<float_t, long double>)
+            {
+                write_float_charconv(__buf, __v, __specs, __prefix, __prefix_size, __upper);
+                return;
+            }
+            else
+            {
+                if (__specs.type == 'a' || __specs.type == 'A')
+                {
+                    write_float_charconv(__buf, __v, __specs, __prefix, __prefix_size, __upper);
+                    return;
+                }
+
+                if (__specs.precision < 0 && __specs.type == 0)
+                {
+                    char __body[32];
+                    auto __end = format_shortest(__body, __v, __specs.alt);
+                    write_number(__buf, __prefix, __prefix_size, __body, static_cast<std::size_t>(__end - __body), __specs);
+                    return;
+                }
+
+                basic_memory_buffer<char, 32> __digits;
+                int __n = 1, __exp = 0, __frac = 0;
+                bool __fixed = false;
+                if (__v == 0)
+                    __digits.push_back('0');
+
+                auto __precision = __specs.precision < 0 ? 6 : __specs.precision;
+                if (__specs.type == 'e' || __specs.type == 'E')
+                {
+                    if (__v != 0)
+                        __n = exact_float_digits(__digits, __v, false, __precision, __exp);
+                    __frac = __precision;
+                }
+                else if (__specs.type == 'f' || __specs.type == 'F')
+                {
+                    if (__v != 0)
+                        __n = exact_float_digits(__digits, __v, true, __precision, __exp);
+                    __fixed = true;
+                    __frac = __precision;
+                }
+                else
+                {
+                    /// General: scientific when the exponent is below -4 or not below the precision, trailing zeros
+                    ///     are removed unless '#' is given.
+                    __precision = __precision == 0 ? 1 : __precision;
+                    if (__v != 0)
+                        __n = exact_float_digits(__digits, __v, false, __precision - 1, __exp);
+                    __fixed = __exp >= -4 && __exp < __precision;
+                    if (!__specs.alt)
+                    {
+                        while (__n > 1 && __digits[static_cast<std::size_t>(__n - 1)] == '0')
+                            --__n;
+                        __precision = __n;
+                    }
+                    __frac = __fixed ? std::max(__precision - 1 - __exp, 0) : __precision - 1;
+                }
+
+                basic_memory_buffer<char, 64> __body;
+                if (__fixed)
+                {
+                    __body.resize(fixed_size(__exp, __frac, __specs.alt));
+                    layout_fixed(__body.data(), __digits.data(), __n, __exp, __frac, __specs.alt);
+                }
+                else
+                {
+                    __body.resize(scientific_size(__exp, __frac, __specs.alt));
+                    layout_scientific(__body.data(), __digits.data(), __n, __exp, __frac, __specs.alt, __upper);
+                }
+                write_number(__buf, __prefix, __prefix_size, __body.data(), __body.size(), __specs);
+            }
+        };
+
+        /// @brief Writes a pointer with a spec.
+        template<typename char_t>
+        inline void
+        write_pointer(format_buffer<char_t>& __buf, const void* __p, const format_specs<char_t>& __specs)
+        {
+            char __digits[sizeof(std::uintptr_t) * 2];
+            auto __v = reinterpret_cast<std::uintptr_t>(__p);
+            int __n = count_digits<4>(__v);
+            format_base2e<4>(__digits, __v, __n, __specs.type == 'P');
+            write_number(__buf, __specs.type == 'P' ? "0X" : "0x", 2, __digits, static_cast<std::size_t>(__n), __specs);
+        };
+
+        /// @brief Reads the value of a dynamic width or precision argument.
+        template<typename char_t>
+        inline int
+        get_dynamic_spec(basic_format_arg<char_t> __a)
+        {
+            unsigned long long __v = visit_format_arg([](auto __x) -> unsigned long long
+            {
+                if constexpr (is_integer_v<decltype(__x)>)
+                {
+                    if constexpr (std::is_signed_v<decltype(__x)>)
+                    {
+                        if (__x < 0)
+                            throw_format_error("negative width/precision");
+                    }
+                    return static_cast<unsigned long long>(__x);
+                }
+                else
+                    throw_format_error("width/precision argument is not an integer");
+            }, __a);
+            if (__v > 0x7fffffff)
+                throw_format_error("width/precision is too big");
+            return static_cast<int>(__v);
+        };
+
+        /// @brief Resolves the dynamic width and precision of a spec.
+        template<typename char_t>
+        inline format_specs<char_t>
+        resolve_specs(const format_specs<char_t>& __specs, basic_format_context<char_t>& __ctx)
+        {
+            if (!__specs.width_arg && !__specs.precision_arg)
+                return __specs;
+            auto __s = __specs;
+            if (__s.width_arg)
+                __s.width = get_dynamic_spec(__ctx.arg(static_cast<std::size_t>(__s.width)));
+            if (__s.precision_arg)
+                __s.precision = get_dynamic_spec(__ctx.arg(static_cast<std::size_t>(__s.precision)));
+            return __s;
+        };
+
+        /// @brief Base of the built-in formatters, holds the parsed spec.
+        template<typename char_t, spec_kind kind>
+        struct builtin_formatter
+        {
+            format_specs<char_t> _specs;
+
+            /// @brief Parses the spec.
+            /// @param __ctx The parse context.
+            /// @return The iterator to the closing '}'.
+            constexpr typename basic_format_parse_context<char_t>::iterator
+            parse(basic_format_parse_context<char_t>& __ctx)
+            {
+                return parse_format_specs(__ctx.begin(), __ctx.end(), _specs, __ctx, kind);
+            };
+        };
+    };
+
+
+
+    ///---------------------------------------------------- @section Formatters ---------------------------------------------------------------///
+
+
+
+    /// @brief Formatter for integers.
+    template<typename T, typename char_t>
+        requires (__detail::is_integer_v<T>)
+    struct formatter<T, char_t> : __detail::builtin_formatter<char_t, __detail::spec_kind::integer>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(T __v, basic_format_context<char_t>& __ctx) const
+        {
+            __detail::write_int(__ctx.out().buffer(), __v, __detail::resolve_specs(this->_specs, __ctx));
+            return __ctx.out();
+        };
+    };
+
+    /// @brief Formatter for bool.
+    template<typename char_t>
+    struct formatter<bool, char_t> : __detail::builtin_formatter<char_t, __detail::spec_kind::boolean>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(bool __v, basic_format_context<char_t>& __ctx) const
+        {
+            auto __specs = __detail::resolve_specs(this->_specs, __ctx);
+            if (__specs.type == 0 || __specs.type == 's')
+            {
+                static constexpr char_t __true[] = { 't', 'r', 'u', 'e' }, __false[] = { 'f', 'a', 'l', 's', 'e' };
+                __detail::write_string(__ctx.out().buffer(), __v ? std::basic_string_view<char_t>(__true, 4)
+                    : std::basic_string_view<char_t>(__false, 5), __specs);
+            }
+            else
+                __detail::write_int(__ctx.out().buffer(), static_cast<unsigned char>(__v), __specs);
+            return __ctx.out();
+        };
+    };
+
+    /// @brief Formatter for characters (and char into a wide string).
+    template<typename T, typename char_t>
+        requires (std::is_same_v<T, char_t> || (std::is_same_v<T, char> && std::is_same_v<char_t, wchar_t>))
+    struct formatter<T, char_t> : __detail::builtin_formatter<char_t, __detail::spec_kind::character>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(T __v, basic_format_context<char_t>& __ctx) const
+        {
+            auto __specs = __detail::resolve_specs(this->_specs, __ctx);
+            if (__specs.type == 0 || __specs.type == 'c')
+                __detail::write_char(__ctx.out().buffer(), static_cast<char_t>(__v), __specs);
+            else
+                __detail::write_int(__ctx.out().buffer(), static_cast<std::make_unsigned_t<T>>(__v), __specs);
+            return __ctx.out();
+        };
+    };
+
+    /// @brief Formatter for floating-point values.
+    template<typename T, typename char_t>
+        requires (std::is_floating_point_v<T>)
+    struct formatter<T, char_t> : __detail::builtin_formatter<char_t, __detail::spec_kind::floating>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(T __v, basic_format_context<char_t>& __ctx) const
+        {
+            __detail::write_float(__ctx.out().buffer(), __v, __detail::resolve_specs(this->_specs, __ctx));
+            return __ctx.out();
+        };
+    };
+
+    /// @brief Formatter for string views (and the base of the other string formatters).
+    template<typename char_t, typename traits_t>
+    struct formatter<std::basic_string_view<char_t, traits_t>, char_t> : __detail::builtin_formatter<char_t, __detail::spec_kind::string>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(std::basic_string_view<char_t, traits_t> __v, basic_format_context<char_t>& __ctx) const
+        {
+            __detail::write_string(__ctx.out().buffer(), std::basic_string_view<char_t>(__v.data(), __v.size()),
+                __detail::resolve_specs(this->_specs, __ctx));
+            return __ctx.out();
+        };
+    };
+
+    /// @brief Formatter for strings.
+    template<typename char_t, typename traits_t, typename alloc_t>
+    struct formatter<std::basic_string<char_t, traits_t, alloc_t>, char_t> : formatter<std::basic_string_view<char_t>, char_t>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(const std::basic_string<char_t, traits_t, alloc_t>& __v, basic_format_context<char_t>& __ctx) const
+        {
+            return formatter<std::basic_string_view<char_t>, char_t>::format(std::basic_string_view<char_t>(__v.data(), __v.size()), __ctx);
+        };
+    };
+
+    /// @brief Formatter for C strings.
+    template<typename char_t>
+    struct formatter<const char_t*, char_t> : formatter<std::basic_string_view<char_t>, char_t>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(const char_t* __v, basic_format_context<char_t>& __ctx) const
+        {
+            return formatter<std::basic_string_view<char_t>, char_t>::format(std::basic_string_view<char_t>(__v), __ctx);
+        };
+    };
+    template<typename char_t>
+    struct formatter<char_t*, char_t> : formatter<const char_t*, char_t> { };
+
+    /// @brief Formatter for pointers (void pointers and nullptr only, like std::format).
+    template<typename T, typename char_t>
+        requires (std::is_same_v<T, void*> || std::is_same_v<T, const void*> || std::is_same_v<T, std::nullptr_t>)
+    struct formatter<T, char_t> : __detail::builtin_formatter<char_t, __detail::spec_kind::pointer>
+    {
+        typename basic_format_context<char_t>::iterator
+        format(T __v, basic_format_context<char_t>& __ctx) const
+        {
+            __detail::write_pointer(__ctx.out().buffer(), static_cast<const void*>(__v), __detail::resolve_specs(this->_specs, __ctx));
+            return __ctx.out();
+        };
+    };
+
+
+
+    ///---------------------------------------------- @section Range and tuple formatters ----------------------------------------------------///
+
+
+
+    namespace __detail {
+        /// @brief The punctuation of ranges and tuples, in every character type.
+        template<typename char_t>
+        struct range_punctuation
+        {
+            static constexpr char_t _comma[] = { ',', ' ' };
+            static constexpr char_t _colon[] = { ':', ' ' };
+            static constexpr char_t _square[] = { '[', ']' };
+            static constexpr char_t _curly[] = { '{', '}' };
+            static constexpr char_t _round[] = { '(', ')' };
+
+            static constexpr std::basic_string_view<char_t> comma() { return { _comma, 2 }; };
+            static constexpr std::basic_string_view<char_t> colon() { return { _colon, 2 }; };
+            static constexpr std::basic_string_view<char_t> open(const char_t* __b) { return { __b, 1 }; };
+            static constexpr std::basic_string_view<char_t> close(const char_t* __b) { return { __b + 1, 1 }; };
+        };
+
+        /// @brief Checks if a type is formatted quoted and escaped as an element of a range or tuple (strings and characters).
+        template<typename T, typename char_t>
+        inline constexpr bool is_debug_formattable_v = is_string_like<T, char_t>::value || std::is_same_v<T, const char_t*> ||
+            std::is_same_v<T, char_t*> || std::is_same_v<T, char_t> || (std::is_same_v<T, char> && std::is_same_v<char_t, wchar_t>);
+
+        /// @brief Writes a string quoted, escaping the quote, backslashes and control characters (like the '?' spec of std::format).
+        /// @param __buf The buffer.
+        /// @param __s The string.
+        /// @param __quote The quote character.
+        template<typename char_t>
+        inline void
+        write_escaped(format_buffer<char_t>& __buf, std::basic_string_view<char_t> __s, char_t __quote)
+        {
+            __buf.push_back(__quote);
+            for (auto __c : __s)
+            {
+                char __esc = __c == '\t' ? 't' : __c == '\n' ? 'n' : __c == '\r' ? 'r' : __c == '\\' || __c == __quote ? static_cast<char>(__c) : 0;
+                if (__esc != 0)
+                {
+                    __buf.push_back(char_t('\\'));
+                    __buf.push_back(char_t(__esc));
+                }
+                else if (auto __u = static_cast<std::make_unsigned_t<char_t>>(__c); __u < 0x20 || __u == 0x7f)
+                {
+                    char __digits[8] = { '\\', 'u', '{' };
+                    int __n = count_digits<4>(static_cast<unsigned int>(__u));
+                    format_base2e<4>(__digits + 3, static_cast<unsigned int>(__u), __n, false);
+                    __digits[3 + __n] = '}';
+                    write_ascii(__buf, __digits, __digits + 4 + __n);
+                }
+                else
+                    __buf.push_back(__c);
+            }
+            __buf.push_back(__quote);
+        };
+
+        /// @brief Formatter of the elements of a range or tuple: the formatter of the element type, except that strings and
+        ///     characters are quoted and escaped when their spec is empty (or '?').
+        /// @tparam T The element type.
+        /// @tparam char_t The character type.
+        template<typename T, typename char_t>
+        struct element_formatter
+        {
+            formatter<T, char_t> _f;
+            bool _debug = false;
+
+            constexpr const char_t*
+            parse(basic_format_parse_context<char_t>& __ctx)
+            {
+                if constexpr (is_debug_formattable_v<T, char_t>)
+                {
+                    auto __p = __ctx.begin();
+                    if (__p != __ctx.end() && *__p == '?')
+                        __ctx.advance_to(++__p);
+                    else if (__p != __ctx.end() && *__p != '}')
+                        return _f.parse(__ctx);
+                    if (__p != __ctx.end() && *__p != '}')
+                        throw_format_error("invalid format spec");
+                    _debug = true;
+                    return __p;
+                }
+                else
+                    return _f.parse(__ctx);
+            };
+
+            typename basic_format_context<char_t>::iterator
+            format(const T& __v, basic_format_context<char_t>& __ctx) const
+            {
+                if constexpr (is_debug_formattable_v<T, char_t>)
+                {
+                    if (_debug)
+                    {
+                        if constexpr (std::is_same_v<T, char_t> || std::is_same_v<T, char>)
+                        {
+                            char_t __c = static_cast<char_t>(__v);
+                            write_escaped(__ctx.out().buffer(), std::basic_string_view<char_t>(&__c, 1), char_t('\''));
+                        }
+                        else
+                            write_escaped(__ctx.out().buffer(), std::basic_string_view<char_t>(__v), char_t('"'));
+                        return __ctx.out();
+                    }
+                }
+                return _f.format(__v, __ctx);
+            };
+        };
+
+        /// @brief Parses the [[fill]align][width] a range or tuple spec starts with (':' is never a fill, it starts the
+        ///     element spec).
+        template<typename char_t>
+        constexpr const char_t*
+        parse_outer_specs(basic_format_parse_context<char_t>& __ctx, format_specs<char_t>& __specs)
+        {
+            auto __p = __ctx.begin();
+            if (__p != __ctx.end() && *__p != ':')
+                __p = parse_fill_align(__p, __ctx.end(), __specs);
+            return parse_width(__p, __ctx.end(), __specs, __ctx);
+        };
+
+        /// @brief Writes a range or tuple, padded to the width of its spec (formatted into a stack buffer first then).
+        /// @param __specs The spec.
+        /// @param __ctx The format context.
+        /// @param __write Writes the range or tuple, gets the format context to write with.
+        template<typename char_t, typename writer_t>
+        inline typename basic_format_context<char_t>::iterator
+        write_outer(const format_specs<char_t>& __specs, basic_format_context<char_t>& __ctx, writer_t&& __write)
+        {
+            auto __s = resolve_specs(__specs, __ctx);
+            if (__s.width == 0)
+            {
+                __write(__ctx);
+                return __ctx.out();
+            }
+            basic_memory_buffer<char_t> __tmp;
+            basic_format_context<char_t> __inner(buffer_appender<char_t>(__tmp), __ctx.args());
+            __write(__inner);
+            write_padded(__ctx.out().buffer(), __s, display_width(__tmp.data(), __tmp.size()), align_t::left,
+                [&](auto& __b) { __b.append(__tmp.data(), __tmp.data() + __tmp.size()); });
+            return __ctx.out();
+        };
+
+        /// @brief Checks if a type is formatted as a range of its elements (strings are not, neither are ranges of themselves).
+        template<typename T, typename char_t>
+        concept formattable_range = std::ranges::range<const T> &&
+            !is_string_like<T, char>::value && !is_string_like<T, wchar_t>::value &&
+            !std::is_same_v<std::remove_cvref_t<std::ranges::range_reference_t<const T>>, T> &&
+            std::is_default_constructible_v<formatter<formatted_type_t<std::ranges::range_reference_t<const T>>, char_t>>;
+
+        /// @brief How a range is formatted: a sequence "[a, b]", a set "{a, b}" or a map "{k: v, k: v}" (the last two for
+        ///     ranges with a key_type, with a mapped_type for maps).
+        enum class range_kind : unsigned char { sequence, set, map };
+
+        template<typename T>
+        consteval range_kind
+        get_range_kind()
+        {
+            if constexpr (requires { typename T::key_type; typename T::mapped_type; })
+                return range_kind::map;
+            else if constexpr (requires { typename T::key_type; })
+                return range_kind::set;
+            else
+                return range_kind::sequence;
+        };
+    };
+
+
+    /// @brief Formatter of ranges, the elements are formatted one after the other straight into the output.
+    ///     The spec is [[fill]align][width][n|m][:element-spec]: 'n' leaves out the brackets, 'm' formats a range of pairs
+    ///     like a map, and the element spec is the spec of every element (strings and characters are quoted without one).
+    /// @tparam T The element type.
+    /// @tparam char_t The character type.
+    template<typename T, typename char_t = char>
+    class range_formatter
+    {
+    private:
+
+        using punct = __detail::range_punctuation<char_t>;
+
+        /// The formatter of the elements.
+        __detail::element_formatter<T, char_t> _underlying;
+        /// The separator and the brackets.
+        std::basic_string_view<char_t> _separator = punct::comma();
+        std::basic_string_view<char_t> _open = punct::open(punct::_square);
+        std::basic_string_view<char_t> _close = punct::close(punct::_square);
+        /// The [[fill]align][width] of the whole range.
+        __detail::format_specs<char_t> _specs;
+
+    public:
+
+        /// @brief Sets the separator between two elements.
+        constexpr void set_separator(std::basic_string_view<char_t> __sep) noexcept { _separator = __sep; };
+
+        /// @brief Sets the brackets around the elements.
+        constexpr void set_brackets(std::basic_string_view<char_t> __open, std::basic_string_view<char_t> __close) noexcept
+        {
+            _open = __open;
+            _close = __close;
+        };
+
+        /// @brief Get the formatter of the elements.
+        constexpr formatter<T, char_t>& underlying() noexcept { return _underlying._f; };
+        constexpr const formatter<T, char_t>& underlying() const noexcept { return _underlying._f; };
+
+        /// @brief Parses the spec.
+        /// @param __ctx The parse context.
+        /// @return The iterator to the closing '}'.
+        constexpr typename basic_format_parse_context<char_t>::iterator
+        parse(basic_format_parse_context<char_t>& __ctx)
+        {
+            auto __p = __detail::parse_outer_specs(__ctx, _specs);
+            if (__p != __ctx.end() && *__p == 'n')
+                set_brackets({ }, { }), ++__p;
+            else if (__p != __ctx.end() && *__p == 'm')
+            {
+                if constexpr (requires { _underlying._f.set_brackets({ }, { }); })
+                {
+                    set_brackets(punct::open(punct::_curly), punct::close(punct::_curly));
+                    _underlying._f.set_brackets({ }, { });
+                    _underlying._f.set_separator(punct::colon());
+                    ++__p;
+                }
+                else
+                    __detail::throw_format_error("'m' is only allowed for ranges of pairs");
+            }
+            if (__p != __ctx.end() && *__p == ':')
+            {
+                __ctx.advance_to(++__p);
+                return _underlying.parse(__ctx);
+            }
+            if (__p != __ctx.end() && *__p != '}')
+                __detail::throw_format_error("invalid format spec for a range");
+            __ctx.advance_to(__p);
+            _underlying.parse(__ctx);
+            return __p;
+        };
+
+        /// @brief Formats a range.
+        /// @param __r The range.
+        /// @param __ctx The format context.
+        template<typename range_t>
+        typename basic_format_context<char_t>::iterator
+        format(range_t&& __r, basic_format_context<char_t>& __ctx) const
+        {
+            return __detail::write_outer(_specs, __ctx, [&](basic_format_context<char_t>& __c)
+            {
+                auto& __buf = __c.out().buffer();
+                __buf.append(_open.data(), _open.data() + _open.size());
+                bool __first = true;
+                for (auto&& __e : __r)
+                {
+                    if (!__first)
+                        __c.out().buffer().append(_separator.data(), _separator.data() + _separator.size());
+                    __first = false;
+                    __c.advance_to(_underlying.format(__e, __c));
+                }
+                __c.out().buffer().append(_close.data(), _close.data() + _close.size());
+            });
+        };
+    };
+
+    /// @brief Formatter of ranges (std::vector, std::array, flat_map, flat_multi_map, ...), see range_formatter.
+    ///     Maps are formatted "{k: v, k: v}" and sets "{a, b}".
+    template<typename T, typename char_t>
+        requires __detail::formattable_range<T, char_t>
+    struct formatter<T, char_t> : range_formatter<__detail::formatted_type_t<std::ranges::range_reference_t<const T>>, char_t>
+    {
+        constexpr formatter()
+        {
+            using punct = __detail::range_punctuation<char_t>;
+            constexpr auto __kind = __detail::get_range_kind<T>();
+            if constexpr (__kind != __detail::range_kind::sequence)
+                this->set_brackets(punct::open(punct::_curly), punct::close(punct::_curly));
+            if constexpr (__kind == __detail::range_kind::map)
+            {
+                this->underlying().set_brackets({ }, { });
+                this->underlying().set_separator(punct::colon());
+            }
+        };
+    };
+
 
-/// @uses: std::runtime_error
-#include <stdexcept>
+    /// @brief Formatter of tuples and pairs, the elements are formatted one after the other straight into the output.
+    ///     The spec is [[fill]align][width][n|m][:element-spec]: 'n' leaves out the brackets, 'm' formats a pair as "k: v",
+    ///     and the element spec is the spec of every element (strings and characters are quoted without one).
+    /// @tparam char_t The character type.
+    /// @tparam T The element types.
+    template<typename char_t, typename ... T>
+    class tuple_formatter
+    {
+    private:
 
+        using punct = __detail::range_punctuation<char_t>;
 
-/// @brief Namespace for the "gnu/linux c++23 standard".
-namespace __gnu_cxx::v23 {
-    /// @brief A format error.
-    class format_error : public std::runtime_error 
+        /// The formatters of the elements.
+        std::tuple<__detail::element_formatter<T, char_t>...> _underlying;
+        /// The separator and the brackets.
+        std::basic_string_view<char_t> _separator = punct::comma();
+        std::basic_string_view<char_t> _open = punct::open(punct::_round);
+        std::basic_string_view<char_t> _close = punct::close(punct::_round);
+        /// The [[fill]align][width] of the whole tuple.
+        __detail::format_specs<char_t> _specs;
+
+        template<typename tuple_t, std::size_t ... I>
+        void write(const tuple_t& __t, basic_format_context<char_t>& __c, std::index_sequence<I...>) const
+        {
+            __c.out().buffer().append(_open.data(), _open.data() + _open.size());
+            ((I == 0 ? void() : __c.out().buffer().append(_separator.data(), _separator.data() + _separator.size()),
+                __c.advance_to(std::get<I>(_underlying).format(std::get<I>(__t), __c))), ...);
+            __c.out().buffer().append(_close.data(), _close.data() + _close.size());
+        };
+
+    public:
+
+        /// @brief Sets the separator between two elements.
+        constexpr void set_separator(std::basic_string_view<char_t> __sep) noexcept { _separator = __sep; };
+
+        /// @brief Sets the brackets around the elements.
+        constexpr void set_brackets(std::basic_string_view<char_t> __open, std::basic_string_view<char_t> __close) noexcept
+        {
+            _open = __open;
+            _close = __close;
+        };
+
+        /// @brief Parses the spec.
+        /// @param __ctx The parse context.
+        /// @return The iterator to the closing '}'.
+        constexpr typename basic_format_parse_context<char_t>::iterator
+        parse(basic_format_parse_context<char_t>& __ctx)
+        {
+            auto __p = __detail::parse_outer_specs(__ctx, _specs);
+            if (__p != __ctx.end() && *__p == 'n')
+                set_brackets({ }, { }), ++__p;
+            else if (__p != __ctx.end() && *__p == 'm')
+            {
+                if (sizeof...(T) != 2)
+                    __detail::throw_format_error("'m' is only allowed for pairs");
+                set_brackets({ }, { });
+                set_separator(punct::colon());
+                ++__p;
+            }
+            if (__p != __ctx.end() && *__p == ':')
+                ++__p;
+            else if (__p != __ctx.end() && *__p != '}')
+                __detail::throw_format_error("invalid format spec for a tuple");
+
+            /// Every element parses the same element spec.
+            const char_t* __close = __p;
+            std::apply([&](auto&... __f) { ((__ctx.advance_to(__p), __close = __f.parse(__ctx)), ...); }, _underlying);
+            return __close;
+        };
+
+        /// @brief Formats a tuple.
+        /// @param __t The tuple.
+        /// @param __ctx The format context.
+        template<typename tuple_t>
+        typename basic_format_context<char_t>::iterator
+        format(const tuple_t& __t, basic_format_context<char_t>& __ctx) const
+        {
+            return __detail::write_outer(_specs, __ctx, [&](basic_format_context<char_t>& __c)
+            {
+                write(__t, __c, std::index_sequence_for<T...>());
+            });
+        };
+    };
+
+    /// @brief Formatter of pairs, see tuple_formatter.
+    template<typename first_t, typename second_t, typename char_t>
+        requires std::is_default_constructible_v<formatter<__detail::formatted_type_t<first_t>, char_t>> &&
+            std::is_default_constructible_v<formatter<__detail::formatted_type_t<second_t>, char_t>>
+    struct formatter<std::pair<first_t, second_t>, char_t>
+        : tuple_formatter<char_t, __detail::formatted_type_t<first_t>, __detail::formatted_type_t<second_t>> { };
+
+    /// @brief Formatter of tuples, see tuple_formatter.
+    template<typename ... T, typename char_t>
+        requires (std::is_default_constructible_v<formatter<__detail::formatted_type_t<T>, char_t>> && ...)
+    struct formatter<std::tuple<T...>, char_t> : tuple_formatter<char_t, __detail::formatted_type_t<T>...> { };
+
+
+
+    ///-------------------------------------------------- @section Format strings -------------------------------------------------------------///
+
+
+
+    namespace __detail {
+        /// @brief Passes literal text between replacement fields to a handler, unescaping "}}".
+        template<typename char_t, typename handler_t>
+        constexpr void
+        parse_format_text(const char_t* __p, const char_t* __end, handler_t& __h)
+        {
+            while (__p != __end)
+            {
+                auto __brace = std::char_traits<char_t>::find(__p, static_cast<std::size_t>(__end - __p), char_t('}'));
+                if (__brace == nullptr)
+                {
+                    __h.on_text(__p, __end);
+                    return;
+                }
+                if (__brace + 1 == __end || __brace[1] != '}')
+                    throw_format_error("unmatched '}' in format string");
+                __h.on_text(__p, __brace + 1);
+                __p = __brace + 2;
+            }
+        };
+
+        /// @brief Parses one replacement field.
+        /// @param __p The pointer past the opening '{'.
+        /// @param __end The end of the format string.
+        /// @param __h The handler.
+        /// @return The pointer past the closing '}'.
+        template<typename char_t, typename handler_t>
+        constexpr const char_t*
+        parse_replacement_field(const char_t* __p, const char_t* __end, handler_t& __h)
+        {
+            if (__p == __end)
+                throw_format_error("unmatched '{' in format string");
+
+            /// "{{" is an escaped brace.
+            if (*__p == '{')
+            {
+                __h.on_text(__p, __p + 1);
+                return __p + 1;
+            }
+
+            /// "{}" is the common case, it never needs a spec parsed.
+            if (*__p == '}')
+            {
+                __h.on_replacement_field(__h.on_arg_id(), __p);
+                return __p + 1;
+            }
+
+            std::size_t __id;
+            if (*__p >= '0' && *__p <= '9')
+            {
+                int __index = 0;
+                if (*__p == '0' && __p + 1 != __end && __p[1] >= '0' && __p[1] <= '9')
+                    throw_format_error("invalid argument index in format string");
+                __p = parse_nonnegative_int(__p, __end, __index);
+                __id = __h.on_arg_id(static_cast<std::size_t>(__index));
+            }
+            else if (*__p == ':')
+                __id = __h.on_arg_id();
+            else
+                throw_format_error("invalid argument index in format string");
+
+            if (__p == __end)
+                throw_format_error("missing '}' in format string");
+            if (*__p == '}')
+            {
+                __h.on_replacement_field(__id, __p);
+                return __p + 1;
+            }
+            if (*__p != ':')
+                throw_format_error("missing '}' in format string");
+
+            __p = __h.on_format_specs(__id, __p + 1, __end);
+            if (__p == __end || *__p != '}')
+                throw_format_error("unknown format specifier");
+            return __p + 1;
+        };
+
+        /// @brief Parses a format string, passing text and replacement fields to a handler.
+        ///     The same parser drives both the compile-time check and the runtime formatting.
+        template<typename char_t, typename handler_t>
+        constexpr void
+        parse_format_string(std::basic_string_view<char_t> __fmt, handler_t& __h)
+        {
+            auto __p = __fmt.data();
+            auto __end = __p + __fmt.size();
+            while (__p != __end)
+            {
+                auto __brace = std::char_traits<char_t>::find(__p, static_cast<std::size_t>(__end - __p), char_t('{'));
+                if (__brace == nullptr)
+                {
+                    parse_format_text(__p, __end, __h);
+                    return;
+                }
+                parse_format_text(__p, __brace, __h);
+                __p = parse_replacement_field(__brace + 1, __end, __h);
+            }
+        };
+
+        /// @brief Parses the spec of an argument type with its formatter (compile-time checks).
+        template<typename char_t, typename T>
+        constexpr const char_t*
+        parse_arg_spec(basic_format_parse_context<char_t>& __ctx)
+        {
+            formatter<formatted_type_t<T>, char_t> __f;
+            return __f.parse(__ctx);
+        };
+
+        /// @brief Handler checking a format string against the argument types at compile time.
+        template<typename char_t, typename ... pargs_t>
+        struct checking_handler
+        {
+            using parse_func = const char_t* (*)(basic_format_parse_context<char_t>&);
+
+            arg_type _types[sizeof...(pargs_t) + 1] = { get_arg_type<char_t, pargs_t>()..., arg_type::none };
+            parse_func _parse[sizeof...(pargs_t) + 1] = { &parse_arg_spec<char_t, pargs_t>..., nullptr };
+            basic_format_parse_context<char_t> _ctx;
+
+            consteval explicit checking_handler(std::basic_string_view<char_t> __fmt)
+                : _ctx(__fmt, sizeof...(pargs_t), _types) { };
+
+            constexpr void on_text(const char_t*, const char_t*) { };
+            constexpr std::size_t on_arg_id() { return _ctx.next_arg_id(); };
+            constexpr std::size_t on_arg_id(std::size_t __id) { _ctx.check_arg_id(__id); return __id; };
+
+            constexpr void on_replacement_field(std::size_t __id, const char_t* __p)
+            {
+                _ctx.advance_to(__p);
+                _parse[__id](_ctx);
+            };
+
+            constexpr const char_t* on_format_specs(std::size_t __id, const char_t* __b, const char_t*)
+            {
+                _ctx.advance_to(__b);
+                return _parse[__id](_ctx);
+            };
+        };
+
+        /// @brief Handler formatting into a buffer at runtime.
+        template<typename char_t>
+        struct format_handler
+        {
+            basic_format_parse_context<char_t> _pctx;
+            basic_format_context<char_t> _fctx;
+
+            format_handler(format_buffer<char_t>& __buf, std::basic_string_view<char_t> __fmt, basic_format_args<char_t> __args)
+                : _pctx(__fmt, __args.size()), _fctx(buffer_appender<char_t>(__buf), __args) { };
+
+            void on_text(const char_t* __b, const char_t* __e) { _fctx.out().buffer().append(__b, __e); };
+            std::size_t on_arg_id() { return _pctx.next_arg_id(); };
+            std::size_t on_arg_id(std::size_t __id) { _pctx.check_arg_id(__id); return __id; };
+
+            /// @brief Formats an argument without a spec, this skips the formatter entirely for built-in types.
+            void on_replacement_field(std::size_t __id, const char_t* __p)
+            {
+                auto& __buf = _fctx.out().buffer();
+                visit_format_arg([&](auto __v)
+                {
+                    using T = decltype(__v);
+                    constexpr format_specs<char_t> __specs{};
+                    if constexpr (std::is_same_v<T, typename basic_format_arg<char_t>::handle>)
+                    {
+                        _pctx.advance_to(__p);
+                        __v.format(_pctx, _fctx);
+                    }
+                    else if constexpr (std::is_same_v<T, std::monostate>)
+                        throw_format_error("argument index out of range");
+                    else if constexpr (std::is_same_v<T, bool>)
+                        formatter<bool, char_t>().format(__v, _fctx);
+                    else if constexpr (std::is_same_v<T, char_t>)
+                        __buf.push_back(__v);
+                    else if constexpr (is_integer_v<T>)
+                        write_int(__buf, __v, __specs);
+                    else if constexpr (std::is_floating_point_v<T>)
+                        write_float(__buf, __v, __specs);
+                    else if constexpr (std::is_same_v<T, const char_t*>)
+                        __buf.append(__v, __v + std::char_traits<char_t>::length(__v));
+                    else if constexpr (std::is_same_v<T, std::basic_string_view<char_t>>)
+                        __buf.append(__v.data(), __v.data() + __v.size());
+                    else
+                        write_pointer(__buf, __v, __specs);
+                }, _fctx.arg(__id));
+            };
+
+            /// @brief Parses the spec of an argument with its formatter, then formats it.
+            const char_t* on_format_specs(std::size_t __id, const char_t* __b, const char_t*)
+            {
+                _pctx.advance_to(__b);
+                visit_format_arg([&](auto __v)
+                {
+                    using T = decltype(__v);
+                    if constexpr (std::is_same_v<T, typename basic_format_arg<char_t>::handle>)
+                        __v.format(_pctx, _fctx);
+                    else if constexpr (std::is_same_v<T, std::monostate>)
+                        throw_format_error("argument index out of range");
+                    else
+                    {
+                        formatter<T, char_t> __f;
+                        _pctx.advance_to(__f.parse(_pctx));
+                        _fctx.advance_to(__f.format(__v, _fctx));
+                    }
+                }, _fctx.arg(__id));
+                return _pctx.begin();
+            };
+        };
+
+        /// @brief A format string that is only known at runtime, see runtime_format().
+        template<typename char_t>
+        struct runtime_format_string
+        {
+            std::basic_string_view<char_t> _str;
+        };
+
+        /// @brief Formats into a buffer with type-erased arguments.
+        /// @param __buf The buffer.
+        /// @param __fmt The format string.
+        /// @param __args The arguments.
+        template<typename char_t>
+        void
+        vformat_to_buffer(format_buffer<char_t>& __buf, std::basic_string_view<char_t> __fmt, basic_format_args<char_t> __args)
+        {
+            auto __mark = format_mark(__buf.size());
+            format_handler<char_t> __h(__buf, __fmt, __args);
+            parse_format_string(__fmt, __h);
+            count_format(__fmt, __mark, __buf.size());
+        };
+    };
+
+
+    /// @brief A format string checked against its argument types at compile time.
+    ///     Constructing one from a string literal parses it during compilation, so a malformed replacement field,
+    ///     an out of range argument index or a spec that doesn't fit the argument type is a build error.
+    /// @tparam char_t The character type.
+    /// @tparam pargs_t The argument types.
+    template<typename char_t, typename ... pargs_t>
+    class basic_format_string
     {
+    private:
+
+        /// The format string.
+        std::basic_string_view<char_t> _str;
+
     public:
 
-        /// @brief Explicit Constructor
-        /// @param what What the error is.
-        explicit format_error(const std::string& what) : std::runtime_error(what) { };
+        /// @brief Consteval Constructor
+        /// @param __s The format string.
+        template<typename T>
+            requires std::convertible_to<const T&, std::basic_string_view<char_t>>
+        consteval basic_format_string(const T& __s) : _str(__s)
+        {
+            __detail::checking_handler<char_t, pargs_t...> __h(_str);
+            __detail::parse_format_string(_str, __h);
+        };
+
+        /// @brief Constructor (unchecked, for strings only known at runtime).
+        /// @param __s The runtime format string.
+        basic_format_string(__detail::runtime_format_string<char_t> __s) noexcept : _str(__s._str) { };
+
+        /// @brief Get the format string.
+        constexpr std::basic_string_view<char_t> get() const noexcept { return _str; };
+    };
+    template<typename ... pargs_t>
+    using format_string = basic_format_string<char, std::type_identity_t<pargs_t>...>;
+    template<typename ... pargs_t>
+    using wformat_string = basic_format_string<wchar_t, std::type_identity_t<pargs_t>...>;
+
+
+    /// @brief Wraps a format string only known at runtime, it is checked when formatting (throwing format_error).
+    /// @param __fmt The format string.
+    /// @return The runtime format string.
+    inline __detail::runtime_format_string<char>
+    runtime_format(std::string_view __fmt) noexcept
+    {
+        return { __fmt };
+    };
+    /// @brief Wraps a wide format string only known at runtime.
+    inline __detail::runtime_format_string<wchar_t>
+    runtime_format(std::wstring_view __fmt) noexcept
+    {
+        return { __fmt };
+    };
+
+
+
+    ///------------------------------------------- @section Output iterator formatting ------------------------------------------------------///
+
+
+
+    /// @brief Result of format_to_n().
+    /// @tparam out_t The output iterator type.
+    template<typename out_t>
+    struct format_to_n_result
+    {
+        /// The output iterator past the last written character.
+        out_t out;
+        /// The size the whole output would have had (without the limit).
+        std::iter_difference_t<out_t> size;
+    };
+
+    namespace __detail {
+        /// @brief Writes to an output iterator in a single pass.
+        ///     Back inserters into memory buffers, strings and vectors are written straight into the container,
+        ///     character pointers straight into the array, anything else is staged in a small array and copied out.
+        /// @param __out The output iterator.
+        /// @param __write Writes the output, gets a format_buffer<char_t>&.
+        /// @return The output iterator past the last written character.
+        template<typename char_t, typename out_t, typename write_t>
+        out_t
+        write_to_iterator(out_t __out, write_t&& __write)
+        {
+            if constexpr (is_buffer_back_inserter<out_t, char_t>::value)
+            {
+                __write(get_container(__out));
+                return __out;
+            }
+            else if constexpr (is_contiguous_back_inserter<out_t, char_t>::value)
+            {
+                auto& __c = get_container(__out);
+                container_buffer<std::remove_reference_t<decltype(__c)>> __buf(__c);
+                __write(__buf);
+                return __out;
+            }
+            else
+            {
+                iterator_buffer<out_t, char_t> __buf(__out);
+                __write(__buf);
+                return __buf.out();
+            }
+        };
+
+        /// @brief Formats to an output iterator in a single pass.
+        template<typename char_t, typename out_t>
+        out_t
+        format_to_iterator(out_t __out, std::basic_string_view<char_t> __fmt, basic_format_args<char_t> __args)
+        {
+            return write_to_iterator<char_t>(__out, [&](format_buffer<char_t>& __buf) { vformat_to_buffer(__buf, __fmt, __args); });
+        };
+
+        /// @brief Formats to an output iterator, writing at most __n characters.
+        template<typename char_t, typename out_t>
+        format_to_n_result<out_t>
+        format_to_iterator_n(out_t __out, std::iter_difference_t<out_t> __n, std::basic_string_view<char_t> __fmt,
+            basic_format_args<char_t> __args)
+        {
+            iterator_buffer<out_t, char_t> __buf(__out, __n < 0 ? 0 : static_cast<std::size_t>(__n));
+            vformat_to_buffer(__buf, __fmt, __args);
+            auto __it = __buf.out();
+            return { __it, static_cast<std::iter_difference_t<out_t>>(__buf.count()) };
+        };
+    };
+
+
+    /// @brief Formats to an output iterator with type-erased arguments.
+    /// @param __out The output iterator.
+    /// @param __fmt The format string (checked while formatting).
+    /// @param __args The arguments, see make_format_args().
+    /// @return The output iterator past the last written character.
+    template<typename out_t>
+    static out_t
+    vformat_to(out_t __out, std::string_view __fmt, format_args __args)
+    {
+        return __detail::format_to_iterator<char>(__out, __fmt, __args);
+    };
+    /// @brief Formats to an output iterator with type-erased wide arguments.
+    template<typename out_t>
+    static out_t
+    vformat_to(out_t __out, std::wstring_view __fmt, wformat_args __args)
+    {
+        return __detail::format_to_iterator<wchar_t>(__out, __fmt, __args);
+    };
+
+
+    /// @brief Formats to an output iterator (a character array, std::back_inserter, ...) in a single pass.
+    /// @tparam out_t The output iterator type.
+    /// @tparam pargs_t A template for packed arguments (no va_args).
+    /// @param __out The output iterator.
+    /// @param __format The string that is going to be formatted.
+    /// @param ...__args Virtual packed arguments to format.
+    /// @return The output iterator past the last written character.
+    template<typename out_t, typename ... pargs_t>
+    static out_t
+    format_to(out_t __out, format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        return __detail::format_to_iterator<char>(__out, __format.get(), basic_format_args<char>(make_format_args(__args...)));
+    };
+    /// @brief Formats a wide string to an output iterator in a single pass.
+    template<typename out_t, typename ... pargs_t>
+    static out_t
+    format_to(out_t __out, wformat_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        return __detail::format_to_iterator<wchar_t>(__out, __format.get(), basic_format_args<wchar_t>(make_wformat_args(__args...)));
+    };
+
+
+    /// @brief Formats to an output iterator, writing at most __n characters.
+    /// @tparam out_t The output iterator type.
+    /// @tparam pargs_t A template for packed arguments (no va_args).
+    /// @param __out The output iterator.
+    /// @param __n The maximum amount of characters written.
+    /// @param __format The string that is going to be formatted.
+    /// @param ...__args Virtual packed arguments to format.
+    /// @return The output iterator past the last written character, and the size the whole output would have had.
+    template<typename out_t, typename ... pargs_t>
+    static format_to_n_result<out_t>
+    format_to_n(out_t __out, std::iter_difference_t<out_t> __n, format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        return __detail::format_to_iterator_n<char>(__out, __n, __format.get(), basic_format_args<char>(make_format_args(__args...)));
+    };
+    /// @brief Formats a wide string to an output iterator, writing at most __n characters.
+    template<typename out_t, typename ... pargs_t>
+    static format_to_n_result<out_t>
+    format_to_n(out_t __out, std::iter_difference_t<out_t> __n, wformat_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        return __detail::format_to_iterator_n<wchar_t>(__out, __n, __format.get(), basic_format_args<wchar_t>(make_wformat_args(__args...)));
+    };
+
+
+    /// @brief Gets the size of a formatted string, without storing it.
+    /// @tparam pargs_t A template for packed arguments (no va_args).
+    /// @param __format The string that is going to be formatted.
+    /// @param ...__args Virtual packed arguments to format.
+    /// @return The amount of characters.
+    template<typename ... pargs_t>
+    static std::size_t
+    _GLIBCXX_NODISCARD
+    formatted_size(format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        __detail::counting_buffer<char> __buf;
+        __detail::vformat_to_buffer(__buf, __format.get(), basic_format_args<char>(make_format_args(__args...)));
+        return __buf.count();
+    };
+    /// @brief Gets the size of a formatted wide string, without storing it.
+    template<typename ... pargs_t>
+    static std::size_t
+    _GLIBCXX_NODISCARD
+    formatted_size(wformat_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        __detail::counting_buffer<wchar_t> __buf;
+        __detail::vformat_to_buffer(__buf, __format.get(), basic_format_args<wchar_t>(make_wformat_args(__args...)));
+        return __buf.count();
+    };
+
+
+
+    ///----------------------------------------------- @section Compiled format strings -----------------------------------------------------------///
+
+
+
+    /// @brief A format string only known at runtime, parsed and checked against its argument types once, then formatted
+    ///     any amount of times without parsing: the literal text is stored unescaped, every replacement field keeps the
+    ///     formatter of its argument's type with the spec already parsed into it. Construction throws format_error for
+    ///     everything a format_string would have been a build error for.
+    /// @tparam char_t The character type.
+    /// @tparam pargs_t The argument types.
+    template<typename char_t, typename ... pargs_t>
+    class basic_compiled_format
+    {
+    private:
+
+        /// The formatter of a replacement field, the alternative past the index of its argument (std::monostate for none).
+        using formatter_t = std::variant<std::monostate, formatter<__detail::formatted_type_t<pargs_t>, char_t>...>;
+
+        /// @brief Literal text followed by at most one replacement field.
+        struct segment
+        {
+            /// The literal text, an offset and size into _text.
+            std::size_t _offset = 0;
+            std::size_t _size = 0;
+            /// The argument index, sizeof...(pargs_t) when there is no replacement field.
+            std::size_t _arg = sizeof...(pargs_t);
+            formatter_t _formatter;
+        };
+
+        /// The literal text of all segments.
+        std::basic_string<char_t> _text;
+        /// The segments, in order.
+        std::vector<segment> _segments;
+
+        /// @brief Handler turning a format string into segments, checking it like checking_handler does at compile time.
+        struct compiler
+        {
+            basic_compiled_format& _cf;
+            __detail::arg_type _types[sizeof...(pargs_t) + 1] = { __detail::get_arg_type<char_t, pargs_t>()..., __detail::arg_type::none };
+            basic_format_parse_context<char_t> _ctx;
+            /// Where the text of the next segment starts.
+            std::size_t _offset = 0;
+
+            compiler(basic_compiled_format& __cf, std::basic_string_view<char_t> __fmt)
+                : _cf(__cf), _ctx(__fmt, sizeof...(pargs_t), _types) { };
+
+            void on_text(const char_t* __b, const char_t* __e) { _cf._text.append(__b, __e); };
+            std::size_t on_arg_id() { return _ctx.next_arg_id(); };
+            std::size_t on_arg_id(std::size_t __id) { _ctx.check_arg_id(__id); return __id; };
+
+            void on_replacement_field(std::size_t __id, const char_t* __p)
+            {
+                _ctx.advance_to(__p);
+                parse(__id, std::index_sequence_for<pargs_t...>());
+            };
+
+            const char_t* on_format_specs(std::size_t __id, const char_t* __b, const char_t*)
+            {
+                _ctx.advance_to(__b);
+                return parse(__id, std::index_sequence_for<pargs_t...>());
+            };
+
+            /// @brief Ends a segment at a replacement field, parsing its spec with the formatter of the argument.
+            template<std::size_t ... I>
+            const char_t* parse(std::size_t __id, std::index_sequence<I...>)
+            {
+                auto& __s = _cf._segments.emplace_back();
+                __s._offset = _offset;
+                __s._size = _cf._text.size() - _offset;
+                __s._arg = __id;
+                _offset = _cf._text.size();
+                const char_t* __end = nullptr;
+                ((__id == I ? (void)(__end = __s._formatter.template emplace<I + 1>().parse(_ctx)) : void()), ...);
+                return __end;
+            };
+        };
+
+        /// @brief Formats the segments.
+        template<std::size_t ... I>
+        void format_segments(__detail::format_buffer<char_t>& __buf, basic_format_context<char_t>& __ctx, std::index_sequence<I...>,
+            const pargs_t&... __args) const
+        {
+            auto __values = std::forward_as_tuple(__args...);
+            for (const auto& __s : _segments)
+            {
+                __buf.append(_text.data() + __s._offset, _text.data() + __s._offset + __s._size);
+                ((__s._arg == I ? (void)__ctx.advance_to(std::get<I + 1>(__s._formatter).format(std::get<I>(__values), __ctx)) : void()), ...);
+            }
+        };
+
+    public:
+
+        /// @brief Explicit Constructor, parses and checks the format string.
+        /// @param __fmt The format string (it does not have to outlive this).
+        explicit basic_compiled_format(std::basic_string_view<char_t> __fmt)
+        {
+            compiler __c(*this, __fmt);
+            __detail::parse_format_string(__fmt, __c);
+            if (__c._offset != _text.size() || _segments.empty())
+            {
+                auto& __s = _segments.emplace_back();
+                __s._offset = __c._offset;
+                __s._size = _text.size() - __c._offset;
+            }
+        };
+
+        /// @brief Formats into a buffer.
+        /// @param __buf The buffer.
+        /// @param ...__args The arguments.
+        void format_to_buffer(__detail::format_buffer<char_t>& __buf, const pargs_t&... __args) const
+        {
+            auto __mark = __detail::format_mark(__buf.size());
+            auto __store = make_format_args<char_t>(__args...);
+            basic_format_context<char_t> __ctx(__detail::buffer_appender<char_t>(__buf), __store);
+            format_segments(__buf, __ctx, std::index_sequence_for<pargs_t...>(), __args...);
+            __detail::count_format(std::basic_string_view<char_t>(_text), __mark, __buf.size());
+        };
+
+        /// @brief Formats to an output iterator in a single pass.
+        /// @param __out The output iterator.
+        /// @param ...__args The arguments.
+        /// @return The output iterator past the last written character.
+        template<typename out_t>
+        out_t format_to(out_t __out, const pargs_t&... __args) const
+        {
+            return __detail::write_to_iterator<char_t>(__out, [&](__detail::format_buffer<char_t>& __buf) { format_to_buffer(__buf, __args...); });
+        };
+
+        /// @brief Formats a string.
+        /// @param ...__args The arguments.
+        /// @return The formatted string.
+        std::basic_string<char_t> format(const pargs_t&... __args) const
+        {
+            basic_memory_buffer<char_t> __buf;
+            format_to_buffer(__buf, __args...);
+            __detail::count_string<char_t>(__buf.size());
+            return std::basic_string<char_t>(__buf.data(), __buf.size());
+        };
+
+        /// @brief Gets the size of the formatted string, without storing it.
+        std::size_t formatted_size(const pargs_t&... __args) const
+        {
+            __detail::counting_buffer<char_t> __buf;
+            format_to_buffer(__buf, __args...);
+            return __buf.count();
+        };
+
+        /// @brief Get the amount of segments (literal text followed by at most one replacement field).
+        std::size_t segments() const noexcept { return _segments.size(); };
+    };
+    template<typename ... pargs_t>
+    using compiled_format = basic_compiled_format<char, pargs_t...>;
+    template<typename ... pargs_t>
+    using wcompiled_format = basic_compiled_format<wchar_t, pargs_t...>;
+
+
+    /// @brief A small least recently used cache of compiled format strings for one list of argument types, keyed by the
+    ///     address of the format string. Callers passing the same (configured) strings over and over parse each once;
+    ///     a hit compares the string with the one compiled as well, so an address reused for other text recompiles.
+    ///     Not thread-safe, see vcformat() for a cache per thread.
+    /// @tparam char_t The character type.
+    /// @tparam pargs_t The argument types.
+    template<typename char_t, typename ... pargs_t>
+    class basic_format_cache
+    {
+    private:
+
+        /// @brief A cached format string.
+        struct entry
+        {
+            /// The address of the format string.
+            const char_t* _key = nullptr;
+            /// The format string it was compiled from.
+            std::basic_string<char_t> _str;
+            std::optional<basic_compiled_format<char_t, pargs_t...>> _compiled;
+            /// When it was last used.
+            std::uint64_t _used = 0;
+        };
+
+        /// The entries, never more than the capacity (so they never move).
+        std::vector<entry> _entries;
+        std::size_t _capacity;
+        /// The use counter.
+        std::uint64_t _tick = 0;
+
+    public:
 
         /// @brief Explicit Constructor
-        /// @param what What the error is.
-        explicit format_error(const char* what) : std::runtime_error(what) { };
+        /// @param __capacity The amount of format strings kept.
+        explicit basic_format_cache(std::size_t __capacity = 16) : _capacity(std::max<std::size_t>(__capacity, 1))
+        {
+            _entries.reserve(_capacity);
+        };
+
+        /// @brief Gets the compiled format string, compiling it (and evicting the least recently used one) on a miss.
+        /// @param __fmt The format string.
+        /// @return The compiled format string, valid until it is evicted.
+        const basic_compiled_format<char_t, pargs_t...>& get(std::basic_string_view<char_t> __fmt)
+        {
+            entry* __lru = nullptr;
+            for (auto& __e : _entries)
+            {
+                if (__e._key == __fmt.data() && std::basic_string_view<char_t>(__e._str) == __fmt)
+                {
+                    __e._used = ++_tick;
+                    return *__e._compiled;
+                }
+                if (__lru == nullptr || __e._used < __lru->_used)
+                    __lru = &__e;
+            }
+
+            /// Compile before touching an entry, a bad format string leaves the cache as it was.
+            basic_compiled_format<char_t, pargs_t...> __compiled(__fmt);
+            auto& __e = _entries.size() < _capacity ? _entries.emplace_back() : *__lru;
+            __e._key = __fmt.data();
+            __e._str.assign(__fmt.data(), __fmt.size());
+            __e._compiled.emplace(std::move(__compiled));
+            __e._used = ++_tick;
+            return *__e._compiled;
+        };
+
+        /// @brief Get the amount of cached format strings.
+        std::size_t size() const noexcept { return _entries.size(); };
+
+        /// @brief Get the amount of format strings kept.
+        std::size_t capacity() const noexcept { return _capacity; };
+
+        /// @brief Drops every cached format string.
+        void clear() noexcept { _entries.clear(); };
+    };
+    template<typename ... pargs_t>
+    using format_cache = basic_format_cache<char, pargs_t...>;
+    template<typename ... pargs_t>
+    using wformat_cache = basic_format_cache<wchar_t, pargs_t...>;
+
+
+    /// @brief Formats to an output iterator with a compiled format string.
+    /// @tparam out_t The output iterator type.
+    /// @param __out The output iterator.
+    /// @param __format The compiled format string.
+    /// @param ...__args The arguments.
+    /// @return The output iterator past the last written character.
+    template<typename out_t, typename char_t, typename ... pargs_t>
+    static out_t
+    format_to(out_t __out, const basic_compiled_format<char_t, pargs_t...>& __format, const std::type_identity_t<pargs_t>&... __args)
+    {
+        return __format.format_to(__out, __args...);
+    };
+
+    /// @brief Gets the size of a string formatted with a compiled format string, without storing it.
+    template<typename char_t, typename ... pargs_t>
+    static std::size_t
+    _GLIBCXX_NODISCARD
+    formatted_size(const basic_compiled_format<char_t, pargs_t...>& __format, const std::type_identity_t<pargs_t>&... __args)
+    {
+        return __format.formatted_size(__args...);
+    };
+
+    /// @brief Formats a string with a compiled format string.
+    /// @param __format The compiled format string.
+    /// @param ...__args The arguments.
+    /// @return The formatted string.
+    template<typename ... pargs_t>
+    static std::string
+    _GLIBCXX_NODISCARD
+    vformat(const compiled_format<pargs_t...>& __format, const std::type_identity_t<pargs_t>&... __args)
+    {
+        return __format.format(__args...);
+    };
+    /// @brief Formats a wide string with a compiled format string.
+    template<typename ... pargs_t>
+    static std::wstring
+    _GLIBCXX_NODISCARD
+    wformat(const wcompiled_format<pargs_t...>& __format, const std::type_identity_t<pargs_t>&... __args)
+    {
+        return __format.format(__args...);
+    };
+
+    /// @brief Formats a string only known at runtime, compiled once per calling thread and address of the string (see
+    ///     basic_format_cache, every thread keeps the last 32 per list of argument types).
+    /// @tparam pargs_t A template for packed arguments (no va_args).
+    /// @param __fmt The format string, checked when it is compiled (throwing format_error).
+    /// @param ...__args Virtual packed arguments to format.
+    /// @return The formatted string.
+    template<typename ... pargs_t>
+    static std::string
+    _GLIBCXX_NODISCARD
+    vcformat(std::string_view __fmt, const pargs_t&... __args)
+    {
+        thread_local format_cache<__detail::formatted_type_t<pargs_t>...> __cache(32);
+        return __cache.get(__fmt).format(__args...);
+    };
+    /// @brief Formats a wide string only known at runtime, compiled once per calling thread and address of the string.
+    template<typename ... pargs_t>
+    static std::wstring
+    _GLIBCXX_NODISCARD
+    wcformat(std::wstring_view __fmt, const pargs_t&... __args)
+    {
+        thread_local wformat_cache<__detail::formatted_type_t<pargs_t>...> __cache(32);
+        return __cache.get(__fmt).format(__args...);
     };
 
 
@@ -46,27 +3224,19 @@ namespace __gnu_cxx::v23 {
     /// @brief Formats a string (with a specified length).
     /// @tparam pargs_t A template for packed arguments (no va_args).
     /// @param __format The string that is going to be formatted.
-    /// @param __n The length of characters you want to format.
+    /// @param __n The size of the output (including a terminator, like snprintf), at most __n - 1 characters are kept.
     /// @param ...__args Virtual packed arguments to format.
     /// @return Returns a formatted string if the length isn't 0, otherwise it returns a empty string.
     template<typename ... pargs_t>
     static std::string
     _GLIBCXX_NODISCARD
-    vnformat(const std::string& __format, std::size_t __n, pargs_t... __args) 
+    vnformat(format_string<pargs_t...> __format, std::size_t __n, pargs_t&&... __args)
     {
-        /// Checking the length of the string.
-        if(auto sz = (std::size_t) std::snprintf( nullptr, 0, __format.c_str(), __args...) + 1; sz > 0 && __n != 0)
-        {
-            /// Initialize a temporary buffer.
-            std::unique_ptr<char[]> buf(new char[__n]);
-
-            /// Use std::snprintf() and return the string.
-            std::snprintf(buf.get(), __n, __format.c_str(), __args...);
-            return std::string(buf.get(), buf.get() + __n - 1);
-        }
-
-        ///  Return a empty string.
-        return std::string();
+        std::string __s;
+        if (__n != 0)
+            __detail::format_to_iterator_n<char>(std::back_inserter(__s), static_cast<std::ptrdiff_t>(__n - 1), __format.get(),
+                basic_format_args<char>(make_format_args(__args...)));
+        return __s;
     };
     /// @brief Formats a string.
     /// @tparam pargs_t A template for packed arguments (no va_args).
@@ -76,53 +3246,74 @@ namespace __gnu_cxx::v23 {
     template<typename ... pargs_t>
     static std::string
     _GLIBCXX_NODISCARD
-    vformat(const std::string __format, pargs_t... __args) 
+    vformat(format_string<pargs_t...> __format, pargs_t&&... __args)
     {
-        /// Checking the length of the string.
-        if(auto sz = (std::size_t) std::snprintf( nullptr, 0, __format.c_str(), __args...) + 1; sz > 0)
-        {
-            /// Initialize a temporary buffer.
-            std::unique_ptr<char[]> buf(new char[sz]);
-
-            /// Use std::snprintf() and return the string.
-            std::snprintf(buf.get(), sz, __format.c_str(), __args...);
-            return std::string(buf.get(), buf.get() + sz - 1);
-        }
-
-        ///  Return a empty string.
-        return std::string();
+        /// Format on the stack, the only allocation left is the string itself (none if it fits in SSO).
+        basic_memory_buffer<char> __buf;
+        __detail::vformat_to_buffer(__buf, __format.get(), basic_format_args<char>(make_format_args(__args...)));
+        __detail::count_string<char>(__buf.size());
+        return std::string(__buf.data(), __buf.size());
     };
     /// @brief Formats a string (with std::optional).
-    /// @return Returns a std::optional of the formatted string.
+    /// @return Returns a std::optional of the formatted string, std::nullopt if it is empty.
     template<typename ... pargs_t>
     static const std::optional<std::string>
-    _GLIBCXX_NODISCARD 
-    voformat(const std::string& __format, pargs_t... __args) 
+    _GLIBCXX_NODISCARD
+    voformat(format_string<pargs_t...> __format, pargs_t&&... __args)
     {
         /// Call vformat() and check if its 0.
-        auto s = vformat(__format, __args...);
+        auto s = vformat(__format, std::forward<pargs_t>(__args)...);
 
         /// If it is not 0 then we make a optional out of it and return it, otherwise we return std::nullopt.
-        return s.length() == 0 ? std::make_optional(s) : std::nullopt;
+        return s.length() != 0 ? std::make_optional(s) : std::nullopt;
     };
-    /// @brief Formats a string to a buffer.
+    /// @brief Formats a string to a buffer, replacing its contents.
     /// @param __buf The buffer to be formatted to.
     template<typename ... pargs_t>
-    static void 
-    vsformat(std::shared_ptr<std::string> __buf, const std::string& __format, pargs_t... __args) 
+    static void
+    vsformat(const std::shared_ptr<std::string>& __buf, format_string<pargs_t...> __format, pargs_t&&... __args)
     {
-        /// Wrapping the function, no need to overcomplicate things.
-        __buf = vformat(__format, __args...);
+        /// Reuse the capacity of the buffer, it only reallocates when a message is longer than any before it.
+        __buf->clear();
+        __detail::format_to_iterator<char>(std::back_inserter(*__buf), __format.get(), basic_format_args<char>(make_format_args(__args...)));
     };
-    /// @brief Formats a string to a buffer.
-    /// @param __n
+    /// @brief Formats a string to a buffer (with a specified length), replacing its contents.
     /// @param __buf The buffer to be formatted to.
+    /// @param __n The size of the output (including a terminator, like snprintf).
+    template<typename ... pargs_t>
+    static void
+    vsnformat(const std::shared_ptr<std::string>& __buf, format_string<pargs_t...> __format, std::size_t __n, pargs_t&&... __args)
+    {
+        /// Reuse the capacity of the buffer, keeping at most __n - 1 characters (like vnformat()).
+        __buf->clear();
+        if (__n != 0)
+            __detail::format_to_iterator_n<char>(std::back_inserter(*__buf), static_cast<std::ptrdiff_t>(__n - 1), __format.get(),
+                basic_format_args<char>(make_format_args(__args...)));
+    };
+    /// @brief Formats a string into a string of an allocator (carved from a request arena, say). Short messages are
+    ///     formatted on the stack, longer ones grow with the allocator, and the string takes a single allocation from it.
+    /// @param __alloc The allocator (of char).
+    /// @param __format The string that is going to be formatted.
+    /// @param ...__args Virtual packed arguments to format.
+    /// @return Returns the formatted string, which allocates with __alloc.
+    template<typename alloc_t, typename ... pargs_t>
+    static std::basic_string<char, std::char_traits<char>, alloc_t>
+    _GLIBCXX_NODISCARD
+    vformat(std::allocator_arg_t, const alloc_t& __alloc, format_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        basic_memory_buffer<char, 500, alloc_t> __buf(__alloc);
+        __detail::vformat_to_buffer(__buf, __format.get(), basic_format_args<char>(make_format_args(__args...)));
+        __detail::count_string<char>(__buf.size());
+        return std::basic_string<char, std::char_traits<char>, alloc_t>(__buf.data(), __buf.size(), __alloc);
+    };
+    /// @brief Formats a string into a string of a memory resource (a std::pmr::monotonic_buffer_resource, say).
+    /// @param __resource The memory resource.
     template<typename ... pargs_t>
-    static void 
-    vsnformat(std::shared_ptr<std::string> __buf, const std::string& __format, std::size_t __n, pargs_t... __args) 
+    static std::pmr::string
+    _GLIBCXX_NODISCARD
+    vformat(std::pmr::memory_resource* __resource, format_string<pargs_t...> __format, pargs_t&&... __args)
     {
-        /// Wrapping the function, no need to overcomplicate things.
-        __buf = vnformat(__format, __n, __args...);
+        return vformat(std::allocator_arg, std::pmr::polymorphic_allocator<char>(__resource), __format, std::forward<pargs_t>(__args)...);
     };
 
 
@@ -134,27 +3325,19 @@ namespace __gnu_cxx::v23 {
     /// @brief Formats a string (with a specified length).
     /// @tparam pargs_t A template for packed arguments (no va_args).
     /// @param __format The string that is going to be formatted.
-    /// @param __n The length of characters you want to format.
+    /// @param __n The size of the output (including a terminator, like swprintf), at most __n - 1 characters are kept.
     /// @param ...__args Virtual packed arguments to format.
     /// @return Returns a formatted string if the length isn't 0, otherwise it returns a empty string.
     template<typename ... pargs_t>
     static std::wstring
     _GLIBCXX_NODISCARD
-    wnformat(const std::wstring& __format, std::size_t __n, pargs_t... __args) 
+    wnformat(wformat_string<pargs_t...> __format, std::size_t __n, pargs_t&&... __args)
     {
-        /// Checking the length of the string.
-        if(auto sz = (std::size_t) std::swprintf( nullptr, 0, __format.c_str(), __args...) + 1; sz > 0 && __n != 0)
-        {
-            /// Initialize a temporary buffer.
-            std::unique_ptr<wchar_t[]> buf(new wchar_t[__n]);
-
-            /// Use std::snprintf() and return the string.
-            std::swprintf(buf.get(), __n, __format.c_str(), __args...);
-            return std::wstring(buf.get(), buf.get() + __n - 1);
-        }
-
-        ///  Return a empty string.
-        return std::wstring();
+        std::wstring __s;
+        if (__n != 0)
+            __detail::format_to_iterator_n<wchar_t>(std::back_inserter(__s), static_cast<std::ptrdiff_t>(__n - 1), __format.get(),
+                basic_format_args<wchar_t>(make_wformat_args(__args...)));
+        return __s;
     };
     /// @brief Formats a non-unicode string.
     /// @tparam pargs_t A template for packed arguments (no va_args).
@@ -164,52 +3347,73 @@ namespace __gnu_cxx::v23 {
     template<typename ... pargs_t>
     static std::wstring
     _GLIBCXX_NODISCARD
-    wformat(const std::wstring __format, pargs_t... __args) 
+    wformat(wformat_string<pargs_t...> __format, pargs_t&&... __args)
     {
-        /// Checking the length of the string.
-        if(auto sz = (std::size_t) std::swprintf( nullptr, 0, __format.c_str(), __args...) + 1; sz > 0)
-        {
-            /// Initialize a temporary buffer.
-            std::unique_ptr<wchar_t[]> buf(new wchar_t[sz]);
-
-            /// Use std::snprintf() and return the string.
-            std::swprintf(buf.get(), sz, __format.c_str(), __args...);
-            return std::wstring(buf.get(), buf.get() + sz - 1);
-        }
-
-        ///  Return a empty string.
-        return std::wstring();
+        /// Format on the stack, the only allocation left is the string itself (none if it fits in SSO).
+        basic_memory_buffer<wchar_t> __buf;
+        __detail::vformat_to_buffer(__buf, __format.get(), basic_format_args<wchar_t>(make_wformat_args(__args...)));
+        __detail::count_string<wchar_t>(__buf.size());
+        return std::wstring(__buf.data(), __buf.size());
     };
     /// @brief Formats a wstring (with std::optional).
-    /// @return Returns a std::optional of the formatted string.
+    /// @return Returns a std::optional of the formatted string, std::nullopt if it is empty.
     template<typename ... pargs_t>
     static const std::optional<std::wstring>
-    _GLIBCXX_NODISCARD 
-    woformat(const std::wstring& __format, pargs_t... __args) 
+    _GLIBCXX_NODISCARD
+    woformat(wformat_string<pargs_t...> __format, pargs_t&&... __args)
     {
-        /// Call vformat() and check if its 0.
-        auto s = vformat(__format, __args...);
+        /// Call wformat() and check if its 0.
+        auto s = wformat(__format, std::forward<pargs_t>(__args)...);
 
         /// If it is not 0 then we make a optional out of it and return it, otherwise we return std::nullopt.
-        return s.length() == 0 ? std::make_optional(s) : std::nullopt;
+        return s.length() != 0 ? std::make_optional(s) : std::nullopt;
     };
-    /// @brief Formats a wstring to a wide string buffer.
+    /// @brief Formats a wstring to a wide string buffer, replacing its contents.
     /// @param __buf The buffer to be formatted to.
     template<typename ... pargs_t>
-    static void 
-    wsformat(std::shared_ptr<std::wstring> __buf, const std::wstring& __format, pargs_t... __args) 
+    static void
+    wsformat(const std::shared_ptr<std::wstring>& __buf, wformat_string<pargs_t...> __format, pargs_t&&... __args)
     {
-        /// Wrapping the function, no need to overcomplicate things.
-        __buf = vformat(__format, __args...);
+        /// Reuse the capacity of the buffer, it only reallocates when a message is longer than any before it.
+        __buf->clear();
+        __detail::format_to_iterator<wchar_t>(std::back_inserter(*__buf), __format.get(), basic_format_args<wchar_t>(make_wformat_args(__args...)));
     };
-    /// @brief Formats a wstring to a wide string buffer.
-    /// @param __n
+    /// @brief Formats a wstring to a wide string buffer (with a specified length), replacing its contents.
     /// @param __buf The buffer to be formatted to.
+    /// @param __n The size of the output (including a terminator, like swprintf).
+    template<typename ... pargs_t>
+    static void
+    wsnformat(const std::shared_ptr<std::wstring>& __buf, wformat_string<pargs_t...> __format, std::size_t __n, pargs_t&&... __args)
+    {
+        /// Reuse the capacity of the buffer, keeping at most __n - 1 characters (like wnformat()).
+        __buf->clear();
+        if (__n != 0)
+            __detail::format_to_iterator_n<wchar_t>(std::back_inserter(*__buf), static_cast<std::ptrdiff_t>(__n - 1), __format.get(),
+                basic_format_args<wchar_t>(make_wformat_args(__args...)));
+    };
+    /// @brief Formats a string into a string of an allocator (carved from a request arena, say). Short messages are
+    ///     formatted on the stack, longer ones grow with the allocator, and the string takes a single allocation from it.
+    /// @param __alloc The allocator (of wchar_t).
+    /// @param __format The string that is going to be formatted.
+    /// @param ...__args Virtual packed arguments to format.
+    /// @return Returns the formatted string, which allocates with __alloc.
+    template<typename alloc_t, typename ... pargs_t>
+    static std::basic_string<wchar_t, std::char_traits<wchar_t>, alloc_t>
+    _GLIBCXX_NODISCARD
+    wformat(std::allocator_arg_t, const alloc_t& __alloc, wformat_string<pargs_t...> __format, pargs_t&&... __args)
+    {
+        basic_memory_buffer<wchar_t, 500, alloc_t> __buf(__alloc);
+        __detail::vformat_to_buffer(__buf, __format.get(), basic_format_args<wchar_t>(make_wformat_args(__args...)));
+        __detail::count_string<wchar_t>(__buf.size());
+        return std::basic_string<wchar_t, std::char_traits<wchar_t>, alloc_t>(__buf.data(), __buf.size(), __alloc);
+    };
+    /// @brief Formats a string into a string of a memory resource (a std::pmr::monotonic_buffer_resource, say).
+    /// @param __resource The memory resource.
     template<typename ... pargs_t>
-    static void 
-    wsnformat(std::shared_ptr<std::wstring> __buf, const std::wstring& __format, std::size_t __n, pargs_t... __args) 
+    static std::pmr::wstring
+    _GLIBCXX_NODISCARD
+    wformat(std::pmr::memory_resource* __resource, wformat_string<pargs_t...> __format, pargs_t&&... __args)
     {
-        /// Wrapping the function, no need to overcomplicate things.
-        __buf = vnformat(__format, __n, __args...);
+        return wformat(std::allocator_arg, std::pmr::polymorphic_allocator<wchar_t>(__resource), __format, std::forward<pargs_t>(__args)...);
     };
-};
\ No newline at end of file
+};
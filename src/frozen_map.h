@@ -0,0 +1,470 @@
+/**
+ * 
+ * 
+ *      @author  Sean Hobeck
+ *       @date 2023-02-24
+ * 
+ * 
+ **/
+#pragma once
+
+/// @uses: std::array, std::pair, std::string_view, std::sort, std::lower_bound, std::bit_ceil, std::out_of_range
+#include <bits/stdc++.h>
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+
+    namespace __detail {
+        /// @brief Mixes the bits of a word (the splitmix64 finalizer).
+        constexpr std::uint64_t frozen_mix(std::uint64_t _x) {
+            _x ^= _x >> 30;
+            _x *= 0xBF58476D1CE4E5B9ull;
+            _x ^= _x >> 27;
+            _x *= 0x94D049BB133111EBull;
+            return _x ^ (_x >> 31);
+        };
+    };
+
+    /// @brief The seeded hash of the frozen containers, usable in constant expressions (std::hash is not). Integral and
+    ///     enumeration keys, and strings (std::string_view, and whatever converts to one, like string literals).
+    template <typename k, typename = void>
+    struct frozen_hash;
+
+    template <typename k>
+    struct frozen_hash<k, std::enable_if_t<std::is_integral_v<k> || std::is_enum_v<k>>> {
+        constexpr std::uint64_t operator()(const k& _k, std::uint64_t _seed) const {
+            if constexpr (std::is_enum_v<k>)
+                return __detail::frozen_mix(static_cast<std::uint64_t>(static_cast<std::underlying_type_t<k>>(_k)) ^ _seed);
+            else
+                return __detail::frozen_mix(static_cast<std::uint64_t>(_k) ^ _seed);
+        };
+    };
+
+    template <>
+    struct frozen_hash<std::string_view> {
+        /// @brief FNV-1a over the characters, started from the seed and mixed at the end.
+        constexpr std::uint64_t operator()(std::string_view _k, std::uint64_t _seed) const {
+            std::uint64_t _h = 0xCBF29CE484222325ull ^ _seed;
+            for (char _c : _k)
+                _h = (_h ^ static_cast<unsigned char>(_c)) * 0x100000001B3ull;
+            return __detail::frozen_mix(_h);
+        };
+    };
+
+    namespace __detail {
+        /// @brief A perfect hash of N keys, built in a constant expression (hash and displace): the keys are hashed
+        ///     into N buckets, and the buckets, largest first, look for a seed that hashes all of their keys to free slots
+        ///     of the table. A bucket with one key takes a free slot directly. A lookup is two hashes and a key comparison.
+        /// @tparam N The amount of keys.
+        template <std::size_t N>
+        class perfect_hash {
+        public:
+
+            /// @brief The amount of slots, a power of two so a hash is reduced with a mask.
+            static constexpr std::size_t table_size = N == 0 ? 1 : std::bit_ceil(N);
+
+        private:
+
+            static constexpr std::size_t buckets = N == 0 ? 1 : N;
+
+            /// @brief Gets the bucket of a hash (the high half of a multiplication, which a division would cost more than).
+            static constexpr std::size_t bucket(std::uint64_t _h) {
+                return static_cast<std::size_t>((static_cast<unsigned __int128>(_h) * buckets) >> 64);
+            };
+
+            /// The seed that spreads the keys over the buckets.
+            std::uint64_t _seed = 0;
+            /// The seed of every bucket (or, below zero, the slot of its single key as -1 - slot).
+            std::array<std::int64_t, buckets> _displace{};
+            /// The index of the key of every slot (N for a free one).
+            std::array<std::size_t, table_size> _slots{};
+
+            /// @brief Tries to place every key with a bucket seed.
+            template <typename keys_t, typename hash_t>
+            constexpr bool build(const keys_t& _keys, const hash_t& _hash) {
+                std::array<std::size_t, N> _bucket_of{}, _order{};
+                std::array<std::size_t, buckets> _size{};
+                for (std::size_t _i = 0; _i < N; ++_i) {
+                    _bucket_of[_i] = bucket(_hash(_keys[_i], _seed));
+                    ++_size[_bucket_of[_i]];
+                    _order[_i] = _i;
+                }
+                /// The keys grouped by bucket, the largest buckets first.
+                std::sort(_order.begin(), _order.end(), [&](std::size_t _a, std::size_t _b) {
+                    auto _ba = _bucket_of[_a], _bb = _bucket_of[_b];
+                    return _size[_ba] != _size[_bb] ? _size[_ba] > _size[_bb] : _ba < _bb;
+                });
+
+                _slots.fill(N);
+                _displace.fill(0);
+                std::size_t _free = 0;
+                for (std::size_t _b = 0; _b < N; ) {
+                    auto _bucket = _bucket_of[_order[_b]];
+                    auto _n = _size[_bucket];
+                    if (_n == 1) {
+                        while (_slots[_free] != N)
+                            ++_free;
+                        _slots[_free] = _order[_b];
+                        _displace[_bucket] = -1 - static_cast<std::int64_t>(_free);
+                        ++_b;
+                        continue;
+                    }
+                    /// Seeds are tried until the keys of the bucket land on distinct free slots.
+                    std::int64_t _d = 1;
+                    for (;; ++_d) {
+                        if (_d > 1 << 20)
+                            return false;
+                        std::array<std::size_t, N> _taken{};
+                        bool _fits = true;
+                        for (std::size_t _j = 0; _j < _n && _fits; ++_j) {
+                            auto _s = static_cast<std::size_t>(_hash(_keys[_order[_b + _j]], static_cast<std::uint64_t>(_d))) & (table_size - 1);
+                            _fits = _slots[_s] == N;
+                            for (std::size_t _t = 0; _t < _j && _fits; ++_t)
+                                _fits = _taken[_t] != _s;
+                            _taken[_j] = _s;
+                        }
+                        if (!_fits)
+                            continue;
+                        for (std::size_t _j = 0; _j < _n; ++_j)
+                            _slots[_taken[_j]] = _order[_b + _j];
+                        break;
+                    }
+                    _displace[_bucket] = _d;
+                    _b += _n;
+                }
+                return true;
+            };
+
+        public:
+
+            /// @brief Constructor, builds the hash of a set of unique keys.
+            /// @param _keys The keys (indexable).
+            /// @param _hash The seeded hash.
+            template <typename keys_t, typename hash_t>
+            constexpr perfect_hash(const keys_t& _keys, const hash_t& _hash) {
+                for (std::uint64_t _s = 0;; ++_s) {
+                    _seed = frozen_mix(_s + 1);
+                    if (build(_keys, _hash))
+                        return;
+                    if (_s == 64)
+                        throw std::logic_error("perfect_hash: no perfect hash found");
+                }
+            };
+
+            /// @brief Gets the index of the only key that can equal a key (the caller compares them).
+            /// @return The index, or N if no key can.
+            template <typename q, typename hash_t>
+            constexpr std::size_t index(const q& _k, const hash_t& _hash) const {
+                if constexpr (N == 0)
+                    return 0;
+                else {
+                    auto _d = _displace[bucket(_hash(_k, _seed))];
+                    auto _s = _d < 0 ? static_cast<std::size_t>(-1 - _d)
+                                     : static_cast<std::size_t>(_hash(_k, static_cast<std::uint64_t>(_d))) & (table_size - 1);
+                    return _slots[_s];
+                }
+            };
+        };
+    };
+
+    /// @brief Frozen flat map, a map built entirely at compile time: the elements are sorted (for ordered iteration and
+    ///     the bounds) and indexed by a perfect hash (for lookups in constant time), and a constexpr instance lives in
+    ///     read-only data with nothing to construct at startup. Duplicate keys fail to compile.
+    /// @tparam k Key typename.
+    /// @tparam v Value typename.
+    /// @tparam N The amount of elements.
+    /// @tparam hash_t Seeded hash typename, (key, std::uint64_t seed) -> std::uint64_t.
+    /// @tparam k_compare Key comparison typename.
+    template <typename k, typename v, std::size_t N,
+        typename hash_t = frozen_hash<k>,
+        typename k_compare = std::less<>>
+    class frozen_flat_map {
+    public:
+
+        using key_type = k;
+        using mapped_type = v;
+        using value_type = std::pair<k, v>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using const_reference = const value_type&;
+        using iterator = const value_type*;
+        using const_iterator = const value_type*;
+
+    private:
+
+        /// The elements, sorted by key.
+        std::array<value_type, N> _items;
+        /// Key comparison.
+        [[no_unique_address]] k_compare _cmp;
+        /// Seeded hash.
+        [[no_unique_address]] hash_t _hash;
+        /// The perfect hash of the keys.
+        __detail::perfect_hash<N> _index;
+
+        static constexpr std::array<value_type, N> sorted(std::array<value_type, N> _e, const k_compare& _c) {
+            std::sort(_e.begin(), _e.end(), [&](const auto& _a, const auto& _b) { return _c(_a.first, _b.first); });
+            for (std::size_t _i = 1; _i < N; ++_i)
+                if (!_c(_e[_i - 1].first, _e[_i].first))
+                    throw std::invalid_argument("frozen_flat_map: duplicate key");
+            return _e;
+        };
+
+        struct key_view {
+            const std::array<value_type, N>& _e;
+            constexpr const k& operator[](std::size_t _i) const { return _e[_i].first; };
+        };
+
+    public:
+
+        /// @brief Constructor, from the elements in any order.
+        /// @param _e The elements.
+        /// @param _h The seeded hash.
+        /// @param _c The key comparison.
+        constexpr frozen_flat_map(const std::array<value_type, N>& _e, const hash_t& _h = hash_t(), const k_compare& _c = k_compare())
+            : _items(sorted(_e, _c)), _cmp(_c), _hash(_h), _index(key_view{ _items }, _h) { };
+
+
+        ///------------- @section Member functions. -------------///
+
+
+        /// @brief Finding the element of a key.
+        /// @param _k The key (or anything the hash and comparison take, like a string literal for std::string_view keys).
+        /// @return The element, or end().
+        template <typename q>
+        constexpr const_iterator find(const q& _k) const {
+            auto _i = _index.index(_k, _hash);
+            return _i < N && !_cmp(_items[_i].first, _k) && !_cmp(_k, _items[_i].first) ? _items.data() + _i : end();
+        };
+        constexpr const_iterator find(const k& _k) const {
+            return find<k>(_k);
+        };
+
+        /// @brief Checking if the map contains a key.
+        template <typename q>
+        constexpr bool contains(const q& _k) const {
+            return find(_k) != end();
+        };
+        constexpr bool contains(const k& _k) const {
+            return find(_k) != end();
+        };
+
+        /// @brief Counting the elements of a key (0 or 1).
+        template <typename q>
+        constexpr std::size_t count(const q& _k) const {
+            return contains(_k) ? 1 : 0;
+        };
+
+        /// @brief Get the value of a key.
+        /// @return The value, throws std::out_of_range if the key does not exist (a compile error in a constant expression).
+        template <typename q>
+        constexpr const v& at(const q& _k) const {
+            auto _it = find(_k);
+            if (_it == end())
+                throw std::out_of_range("frozen_flat_map::at: key not found");
+            return _it->second;
+        };
+        constexpr const v& at(const k& _k) const {
+            return at<k>(_k);
+        };
+
+        /// @brief Finding the first element whose key is not less than a key.
+        template <typename q>
+        constexpr const_iterator lower_bound(const q& _k) const {
+            return std::lower_bound(begin(), end(), _k, [&](const value_type& _e, const q& _q) { return _cmp(_e.first, _q); });
+        };
+
+        /// @brief Finding the first element whose key is greater than a key.
+        template <typename q>
+        constexpr const_iterator upper_bound(const q& _k) const {
+            return std::upper_bound(begin(), end(), _k, [&](const q& _q, const value_type& _e) { return _cmp(_q, _e.first); });
+        };
+
+        /// @brief Get the size of the map.
+        constexpr std::size_t size() const {
+            return N;
+        };
+
+        /// @brief Checking if the map is empty.
+        constexpr bool empty() const {
+            return N == 0;
+        };
+
+
+        ///------------- @section Operator functions. -------------///
+
+
+        /// @brief Get the value of a key, throws std::out_of_range if the key does not exist.
+        template <typename q>
+        constexpr const v& operator[](const q& _k) const {
+            return at(_k);
+        };
+        constexpr const v& operator[](const k& _k) const {
+            return at(_k);
+        };
+
+
+        ///------------- @section Container functions. -------------///
+
+
+        /// @brief Get the begin iterator of the map (the elements in key order).
+        constexpr const_iterator begin() const {
+            return _items.data();
+        };
+
+        /// @brief Get the end iterator of the map.
+        constexpr const_iterator end() const {
+            return _items.data() + N;
+        };
+
+        constexpr const_iterator cbegin() const {
+            return begin();
+        };
+        constexpr const_iterator cend() const {
+            return end();
+        };
+    };
+
+    /// @brief Frozen flat set, the keys of a frozen_flat_map without values.
+    /// @tparam k Key typename.
+    /// @tparam N The amount of keys.
+    /// @tparam hash_t Seeded hash typename, (key, std::uint64_t seed) -> std::uint64_t.
+    /// @tparam k_compare Key comparison typename.
+    template <typename k, std::size_t N,
+        typename hash_t = frozen_hash<k>,
+        typename k_compare = std::less<>>
+    class frozen_flat_set {
+    public:
+
+        using key_type = k;
+        using value_type = k;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using const_reference = const k&;
+        using iterator = const k*;
+        using const_iterator = const k*;
+
+    private:
+
+        /// The keys, sorted.
+        std::array<k, N> _keys;
+        /// Key comparison.
+        [[no_unique_address]] k_compare _cmp;
+        /// Seeded hash.
+        [[no_unique_address]] hash_t _hash;
+        /// The perfect hash of the keys.
+        __detail::perfect_hash<N> _index;
+
+        static constexpr std::array<k, N> sorted(std::array<k, N> _e, const k_compare& _c) {
+            std::sort(_e.begin(), _e.end(), _c);
+            for (std::size_t _i = 1; _i < N; ++_i)
+                if (!_c(_e[_i - 1], _e[_i]))
+                    throw std::invalid_argument("frozen_flat_set: duplicate key");
+            return _e;
+        };
+
+    public:
+
+        /// @brief Constructor, from the keys in any order.
+        /// @param _e The keys.
+        /// @param _h The seeded hash.
+        /// @param _c The key comparison.
+        constexpr frozen_flat_set(const std::array<k, N>& _e, const hash_t& _h = hash_t(), const k_compare& _c = k_compare())
+            : _keys(sorted(_e, _c)), _cmp(_c), _hash(_h), _index(_keys, _h) { };
+
+
+        ///------------- @section Member functions. -------------///
+
+
+        /// @brief Finding a key.
+        /// @return The key, or end().
+        template <typename q>
+        constexpr const_iterator find(const q& _k) const {
+            auto _i = _index.index(_k, _hash);
+            return _i < N && !_cmp(_keys[_i], _k) && !_cmp(_k, _keys[_i]) ? _keys.data() + _i : end();
+        };
+        constexpr const_iterator find(const k& _k) const {
+            return find<k>(_k);
+        };
+
+        /// @brief Checking if the set contains a key.
+        template <typename q>
+        constexpr bool contains(const q& _k) const {
+            return find(_k) != end();
+        };
+        constexpr bool contains(const k& _k) const {
+            return find(_k) != end();
+        };
+
+        /// @brief Counting a key (0 or 1).
+        template <typename q>
+        constexpr std::size_t count(const q& _k) const {
+            return contains(_k) ? 1 : 0;
+        };
+
+        /// @brief Finding the first key not less than a key.
+        template <typename q>
+        constexpr const_iterator lower_bound(const q& _k) const {
+            return std::lower_bound(begin(), end(), _k, _cmp);
+        };
+
+        /// @brief Finding the first key greater than a key.
+        template <typename q>
+        constexpr const_iterator upper_bound(const q& _k) const {
+            return std::upper_bound(begin(), end(), _k, _cmp);
+        };
+
+        /// @brief Get the size of the set.
+        constexpr std::size_t size() const {
+            return N;
+        };
+
+        /// @brief Checking if the set is empty.
+        constexpr bool empty() const {
+            return N == 0;
+        };
+
+
+        ///------------- @section Container functions. -------------///
+
+
+        /// @brief Get the begin iterator of the set (the keys in order).
+        constexpr const_iterator begin() const {
+            return _keys.data();
+        };
+
+        /// @brief Get the end iterator of the set.
+        constexpr const_iterator end() const {
+            return _keys.data() + N;
+        };
+
+        constexpr const_iterator cbegin() const {
+            return begin();
+        };
+        constexpr const_iterator cend() const {
+            return end();
+        };
+    };
+
+    /// @brief Makes a frozen_flat_map from a list of key-value pairs, the size is deduced. In a constexpr variable the
+    ///     table is built by the compiler:
+    ///     constexpr auto opcodes = make_frozen_map<std::string_view, int>({ { "add", 1 }, { "sub", 2 } });
+    /// @param _e The elements.
+    template <typename k, typename v, typename hash_t = frozen_hash<k>, typename k_compare = std::less<>, std::size_t N>
+    constexpr frozen_flat_map<k, v, N, hash_t, k_compare> make_frozen_map(const std::pair<k, v> (&_e)[N]) {
+        std::array<std::pair<k, v>, N> _a{};
+        for (std::size_t _i = 0; _i < N; ++_i)
+            _a[_i] = _e[_i];
+        return frozen_flat_map<k, v, N, hash_t, k_compare>(_a);
+    };
+
+    /// @brief Makes a frozen_flat_set from a list of keys, the size is deduced.
+    /// @param _e The keys.
+    template <typename k, typename hash_t = frozen_hash<k>, typename k_compare = std::less<>, std::size_t N>
+    constexpr frozen_flat_set<k, N, hash_t, k_compare> make_frozen_set(const k (&_e)[N]) {
+        std::array<k, N> _a{};
+        for (std::size_t _i = 0; _i < N; ++_i)
+            _a[_i] = _e[_i];
+        return frozen_flat_set<k, N, hash_t, k_compare>(_a);
+    };
+};
@@ -0,0 +1,496 @@
+/**
+ *
+ *
+ *      @author  Sean Hobeck
+ *       @date 2023-02-23
+ *
+ *
+ **/
+#pragma once
+
+/// @uses: std::atomic, std::memory_order_relaxed
+#include <atomic>
+
+/// @uses: std::uint64_t
+#include <cstdint>
+
+/// @uses: std::string
+#include <string>
+
+/// @uses: std::basic_string_view
+#include <string_view>
+
+/// @uses: std::make_unsigned_t
+#include <type_traits>
+
+/// @uses: std::vector
+#include <vector>
+
+/// @uses: std::unordered_map
+#include <unordered_map>
+
+/// @uses: std::mutex, std::lock_guard, std::unique_lock
+#include <mutex>
+
+/// @uses: std::condition_variable
+#include <condition_variable>
+
+/// @uses: std::thread
+#include <thread>
+
+/// @uses: std::function, std::equal_to, std::hash
+#include <functional>
+
+/// @uses: std::chrono::milliseconds
+#include <chrono>
+
+/// @uses: std::sort, std::find
+#include <algorithm>
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+    /// @brief Whether formatting and printing count what they do (see snapshot_counters()).
+    ///     Defining V23_INSTRUMENT before including format.h (the same way in every translation unit) turns the counters
+    ///     on, otherwise every counting call compiles to nothing.
+#ifdef V23_INSTRUMENT
+    inline constexpr bool instrumentation_enabled = true;
+#else
+    inline constexpr bool instrumentation_enabled = false;
+#endif
+
+    /// @brief What formatting and printing did, over every thread.
+    struct format_counters
+    {
+        /// Formatting calls (vformat, wformat, format_to, print, ... every one of them formats once).
+        std::uint64_t format_calls = 0;
+        /// Print calls (print, println, vprint, ... and prints to an output_file).
+        std::uint64_t print_calls = 0;
+        /// Characters formatted.
+        std::uint64_t bytes_formatted = 0;
+        /// Heap allocations: format buffers outgrowing their storage and formatted strings outgrowing SSO.
+        std::uint64_t allocations = 0;
+        /// Format buffers growing (reallocating, or a container being resized).
+        std::uint64_t buffer_grows = 0;
+        /// Buffers of output files written out.
+        std::uint64_t flushes = 0;
+        /// write(2) calls.
+        std::uint64_t writes = 0;
+        /// Bytes written by write(2).
+        std::uint64_t bytes_written = 0;
+
+        /// @brief Adds up two sets of counters.
+        format_counters& operator+=(const format_counters& __o) noexcept
+        {
+            format_calls += __o.format_calls;
+            print_calls += __o.print_calls;
+            bytes_formatted += __o.bytes_formatted;
+            allocations += __o.allocations;
+            buffer_grows += __o.buffer_grows;
+            flushes += __o.flushes;
+            writes += __o.writes;
+            bytes_written += __o.bytes_written;
+            return *this;
+        };
+
+        /// @brief Gets what was counted between two snapshots.
+        friend format_counters operator-(format_counters __a, const format_counters& __b) noexcept
+        {
+            __a.format_calls -= __b.format_calls;
+            __a.print_calls -= __b.print_calls;
+            __a.bytes_formatted -= __b.bytes_formatted;
+            __a.allocations -= __b.allocations;
+            __a.buffer_grows -= __b.buffer_grows;
+            __a.flushes -= __b.flushes;
+            __a.writes -= __b.writes;
+            __a.bytes_written -= __b.bytes_written;
+            return __a;
+        };
+
+        bool operator==(const format_counters&) const = default;
+    };
+
+    /// @brief What was written to a file descriptor (by output files).
+    struct stream_counters
+    {
+        /// The file descriptor.
+        int descriptor = -1;
+        /// Buffers written out.
+        std::uint64_t flushes = 0;
+        /// write(2) calls.
+        std::uint64_t writes = 0;
+        /// Bytes written.
+        std::uint64_t bytes_written = 0;
+    };
+
+    /// @brief What was formatted with a format string.
+    struct call_site_counters
+    {
+        /// The format string (wide ones with anything past ASCII replaced by '?').
+        std::string format;
+        /// Formatting calls.
+        std::uint64_t calls = 0;
+        /// Characters formatted.
+        std::uint64_t bytes = 0;
+    };
+
+    /// @brief The counters of every thread added up, see snapshot_counters().
+    struct counters_snapshot
+    {
+        /// The totals.
+        format_counters totals;
+        /// Per file descriptor, ordered by descriptor.
+        std::vector<stream_counters> streams;
+        /// Per format string, the most characters formatted first.
+        std::vector<call_site_counters> call_sites;
+    };
+
+
+    namespace __detail {
+        /// @brief The counters kept per thread, in the order of format_counters.
+        enum counter_id : unsigned char
+        {
+            counter_format_calls, counter_print_calls, counter_bytes_formatted, counter_allocations,
+            counter_buffer_grows, counter_flushes, counter_writes, counter_bytes_written, counter_count
+        };
+
+        /// @brief Adds to a counter only its thread writes to, a plain load and store (other threads only read it).
+        inline void
+        bump(std::atomic<std::uint64_t>& __c, std::uint64_t __n) noexcept
+        {
+            __c.store(__c.load(std::memory_order_relaxed) + __n, std::memory_order_relaxed);
+        };
+
+        /// @brief The counters of a format string on a thread.
+        struct site_counters
+        {
+            std::string _format;
+            std::atomic<std::uint64_t> _calls = 0;
+            std::atomic<std::uint64_t> _bytes = 0;
+        };
+
+        /// @brief The counters of a file descriptor on a thread.
+        struct fd_counters
+        {
+            std::atomic<std::uint64_t> _flushes = 0;
+            std::atomic<std::uint64_t> _writes = 0;
+            std::atomic<std::uint64_t> _bytes = 0;
+        };
+
+        /// @brief Hash of the key of a format string, its code units as bytes. The key is the text and not the address:
+        ///     runtime strings come and go at changing addresses, and an address can be reused by another text.
+        ///     Transparent, so a format string is looked up as a std::string_view without a copy.
+        struct site_key_hash
+        {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view __k) const noexcept { return std::hash<std::string_view>()(__k); };
+        };
+
+        /// The amount of format strings counted per thread, the ones past it are counted together as "(other)".
+        inline constexpr std::size_t max_call_sites = 1024;
+
+        class thread_counters;
+
+        /// @brief The live threads and what the ones that exited counted.
+        struct counter_registry
+        {
+            std::mutex _lock;
+            std::vector<thread_counters*> _threads;
+            format_counters _retired;
+            std::unordered_map<int, stream_counters> _retired_streams;
+            std::unordered_map<std::string, call_site_counters> _retired_sites;
+        };
+
+        /// @brief Gets the registry (constructed before the first thread registers, so it outlives them all).
+        inline counter_registry&
+        registry()
+        {
+            static counter_registry __r;
+            return __r;
+        };
+
+        /// @brief The counters of a thread, registered while the thread lives.
+        ///     Only the thread writes to them, the maps only change under _lock (snapshots read them under it too).
+        class thread_counters
+        {
+        public:
+
+            /// The counters, indexed by counter_id.
+            std::atomic<std::uint64_t> _values[counter_count] = { };
+            /// Characters flushed out of format buffers by the thread so far, to count the characters of a formatting
+            /// call into a buffer that flushes (only read by the thread itself).
+            std::uint64_t _flushed = 0;
+            /// Per format string, by its code units as bytes.
+            std::unordered_map<std::string, site_counters, site_key_hash, std::equal_to<>> _sites;
+            /// Per file descriptor.
+            std::unordered_map<int, fd_counters> _fds;
+            /// Guards inserting into the maps.
+            std::mutex _lock;
+
+            thread_counters()
+            {
+                auto& __r = registry();
+                std::lock_guard __l(__r._lock);
+                __r._threads.push_back(this);
+            };
+
+            /// @brief Destructor, hands what the thread counted over to the registry.
+            ~thread_counters()
+            {
+                auto& __r = registry();
+                std::lock_guard __l(__r._lock);
+                __r._threads.erase(std::find(__r._threads.begin(), __r._threads.end(), this));
+                add_to(__r._retired, __r._retired_streams, __r._retired_sites);
+            };
+
+            thread_counters(const thread_counters&) = delete;
+            thread_counters& operator=(const thread_counters&) = delete;
+
+            /// @brief Adds the counters to a snapshot (the registry lock is held).
+            void add_to(format_counters& __totals, std::unordered_map<int, stream_counters>& __streams,
+                std::unordered_map<std::string, call_site_counters>& __sites)
+            {
+                auto __v = [&](counter_id __c) { return _values[__c].load(std::memory_order_relaxed); };
+                __totals += format_counters { __v(counter_format_calls), __v(counter_print_calls), __v(counter_bytes_formatted),
+                    __v(counter_allocations), __v(counter_buffer_grows), __v(counter_flushes), __v(counter_writes),
+                    __v(counter_bytes_written) };
+
+                std::lock_guard __l(_lock);
+                for (auto& [__fd, __c] : _fds)
+                {
+                    auto& __s = __streams[__fd];
+                    __s.descriptor = __fd;
+                    __s.flushes += __c._flushes.load(std::memory_order_relaxed);
+                    __s.writes += __c._writes.load(std::memory_order_relaxed);
+                    __s.bytes_written += __c._bytes.load(std::memory_order_relaxed);
+                }
+                for (auto& [__k, __c] : _sites)
+                {
+                    auto& __s = __sites[__c._format];
+                    __s.format = __c._format;
+                    __s.calls += __c._calls.load(std::memory_order_relaxed);
+                    __s.bytes += __c._bytes.load(std::memory_order_relaxed);
+                }
+            };
+        };
+
+        /// @brief Gets the counters of the calling thread.
+        inline thread_counters&
+        this_thread_counters()
+        {
+            thread_local thread_counters __c;
+            return __c;
+        };
+
+        /// @brief Counts something.
+        /// @param __c The counter.
+        /// @param __n The amount.
+        inline void
+        count(counter_id __c, std::uint64_t __n = 1) noexcept
+        {
+            if constexpr (instrumentation_enabled)
+                bump(this_thread_counters()._values[__c], __n);
+        };
+
+        /// @brief Counts characters flushed out of a format buffer (before its size is reset).
+        /// @param __n The amount of characters.
+        inline void
+        count_flushed(std::size_t __n) noexcept
+        {
+            if constexpr (instrumentation_enabled)
+                this_thread_counters()._flushed += __n;
+        };
+
+        /// @brief Gets the amount of characters formatted into a buffer so far, see count_format().
+        /// @param __size The current size of the buffer.
+        inline std::uint64_t
+        format_mark(std::size_t __size) noexcept
+        {
+            if constexpr (instrumentation_enabled)
+                return this_thread_counters()._flushed + __size;
+            else
+                return 0;
+        };
+
+        /// @brief Counts a formatting call.
+        /// @param __fmt The format string.
+        /// @param __begin The format_mark() before the call.
+        /// @param __size The size of the buffer after the call.
+        template<typename char_t>
+        inline void
+        count_format(std::basic_string_view<char_t> __fmt, std::uint64_t __begin, std::size_t __size) noexcept
+        {
+            if constexpr (instrumentation_enabled)
+            {
+                auto& __t = this_thread_counters();
+                auto __bytes = __t._flushed + __size - __begin;
+                bump(__t._values[counter_format_calls], 1);
+                bump(__t._values[counter_bytes_formatted], __bytes);
+
+                std::string_view __key(reinterpret_cast<const char*>(__fmt.data()), __fmt.size() * sizeof(char_t));
+                auto __it = __t._sites.find(__key);
+                if (__it == __t._sites.end())
+                {
+                    try
+                    {
+                        std::string __s;
+                        if (__t._sites.size() + 1 < max_call_sites)
+                            for (auto __c : __fmt)
+                                __s.push_back(static_cast<std::make_unsigned_t<char_t>>(__c) < 0x80 ? static_cast<char>(__c) : '?');
+                        else
+                            __key = __s = "(other)";
+                        if (__it = __t._sites.find(__key); __it == __t._sites.end())
+                        {
+                            std::lock_guard __l(__t._lock);
+                            __it = __t._sites.try_emplace(std::string(__key)).first;
+                            __it->second._format = std::move(__s);
+                        }
+                    }
+                    catch (...) { return; }
+                }
+                bump(__it->second._calls, 1);
+                bump(__it->second._bytes, __bytes);
+            }
+        };
+
+        /// @brief Counts a string being made out of formatted characters (an allocation once it outgrows SSO).
+        /// @param __size The amount of characters.
+        template<typename char_t>
+        inline void
+        count_string(std::size_t __size) noexcept
+        {
+            if constexpr (instrumentation_enabled)
+                if (__size > std::basic_string<char_t>().capacity())
+                    count(counter_allocations);
+        };
+
+        /// @brief Gets the counters of a file descriptor on the calling thread (nullptr if it can't be added).
+        inline fd_counters*
+        this_thread_fd(thread_counters& __t, int __fd) noexcept
+        {
+            if (auto __it = __t._fds.find(__fd); __it != __t._fds.end())
+                return &__it->second;
+            try
+            {
+                std::lock_guard __l(__t._lock);
+                return &__t._fds[__fd];
+            }
+            catch (...) { return nullptr; }
+        };
+
+        /// @brief Counts a write(2) call.
+        /// @param __fd The file descriptor.
+        /// @param __n The amount of bytes it wrote.
+        /// @param __flush Whether it is the first write of a flush.
+        inline void
+        count_write(int __fd, std::size_t __n, bool __flush) noexcept
+        {
+            if constexpr (instrumentation_enabled)
+            {
+                auto& __t = this_thread_counters();
+                bump(__t._values[counter_writes], 1);
+                bump(__t._values[counter_bytes_written], __n);
+                if (__flush)
+                    bump(__t._values[counter_flushes], 1);
+                if (auto* __c = this_thread_fd(__t, __fd); __c != nullptr)
+                {
+                    bump(__c->_writes, 1);
+                    bump(__c->_bytes, __n);
+                    if (__flush)
+                        bump(__c->_flushes, 1);
+                }
+            }
+        };
+    };
+
+
+    /// @brief Adds up the counters of every thread (the ones that exited included).
+    ///     Counters another thread is updating may be a call behind, every counter is exact once the thread is done.
+    ///     Without V23_INSTRUMENT everything is 0.
+    /// @return The snapshot.
+    inline counters_snapshot
+    snapshot_counters()
+    {
+        counters_snapshot __s;
+        if constexpr (instrumentation_enabled)
+        {
+            auto& __r = __detail::registry();
+            std::unordered_map<int, stream_counters> __streams;
+            std::unordered_map<std::string, call_site_counters> __sites;
+            {
+                std::lock_guard __l(__r._lock);
+                __s.totals = __r._retired;
+                __streams = __r._retired_streams;
+                __sites = __r._retired_sites;
+                for (auto* __t : __r._threads)
+                    __t->add_to(__s.totals, __streams, __sites);
+            }
+            for (auto& [__fd, __c] : __streams)
+                __s.streams.push_back(__c);
+            std::sort(__s.streams.begin(), __s.streams.end(), [](const auto& __a, const auto& __b) { return __a.descriptor < __b.descriptor; });
+            for (auto& [__f, __c] : __sites)
+                __s.call_sites.push_back(std::move(__c));
+            std::sort(__s.call_sites.begin(), __s.call_sites.end(), [](const auto& __a, const auto& __b)
+                { return __a.bytes != __b.bytes ? __a.bytes > __b.bytes : __a.calls > __b.calls; });
+        }
+        return __s;
+    };
+
+    /// @brief Hands a snapshot of the counters to a function periodically, from a thread of its own, and once more when
+    ///     it is destroyed (so the last one covers everything up to then).
+    class counters_reporter
+    {
+    private:
+
+        /// The function.
+        std::function<void(const counters_snapshot&)> _hook;
+        /// The time between two snapshots.
+        std::chrono::milliseconds _period;
+        /// Guards _stop.
+        std::mutex _lock;
+        /// Wakes the thread up to stop.
+        std::condition_variable _wake;
+        /// Whether the thread stops.
+        bool _stop = false;
+        /// The thread.
+        std::thread _thread;
+
+        void run()
+        {
+            std::unique_lock __l(_lock);
+            while (!_wake.wait_for(__l, _period, [this]() { return _stop; }))
+            {
+                __l.unlock();
+                _hook(snapshot_counters());
+                __l.lock();
+            }
+        };
+
+    public:
+
+        /// @brief Constructor, starts the thread.
+        /// @param __period The time between two snapshots.
+        /// @param __hook The function, gets a const counters_snapshot&.
+        counters_reporter(std::chrono::milliseconds __period, std::function<void(const counters_snapshot&)> __hook)
+            : _hook(std::move(__hook)), _period(__period)
+        {
+            _thread = std::thread([this]() { run(); });
+        };
+
+        /// @brief Destructor, stops the thread and hands over a last snapshot.
+        ~counters_reporter()
+        {
+            {
+                std::lock_guard __l(_lock);
+                _stop = true;
+            }
+            _wake.notify_one();
+            _thread.join();
+            _hook(snapshot_counters());
+        };
+
+        counters_reporter(const counters_reporter&) = delete;
+        counters_reporter& operator=(const counters_reporter&) = delete;
+    };
+};
@@ -0,0 +1,517 @@
+/**
+ * 
+ * 
+ *      @author  Sean Hobeck
+ *       @date 2023-02-22
+ * 
+ * 
+ **/
+#pragma once
+
+/// @uses: std::span, std::runtime_error, std::system_error, std::generic_category, std::memcpy
+#include <bits/stdc++.h>
+
+/// @uses: open, O_RDONLY, O_WRONLY, O_CREAT, O_TRUNC, O_CLOEXEC
+#include <fcntl.h>
+
+/// @uses: mmap, munmap, madvise, PROT_READ, MAP_SHARED, MADV_WILLNEED
+#include <sys/mman.h>
+
+/// @uses: fstat
+#include <sys/stat.h>
+
+/// @uses: write, pwrite, close, fsync, unlink
+#include <unistd.h>
+
+/// @uses: flat_map, __detail::flat_map_iterator, __detail::integral_search
+#include "flat_map.h"
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+
+    /// @brief Error for a mapped flat map file that is not one, is damaged, or holds other types.
+    class mapped_file_error : public std::runtime_error {
+    public:
+
+        explicit mapped_file_error(const char* _what) : std::runtime_error(_what) { };
+    };
+
+    /// @brief How much of a mapped flat map file is checked when it is opened.
+    enum class map_verify {
+        /// The header only (its checksum, the types and the layout), without touching the keys and values.
+        header,
+        /// The checksums of the keys and values as well, which reads the whole file.
+        full
+    };
+
+    namespace __detail {
+        /// @brief The header of a mapped flat map file, in the byte order of the machine that wrote it. The keys follow at
+        ///     _keys_offset and the values at _values_offset, both aligned to map_file_alignment.
+        struct map_file_header {
+            char _magic[8];
+            std::uint32_t _byte_order;
+            std::uint32_t _version;
+            std::uint32_t _key_size, _key_align;
+            std::uint32_t _value_size, _value_align;
+            std::uint64_t _count;
+            std::uint64_t _keys_offset, _values_offset, _file_size;
+            std::uint64_t _keys_checksum, _values_checksum;
+            std::uint64_t _header_checksum;
+        };
+
+        inline constexpr char map_file_magic[8] = { 'v', '2', '3', 'f', 'm', 'a', 'p', '\0' };
+        inline constexpr std::uint32_t map_file_byte_order = 0x01020304;
+        inline constexpr std::uint32_t map_file_version = 1;
+        /// @brief The alignment of the arrays in the file (a cache line, and more than any key or value needs).
+        inline constexpr std::size_t map_file_alignment = 64;
+
+        /// @brief Checksums bytes, 8 at a time over four independent lanes (so it runs at memory speed), folded at the end.
+        ///     It catches damaged and truncated files, it is not meant to resist deliberate tampering.
+        class map_checksum {
+        private:
+
+            std::uint64_t _lanes[4] = { 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x27D4EB2F165667C5ull };
+            /// Bytes that do not fill a word yet.
+            unsigned char _tail[32];
+            std::size_t _tail_size = 0, _total = 0;
+
+            static std::uint64_t round(std::uint64_t _h, std::uint64_t _w) {
+                _h ^= _w * 0x9E3779B97F4A7C15ull;
+                return std::rotl(_h, 31) * 0xC2B2AE3D27D4EB4Full;
+            };
+
+            void block(const unsigned char* _p) {
+                for (std::size_t _l = 0; _l < 4; ++_l) {
+                    std::uint64_t _w;
+                    std::memcpy(&_w, _p + _l * 8, 8);
+                    _lanes[_l] = round(_lanes[_l], _w);
+                }
+            };
+
+        public:
+
+            /// @brief Adds bytes.
+            void update(const void* _data, std::size_t _n) {
+                auto* _p = static_cast<const unsigned char*>(_data);
+                _total += _n;
+                if (_tail_size != 0) {
+                    auto _take = std::min(_n, sizeof(_tail) - _tail_size);
+                    std::memcpy(_tail + _tail_size, _p, _take);
+                    _tail_size += _take;
+                    _p += _take;
+                    _n -= _take;
+                    if (_tail_size < sizeof(_tail))
+                        return;
+                    block(_tail);
+                    _tail_size = 0;
+                }
+                for (; _n >= sizeof(_tail); _p += sizeof(_tail), _n -= sizeof(_tail))
+                    block(_p);
+                std::memcpy(_tail, _p, _n);
+                _tail_size = _n;
+            };
+
+            /// @brief Gets the checksum of the bytes so far.
+            std::uint64_t value() const {
+                std::uint64_t _h = _total;
+                for (auto _l : _lanes)
+                    _h = round(_h, _l);
+                for (std::size_t _i = 0; _i < _tail_size; ++_i)
+                    _h = round(_h, _tail[_i]);
+                return _h ^ (_h >> 29);
+            };
+        };
+
+        /// @brief Gets the checksum of a header (with the checksum field itself zeroed).
+        inline std::uint64_t header_checksum(map_file_header _h) {
+            _h._header_checksum = 0;
+            map_checksum _c;
+            _c.update(&_h, sizeof(_h));
+            return _c.value();
+        };
+
+        /// @brief A file being written, through a buffer.
+        class map_file_writer {
+        private:
+
+            int _fd = -1;
+            std::vector<char> _buf;
+            std::uint64_t _offset = 0;
+
+            void write_all(const char* _p, std::size_t _n) {
+                while (_n != 0) {
+                    auto _w = ::write(_fd, _p, _n);
+                    if (_w < 0 && errno == EINTR)
+                        continue;
+                    if (_w < 0)
+                        throw std::system_error(errno, std::generic_category(), "save_flat_map: write failed");
+                    _p += _w;
+                    _n -= static_cast<std::size_t>(_w);
+                }
+            };
+
+            void drain() {
+                write_all(_buf.data(), _buf.size());
+                _buf.clear();
+            };
+
+        public:
+
+            explicit map_file_writer(int _f) : _fd(_f) { _buf.reserve(1 << 16); };
+
+            /// @brief Writes bytes.
+            void put(const void* _data, std::size_t _n) {
+                auto* _p = static_cast<const char*>(_data);
+                _offset += _n;
+                if (_buf.size() + _n > _buf.capacity())
+                    drain();
+                if (_n >= _buf.capacity())
+                    write_all(_p, _n);
+                else
+                    _buf.insert(_buf.end(), _p, _p + _n);
+            };
+
+            /// @brief Writes zeros up to an alignment.
+            void pad(std::size_t _align) {
+                static constexpr char _zeros[map_file_alignment] = {};
+                put(_zeros, (_align - _offset % _align) % _align);
+            };
+
+            /// @brief Writes out what is buffered.
+            void finish() { drain(); };
+
+            std::uint64_t offset() const { return _offset; };
+        };
+    };
+
+    /// @brief Saves a flat map to a file that mapped_flat_map serves directly (a header, the sorted keys, then the values,
+    ///     each array aligned to a cache line and checksummed). The file is written next to the path and renamed over
+    ///     it once complete, so readers never map a half written file. It is only readable on machines with the same
+    ///     byte order and the same layout of k and v.
+    /// @param _m The map (erased elements are left out).
+    /// @param _path The path of the file.
+    template <typename k, typename v, typename k_compare, typename k_container, typename v_container>
+        requires std::is_trivially_copyable_v<k> && std::is_trivially_copyable_v<v>
+    void save_flat_map(const flat_map<k, v, k_compare, k_container, v_container>& _m, const std::string& _path) {
+        auto _tmp = _path + ".tmp";
+        int _fd = ::open(_tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (_fd < 0)
+            throw std::system_error(errno, std::generic_category(), "save_flat_map: open failed");
+        try {
+            __detail::map_file_header _h{};
+            std::memcpy(_h._magic, __detail::map_file_magic, sizeof(_h._magic));
+            _h._byte_order = __detail::map_file_byte_order;
+            _h._version = __detail::map_file_version;
+            _h._key_size = sizeof(k);
+            _h._key_align = alignof(k);
+            _h._value_size = sizeof(v);
+            _h._value_align = alignof(v);
+            _h._count = _m.size();
+
+            /// The header goes last, once the checksums are known.
+            __detail::map_file_writer _w(_fd);
+            __detail::map_checksum _kc, _vc;
+            _w.put(&_h, sizeof(_h));
+            _w.pad(__detail::map_file_alignment);
+            _h._keys_offset = _w.offset();
+            /// A map without erased elements in contiguous containers is written as two blocks, otherwise element by element.
+            bool _whole = _m.keys().size() == _m.size() && std::contiguous_iterator<typename k_container::const_iterator> &&
+                std::contiguous_iterator<typename v_container::const_iterator>;
+            auto _block = [&](const auto& _c, __detail::map_checksum& _sum) {
+                auto _bytes = _c.size() * sizeof(*std::to_address(_c.begin()));
+                if (_bytes != 0) {
+                    _w.put(std::to_address(_c.begin()), _bytes);
+                    _sum.update(std::to_address(_c.begin()), _bytes);
+                }
+            };
+            if (_whole)
+                _block(_m.keys(), _kc);
+            else
+                for (auto [_k, _v] : _m) {
+                    _w.put(std::addressof(_k), sizeof(k));
+                    _kc.update(std::addressof(_k), sizeof(k));
+                }
+            _w.pad(__detail::map_file_alignment);
+            _h._values_offset = _w.offset();
+            if (_whole)
+                _block(_m.values(), _vc);
+            else
+                for (auto [_k, _v] : _m) {
+                    _w.put(std::addressof(_v), sizeof(v));
+                    _vc.update(std::addressof(_v), sizeof(v));
+                }
+            _w.finish();
+            _h._file_size = _w.offset();
+            _h._keys_checksum = _kc.value();
+            _h._values_checksum = _vc.value();
+            _h._header_checksum = __detail::header_checksum(_h);
+            if (::pwrite(_fd, &_h, sizeof(_h), 0) != static_cast<ssize_t>(sizeof(_h)) || ::fsync(_fd) != 0)
+                throw std::system_error(errno, std::generic_category(), "save_flat_map: write failed");
+        }
+        catch (...) {
+            ::close(_fd);
+            ::unlink(_tmp.c_str());
+            throw;
+        }
+        if (::close(_fd) != 0 || std::rename(_tmp.c_str(), _path.c_str()) != 0) {
+            int _e = errno;
+            ::unlink(_tmp.c_str());
+            throw std::system_error(_e, std::generic_category(), "save_flat_map: rename failed");
+        }
+    };
+
+    /// @brief Read-only flat map served straight from a file written by save_flat_map(): the file is mapped and lookups
+    ///     and iteration read the mapping, nothing is deserialized or copied. Opening costs a few system calls and the
+    ///     header check, pages are read in as they are touched, and processes mapping the same file share one copy of it
+    ///     in the page cache.
+    /// @tparam k Key typename (trivially copyable, the same as the saved map).
+    /// @tparam v Value typename (trivially copyable, the same as the saved map).
+    /// @tparam k_compare Key comparison typename (has to order keys as the saved map did).
+    template <typename k, typename v, typename k_compare = std::less<k>>
+        requires std::is_trivially_copyable_v<k> && std::is_trivially_copyable_v<v>
+    class mapped_flat_map {
+    public:
+
+        using key_type = k;
+        using mapped_type = v;
+        using value_type = std::pair<k, v>;
+        using key_compare = k_compare;
+        using reference = std::pair<const k&, const v&>;
+        using const_reference = reference;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using iterator = __detail::flat_map_iterator<const k*, const v*>;
+        using const_iterator = iterator;
+
+    private:
+
+        /// The mapping.
+        void* _map = nullptr;
+        std::size_t _map_size = 0;
+        /// The keys and values in the mapping.
+        const k* _keys = nullptr;
+        const v* _values = nullptr;
+        std::size_t _n = 0;
+        /// Key comparison.
+        [[no_unique_address]] k_compare _cmp;
+
+        /// @brief Gets the index of the first key not less than (or with _upper, greater than) a key.
+        template <bool _upper>
+        std::size_t bound_index(const k& _k) const {
+            if constexpr (__detail::is_integral_search_v<k, k_compare, std::vector<k>>)
+                return __detail::integral_search<_upper>(_keys, _n, _k);
+            else if constexpr (_upper)
+                return static_cast<std::size_t>(std::upper_bound(_keys, _keys + _n, _k, _cmp) - _keys);
+            else
+                return static_cast<std::size_t>(std::lower_bound(_keys, _keys + _n, _k, _cmp) - _keys);
+        };
+
+        /// @brief Checks the header against the file and the types (and with map_verify::full, the checksums).
+        void verify(map_verify _how) const {
+            if (_map_size < sizeof(__detail::map_file_header))
+                throw mapped_file_error("mapped_flat_map: file too short");
+            __detail::map_file_header _h;
+            std::memcpy(&_h, _map, sizeof(_h));
+            if (std::memcmp(_h._magic, __detail::map_file_magic, sizeof(_h._magic)) != 0)
+                throw mapped_file_error("mapped_flat_map: not a flat map file");
+            if (_h._byte_order != __detail::map_file_byte_order || _h._version != __detail::map_file_version)
+                throw mapped_file_error("mapped_flat_map: unsupported byte order or version");
+            if (_h._header_checksum != __detail::header_checksum(_h))
+                throw mapped_file_error("mapped_flat_map: damaged header");
+            if (_h._key_size != sizeof(k) || _h._key_align != alignof(k) || _h._value_size != sizeof(v) || _h._value_align != alignof(v))
+                throw mapped_file_error("mapped_flat_map: the file holds other key or value types");
+            if (_h._file_size != _map_size || _h._keys_offset % __detail::map_file_alignment != 0 ||
+                _h._values_offset % __detail::map_file_alignment != 0 || _h._keys_offset > _map_size || _h._values_offset > _map_size ||
+                _h._count > _map_size / std::max(sizeof(k), sizeof(v)) ||
+                _h._keys_offset + _h._count * sizeof(k) > _h._values_offset || _h._values_offset + _h._count * sizeof(v) > _map_size)
+                throw mapped_file_error("mapped_flat_map: truncated or damaged file");
+            if (_how == map_verify::full) {
+                __detail::map_checksum _kc, _vc;
+                _kc.update(static_cast<const char*>(_map) + _h._keys_offset, _h._count * sizeof(k));
+                _vc.update(static_cast<const char*>(_map) + _h._values_offset, _h._count * sizeof(v));
+                if (_kc.value() != _h._keys_checksum || _vc.value() != _h._values_checksum)
+                    throw mapped_file_error("mapped_flat_map: damaged keys or values");
+            }
+        };
+
+        void unmap() {
+            if (_map != nullptr)
+                ::munmap(_map, _map_size);
+            _map = nullptr;
+            _map_size = _n = 0;
+            _keys = nullptr;
+            _values = nullptr;
+        };
+
+    public:
+
+        mapped_flat_map() = default;
+
+        /// @brief Explicit Constructor, maps a file written by save_flat_map().
+        /// @param _path The path of the file.
+        /// @param _how How much of the file is checked (throws mapped_file_error if it fails).
+        /// @param _c The key comparison.
+        explicit mapped_flat_map(const std::string& _path, map_verify _how = map_verify::header, const k_compare& _c = k_compare()) : _cmp(_c) {
+            int _fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (_fd < 0)
+                throw std::system_error(errno, std::generic_category(), "mapped_flat_map: open failed");
+            struct stat _st;
+            if (::fstat(_fd, &_st) != 0) {
+                int _e = errno;
+                ::close(_fd);
+                throw std::system_error(_e, std::generic_category(), "mapped_flat_map: stat failed");
+            }
+            _map_size = static_cast<std::size_t>(_st.st_size);
+            void* _p = _map_size == 0 ? MAP_FAILED : ::mmap(nullptr, _map_size, PROT_READ, MAP_SHARED, _fd, 0);
+            int _e = errno;
+            ::close(_fd);
+            if (_p == MAP_FAILED) {
+                if (_map_size == 0)
+                    throw mapped_file_error("mapped_flat_map: file too short");
+                throw std::system_error(_e, std::generic_category(), "mapped_flat_map: mmap failed");
+            }
+            _map = _p;
+            try {
+                verify(_how);
+            }
+            catch (...) {
+                unmap();
+                throw;
+            }
+            __detail::map_file_header _h;
+            std::memcpy(&_h, _map, sizeof(_h));
+            _n = static_cast<std::size_t>(_h._count);
+            _keys = reinterpret_cast<const k*>(static_cast<const char*>(_map) + _h._keys_offset);
+            _values = reinterpret_cast<const v*>(static_cast<const char*>(_map) + _h._values_offset);
+        };
+
+        mapped_flat_map(const mapped_flat_map&) = delete;
+        mapped_flat_map& operator=(const mapped_flat_map&) = delete;
+
+        /// @brief Move Constructor
+        mapped_flat_map(mapped_flat_map&& _o) noexcept
+            : _map(std::exchange(_o._map, nullptr)), _map_size(std::exchange(_o._map_size, 0)), _keys(std::exchange(_o._keys, nullptr)),
+              _values(std::exchange(_o._values, nullptr)), _n(std::exchange(_o._n, 0)), _cmp(_o._cmp) { };
+
+        /// @brief Move Assignment
+        mapped_flat_map& operator=(mapped_flat_map&& _o) noexcept {
+            if (this != &_o) {
+                unmap();
+                _map = std::exchange(_o._map, nullptr);
+                _map_size = std::exchange(_o._map_size, 0);
+                _keys = std::exchange(_o._keys, nullptr);
+                _values = std::exchange(_o._values, nullptr);
+                _n = std::exchange(_o._n, 0);
+                _cmp = _o._cmp;
+            }
+            return *this;
+        };
+
+        ~mapped_flat_map() {
+            unmap();
+        };
+
+
+        ///------------- @section Member functions. -------------///
+
+
+        /// @brief Finding the element of a key.
+        /// @param _k The key.
+        /// @return The element, or end().
+        iterator find(const k& _k) const {
+            auto _i = bound_index<false>(_k);
+            return _i < _n && !_cmp(_k, _keys[_i]) ? begin() + _i : end();
+        };
+
+        /// @brief Checking if the map contains a key.
+        bool contains(const k& _k) const {
+            auto _i = bound_index<false>(_k);
+            return _i < _n && !_cmp(_k, _keys[_i]);
+        };
+
+        /// @brief Counting the elements of a key (0 or 1).
+        std::size_t count(const k& _k) const {
+            return contains(_k) ? 1 : 0;
+        };
+
+        /// @brief Finding the first element whose key is not less than a key.
+        iterator lower_bound(const k& _k) const {
+            return begin() + bound_index<false>(_k);
+        };
+
+        /// @brief Finding the first element whose key is greater than a key.
+        iterator upper_bound(const k& _k) const {
+            return begin() + bound_index<true>(_k);
+        };
+
+        /// @brief Finding the range of elements of a key.
+        std::pair<iterator, iterator> equal_range(const k& _k) const {
+            return { lower_bound(_k), upper_bound(_k) };
+        };
+
+        /// @brief Get the value of a key.
+        /// @return The value, throws std::out_of_range if the key does not exist.
+        const v& at(const k& _k) const {
+            auto _i = bound_index<false>(_k);
+            if (_i == _n || _cmp(_k, _keys[_i]))
+                throw std::out_of_range("mapped_flat_map::at: key not found");
+            return _values[_i];
+        };
+
+        /// @brief Asks the kernel to read the whole file in ahead of use (otherwise pages are read as lookups touch them).
+        void prefetch() const {
+            if (_map != nullptr)
+                ::madvise(_map, _map_size, MADV_WILLNEED);
+        };
+
+        /// @brief Get the size of the map.
+        std::size_t size() const {
+            return _n;
+        };
+
+        /// @brief Checking if the map is empty.
+        bool empty() const {
+            return _n == 0;
+        };
+
+        /// @brief Get the sorted keys (a view into the mapping).
+        std::span<const k> keys() const {
+            return { _keys, _n };
+        };
+
+        /// @brief Get the values, in the order of the keys (a view into the mapping).
+        std::span<const v> values() const {
+            return { _values, _n };
+        };
+
+        /// @brief Get the key comparison.
+        k_compare key_comp() const {
+            return _cmp;
+        };
+
+
+        ///------------- @section Container functions. -------------///
+
+
+        /// @brief Get the begin iterator of the map.
+        iterator begin() const {
+            return iterator(_keys, _values);
+        };
+
+        /// @brief Get the end iterator of the map.
+        iterator end() const {
+            return iterator(_keys + _n, _values + _n);
+        };
+
+        /// @brief Get the constant begin iterator of the map.
+        const_iterator cbegin() const {
+            return begin();
+        };
+
+        /// @brief Get the constant end iterator of the map.
+        const_iterator cend() const {
+            return end();
+        };
+    };
+};
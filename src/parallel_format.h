@@ -0,0 +1,422 @@
+/**
+ *
+ *
+ *      @author  Sean Hobeck
+ *       @date 2023-02-24
+ *
+ *
+ **/
+#pragma once
+
+/// @uses: std::atomic
+#include <atomic>
+
+/// @uses: std::thread
+#include <thread>
+
+/// @uses: std::mutex, std::lock_guard, std::unique_lock
+#include <mutex>
+
+/// @uses: std::condition_variable
+#include <condition_variable>
+
+/// @uses: std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <exception>
+
+/// @uses: std::ranges::random_access_range, std::ranges::size, std::ranges::begin
+#include <ranges>
+
+/// @uses: std::tuple_size, std::tuple_element_t, std::apply
+#include <tuple>
+
+/// @uses: std::vector
+#include <vector>
+
+/// @uses: IOV_MAX
+#include <climits>
+
+/// @uses: writev, iovec
+#include <sys/uio.h>
+
+/// @uses: output_file, basic_memory_buffer, format_string, make_format_args
+#include "print.h"
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+    namespace __detail {
+        /// @brief Checks if a record is tuple-like (its elements are the arguments of its format string).
+        template<typename record_t>
+        concept tuple_record = requires { std::tuple_size<record_t>::value; };
+
+        /// @brief The format string of a record: its elements for a tuple-like record, the record itself otherwise.
+        template<typename record_t, typename = void>
+        struct record_format
+        {
+            using type = format_string<record_t>;
+        };
+        template<typename record_t, typename seq_t>
+        struct tuple_record_format;
+        template<typename record_t, std::size_t ... I>
+        struct tuple_record_format<record_t, std::index_sequence<I...>>
+        {
+            using type = format_string<std::tuple_element_t<I, record_t>...>;
+        };
+        template<tuple_record record_t>
+        struct record_format<record_t, void> : tuple_record_format<record_t, std::make_index_sequence<std::tuple_size_v<record_t>>> { };
+
+        /// @brief Formats a record into a buffer.
+        /// @param __buf The buffer.
+        /// @param __fmt The format string.
+        /// @param __rec The record.
+        template<typename record_t>
+        void
+        format_record(format_buffer<char>& __buf, std::string_view __fmt, const record_t& __rec)
+        {
+            if constexpr (tuple_record<record_t>)
+                std::apply([&](const auto&... __args) { vformat_to_buffer(__buf, __fmt, basic_format_args<char>(make_format_args(__args...))); }, __rec);
+            else
+                vformat_to_buffer(__buf, __fmt, basic_format_args<char>(make_format_args(__rec)));
+        };
+
+        /// @brief Writes out a list of buffers with as few writev(2) calls as it takes, retrying partial and interrupted writes.
+        /// @param __fd The file descriptor.
+        /// @param __iov The buffers (they are advanced past what was written).
+        /// @return The amount of bytes written.
+        inline std::size_t
+        write_vectored(int __fd, std::vector<::iovec>& __iov)
+        {
+            std::size_t __total = 0;
+            bool __first = true;
+            for (std::size_t __i = 0; __i < __iov.size(); )
+            {
+                auto __n = std::min<std::size_t>(__iov.size() - __i, IOV_MAX);
+                auto __r = ::writev(__fd, __iov.data() + __i, static_cast<int>(__n));
+                if (__r < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "write_vectored: writev failed");
+                }
+                count_write(__fd, static_cast<std::size_t>(__r), std::exchange(__first, false));
+                __total += static_cast<std::size_t>(__r);
+
+                /// Skip the buffers that were written out, and the written part of the one the write stopped in.
+                auto __left = static_cast<std::size_t>(__r);
+                for (; __i < __iov.size() && __left >= __iov[__i].iov_len; ++__i)
+                    __left -= __iov[__i].iov_len;
+                if (__left != 0)
+                {
+                    __iov[__i].iov_base = static_cast<char*>(__iov[__i].iov_base) + __left;
+                    __iov[__i].iov_len -= __left;
+                }
+            }
+            return __total;
+        };
+    };
+
+    /// @brief The format string of the records of a range (see format_pool::join).
+    template<typename range_t>
+    using record_format_string = typename __detail::record_format<std::ranges::range_value_t<range_t>>::type;
+
+
+    /// @brief A pool of threads formatting large ranges of records in chunks.
+    ///     A range is split into chunks of consecutive records, the threads of the pool (and the calling thread) take the
+    ///     chunks in turn and format each into a buffer of its own, then the buffers are put together in order: into one
+    ///     string, or written out with writev(2) without copying them at all. Calls from different threads take turns.
+    class format_pool
+    {
+    private:
+
+        /// The worker threads.
+        std::vector<std::thread> _threads;
+        /// Serializes run() calls.
+        std::mutex _run;
+        /// Guards the job state below.
+        std::mutex _lock;
+        /// Wakes the workers up for a job (or to stop).
+        std::condition_variable _wake;
+        /// Wakes run() up once every worker is done.
+        std::condition_variable _done;
+        /// The job: a task function and its state, the amount of tasks, and the next task to take.
+        void (*_call)(void*, std::size_t) = nullptr;
+        void* _ctx = nullptr;
+        std::size_t _tasks = 0;
+        std::atomic<std::size_t> _next = 0;
+        /// The job number, and the amount of workers still working on it.
+        std::uint64_t _job = 0;
+        std::size_t _active = 0;
+        /// The first exception a task threw.
+        std::exception_ptr _error;
+        /// Whether the workers stop.
+        bool _stop = false;
+        /// The amount of records per chunk (0 picks it from the range size).
+        std::size_t _chunk = 0;
+
+        /// @brief Takes tasks until there are none left.
+        void work() noexcept
+        {
+            for (std::size_t __i; (__i = _next.fetch_add(1, std::memory_order_relaxed)) < _tasks; )
+            {
+                try { _call(_ctx, __i); }
+                catch (...)
+                {
+                    std::lock_guard __l(_lock);
+                    if (!_error)
+                        _error = std::current_exception();
+                    _next.store(_tasks, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        /// @brief The worker loop.
+        void worker()
+        {
+            std::uint64_t __seen = 0;
+            std::unique_lock __l(_lock);
+            for (;;)
+            {
+                _wake.wait(__l, [&]() { return _stop || _job != __seen; });
+                if (_stop)
+                    return;
+                __seen = _job;
+                __l.unlock();
+                work();
+                __l.lock();
+                if (--_active == 0)
+                    _done.notify_one();
+            }
+        };
+
+        /// @brief Gets the amount of records per chunk for a range.
+        std::size_t chunk_for(std::size_t __n) const noexcept
+        {
+            if (_chunk != 0)
+                return _chunk;
+            /// About 8 chunks per thread so that uneven records even out, but not so small the buffers cost more than the records.
+            return std::max<std::size_t>(256, __n / (8 * concurrency()) + 1);
+        };
+
+        /// @brief Formats the chunks of a range, each into a buffer of its own.
+        template<typename range_t>
+        std::vector<memory_buffer>
+        format_chunks(const range_t& __r, std::string_view __fmt, std::string_view __sep)
+        {
+            auto __n = static_cast<std::size_t>(std::ranges::size(__r));
+            auto __chunk = chunk_for(__n);
+            std::vector<memory_buffer> __bufs((__n + __chunk - 1) / __chunk);
+            run(__bufs.size(), [&](std::size_t __c)
+            {
+                auto& __buf = __bufs[__c];
+                auto __it = std::ranges::begin(__r) + static_cast<std::ptrdiff_t>(__c * __chunk);
+                for (std::size_t __i = __c * __chunk, __e = std::min(__n, __i + __chunk); __i < __e; ++__i, ++__it)
+                {
+                    if (__i != 0)
+                        __buf.append(__sep.data(), __sep.data() + __sep.size());
+                    __detail::format_record(__buf, __fmt, *__it);
+                }
+            });
+            return __bufs;
+        };
+
+        /// @brief Writes out the chunks of a range.
+        static std::size_t
+        write_chunks(int __fd, std::vector<memory_buffer>& __bufs)
+        {
+            std::vector<::iovec> __iov;
+            __iov.reserve(__bufs.size());
+            for (auto& __b : __bufs)
+                if (__b.size() != 0)
+                    __iov.push_back({ __b.data(), __b.size() });
+            return __detail::write_vectored(__fd, __iov);
+        };
+
+    public:
+
+        /// @brief Explicit Constructor
+        /// @param __threads The amount of threads formatting, the calling thread included (at least 1).
+        explicit format_pool(std::size_t __threads = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            _threads.reserve(__threads > 1 ? __threads - 1 : 0);
+            for (std::size_t __i = 1; __i < __threads; ++__i)
+                _threads.emplace_back([this]() { worker(); });
+        };
+
+        /// @brief Destructor, stops the threads.
+        ~format_pool()
+        {
+            {
+                std::lock_guard __l(_lock);
+                _stop = true;
+            }
+            _wake.notify_all();
+            for (auto& __t : _threads)
+                __t.join();
+        };
+
+        format_pool(const format_pool&) = delete;
+        format_pool& operator=(const format_pool&) = delete;
+
+        /// @brief Gets the pool the free functions use (a thread per core).
+        static format_pool& shared()
+        {
+            static format_pool __p;
+            return __p;
+        };
+
+        /// @brief Get the amount of threads formatting, the calling thread included.
+        std::size_t concurrency() const noexcept { return _threads.size() + 1; };
+
+        /// @brief Sets the amount of records per chunk.
+        /// @param __n The amount of records, 0 picks it from the size of the range.
+        void set_chunk_size(std::size_t __n) noexcept { _chunk = __n; };
+
+        /// @brief Runs tasks on the threads of the pool and the calling thread, and waits for them.
+        /// @param __tasks The amount of tasks.
+        /// @param __fn The task function, gets the task index (the first exception it throws is rethrown here,
+        ///     the tasks not started by then are skipped).
+        template<typename fn_t>
+        void run(std::size_t __tasks, fn_t&& __fn)
+        {
+            std::lock_guard __r(_run);
+            if (_threads.empty() || __tasks <= 1)
+            {
+                for (std::size_t __i = 0; __i < __tasks; ++__i)
+                    __fn(__i);
+                return;
+            }
+            {
+                std::lock_guard __l(_lock);
+                _call = [](void* __ctx, std::size_t __i) { (*static_cast<std::remove_reference_t<fn_t>*>(__ctx))(__i); };
+                _ctx = std::addressof(__fn);
+                _tasks = __tasks;
+                _next.store(0, std::memory_order_relaxed);
+                _active = _threads.size();
+                ++_job;
+            }
+            _wake.notify_all();
+            work();
+
+            std::unique_lock __l(_lock);
+            _done.wait(__l, [&]() { return _active == 0; });
+            if (auto __e = std::exchange(_error, nullptr))
+                std::rethrow_exception(__e);
+        };
+
+        /// @brief Formats every record of a range and joins them into a string.
+        /// @param __r The records (a random access range, a tuple-like record is formatted with its elements as the arguments).
+        /// @param __fmt The format string of a record.
+        /// @param __sep The separator between two records.
+        /// @return The string.
+        template<std::ranges::random_access_range range_t>
+            requires std::ranges::sized_range<range_t>
+        std::string join(const range_t& __r, record_format_string<range_t> __fmt, std::string_view __sep = { })
+        {
+            auto __bufs = format_chunks(__r, __fmt.get(), __sep);
+            std::size_t __size = 0;
+            for (auto& __b : __bufs)
+                __size += __b.size();
+            std::string __s;
+            __s.reserve(__size);
+            for (auto& __b : __bufs)
+                __s.append(__b.data(), __b.size());
+            __detail::count_string<char>(__size);
+            return __s;
+        };
+
+        /// @brief Formats every record of a range and appends them to a format buffer (a memory_buffer, an output_file, ...).
+        template<std::ranges::random_access_range range_t>
+            requires std::ranges::sized_range<range_t>
+        void join_to(__detail::format_buffer<char>& __out, const range_t& __r, record_format_string<range_t> __fmt, std::string_view __sep = { })
+        {
+            for (auto& __b : format_chunks(__r, __fmt.get(), __sep))
+                __out.append(__b.data(), __b.data() + __b.size());
+        };
+
+        /// @brief Formats every record of a range and writes them out to a file descriptor with writev(2).
+        /// @return The amount of bytes written.
+        template<std::ranges::random_access_range range_t>
+            requires std::ranges::sized_range<range_t>
+        std::size_t write(int __fd, const range_t& __r, record_format_string<range_t> __fmt, std::string_view __sep = { })
+        {
+            auto __bufs = format_chunks(__r, __fmt.get(), __sep);
+            return write_chunks(__fd, __bufs);
+        };
+
+        /// @brief Formats every record of a range and writes them out to an output file with writev(2), after what is
+        ///     already in its buffer.
+        /// @return The amount of bytes written.
+        template<std::ranges::random_access_range range_t>
+            requires std::ranges::sized_range<range_t>
+        std::size_t write(output_file& __file, const range_t& __r, record_format_string<range_t> __fmt, std::string_view __sep = { })
+        {
+            auto __bufs = format_chunks(__r, __fmt.get(), __sep);
+            __file.flush();
+            return write_chunks(__file.descriptor(), __bufs);
+        };
+    };
+
+
+    /// @brief Formats every record of a range on the shared format_pool and puts them together in order.
+    /// @param __r The records (a random access range, a tuple-like record is formatted with its elements as the arguments).
+    /// @param __fmt The format string of a record.
+    /// @return The string.
+    template<std::ranges::random_access_range range_t>
+        requires std::ranges::sized_range<range_t>
+    static std::string
+    _GLIBCXX_NODISCARD
+    format_range(const range_t& __r, record_format_string<range_t> __fmt)
+    {
+        return format_pool::shared().join(__r, __fmt);
+    };
+    /// @brief Formats every record of a range on the shared format_pool and writes them out to a file descriptor with writev(2).
+    /// @return The amount of bytes written.
+    template<std::ranges::random_access_range range_t>
+        requires std::ranges::sized_range<range_t>
+    static std::size_t
+    format_range(int __fd, const range_t& __r, record_format_string<range_t> __fmt)
+    {
+        return format_pool::shared().write(__fd, __r, __fmt);
+    };
+    /// @brief Formats every record of a range on the shared format_pool and writes them out to an output file.
+    template<std::ranges::random_access_range range_t>
+        requires std::ranges::sized_range<range_t>
+    static std::size_t
+    format_range(output_file& __file, const range_t& __r, record_format_string<range_t> __fmt)
+    {
+        return format_pool::shared().write(__file, __r, __fmt);
+    };
+
+    /// @brief Formats every record of a range on the shared format_pool and joins them with a separator.
+    /// @param __r The records.
+    /// @param __fmt The format string of a record.
+    /// @param __sep The separator between two records.
+    /// @return The string.
+    template<std::ranges::random_access_range range_t>
+        requires std::ranges::sized_range<range_t>
+    static std::string
+    _GLIBCXX_NODISCARD
+    format_join(const range_t& __r, record_format_string<range_t> __fmt, std::string_view __sep)
+    {
+        return format_pool::shared().join(__r, __fmt, __sep);
+    };
+    /// @brief Formats every record of a range on the shared format_pool, joined with a separator, and writes them out
+    ///     to a file descriptor with writev(2).
+    /// @return The amount of bytes written.
+    template<std::ranges::random_access_range range_t>
+        requires std::ranges::sized_range<range_t>
+    static std::size_t
+    format_join(int __fd, const range_t& __r, record_format_string<range_t> __fmt, std::string_view __sep)
+    {
+        return format_pool::shared().write(__fd, __r, __fmt, __sep);
+    };
+    /// @brief Formats every record of a range on the shared format_pool, joined with a separator, and writes them out
+    ///     to an output file.
+    template<std::ranges::random_access_range range_t>
+        requires std::ranges::sized_range<range_t>
+    static std::size_t
+    format_join(output_file& __file, const range_t& __r, record_format_string<range_t> __fmt, std::string_view __sep)
+    {
+        return format_pool::shared().write(__file, __r, __fmt, __sep);
+    };
+};
@@ -14,28 +14,374 @@
 /// @uses: std::string, std::wstring
 #include <string>
 
-/// @uses: std::vformat, std::wformat
+/// @uses: std::fwrite, std::fputws
+#include <cstdio>
+
+/// @uses: std::fwide
+#include <cwchar>
+
+/// @uses: std::optional
+#include <optional>
+
+/// @uses: std::unique_ptr
+#include <memory>
+
+/// @uses: std::memchr
+#include <cstring>
+
+/// @uses: errno, EINTR
+#include <cerrno>
+
+/// @uses: std::system_error, std::generic_category
+#include <system_error>
+
+/// @uses: write, close
+#include <unistd.h>
+
+/// @uses: open, O_WRONLY, O_CREAT, O_TRUNC, O_APPEND, O_CLOEXEC
+#include <fcntl.h>
+
+/// @uses: basic_memory_buffer, format_string, wformat_string
 #include "format.h"
 
+/// @uses: transcode, max_transcoded_size
+#include "utf.h"
+
 
 /// @brief Namespace for the "gnu/linux c++23 standard".
 namespace __gnu_cxx::v23 {
+    namespace __detail {
+        /// @brief The buffer a print call formats into.
+        ///     By default it is a basic_memory_buffer on the stack, so a message that fits its inline storage never allocates.
+        ///     Defining V23_PRINT_THREAD_LOCAL_BUFFER before including this header switches to one buffer per thread that keeps
+        ///     its capacity between calls, so steady-state printing never allocates whatever the message length is.
+        /// @tparam char_t The character type.
+        template<typename char_t>
+        class print_buffer
+        {
+#ifdef V23_PRINT_THREAD_LOCAL_BUFFER
+        private:
+
+            /// The thread-local buffer, and whether a print call on this thread is using it.
+            struct scratch
+            {
+                basic_memory_buffer<char_t> _buf;
+                bool _busy = false;
+            };
+
+            static scratch& get_scratch() noexcept
+            {
+                thread_local scratch __s;
+                return __s;
+            };
+
+            /// The thread-local scratch.
+            scratch& _scratch = get_scratch();
+            /// A buffer for prints nested in a formatter (the scratch is already in use then).
+            std::optional<basic_memory_buffer<char_t>> _nested;
+            /// The buffer in use.
+            basic_memory_buffer<char_t>* _buf;
+
+        public:
+
+            print_buffer()
+            {
+                if (_scratch._busy)
+                    _buf = &_nested.emplace();
+                else
+                {
+                    _scratch._busy = true;
+                    _scratch._buf.clear();
+                    _buf = &_scratch._buf;
+                }
+            };
+
+            ~print_buffer()
+            {
+                if (!_nested)
+                    _scratch._busy = false;
+            };
+#else
+        private:
+
+            /// The stack buffer.
+            basic_memory_buffer<char_t> _store;
+            /// The buffer in use.
+            basic_memory_buffer<char_t>* _buf = &_store;
+
+        public:
+
+            print_buffer() = default;
+#endif
+            print_buffer(const print_buffer&) = delete;
+            print_buffer& operator=(const print_buffer&) = delete;
+
+            /// @brief Get the buffer.
+            basic_memory_buffer<char_t>& get() noexcept { return *_buf; };
+        };
+
+        /// @brief Formats into a print buffer.
+        /// @param __buf The print buffer.
+        /// @param __fmt The format string.
+        /// @param __args The arguments.
+        /// @return The formatted characters.
+        template<typename char_t>
+        inline basic_memory_buffer<char_t>&
+        vformat_to_print(print_buffer<char_t>& __buf, std::basic_string_view<char_t> __fmt, basic_format_args<char_t> __args)
+        {
+            count(counter_print_calls);
+            vformat_to_buffer(__buf.get(), __fmt, __args);
+            return __buf.get();
+        };
+
+        /// @brief Format buffer for wide characters that stages them in a small array and transcodes them to UTF-8 into a
+        ///     narrow buffer whenever it fills up, so a wide print is formatted and encoded in one pass without any locale.
+        /// @tparam char_t The wide character type.
+        template<typename char_t>
+        class utf8_buffer final : public format_buffer<char_t>
+        {
+        private:
+
+            /// The narrow buffer.
+            format_buffer<char>& _out;
+            /// The staging area.
+            char_t _data[256];
+
+            void grow(std::size_t) override { flush(false); };
+
+        public:
+
+            /// @brief Explicit Constructor
+            /// @param __out The narrow buffer the UTF-8 is appended to.
+            explicit utf8_buffer(format_buffer<char>& __out) noexcept : format_buffer<char_t>(_data, 0, 256), _out(__out) { };
+
+            /// @brief Transcodes what is staged into the narrow buffer.
+            /// @param __final Whether this is the end of the output, otherwise a code point split at the end is kept
+            ///     staged until the rest of it arrives.
+            void flush(bool __final = true)
+            {
+                auto __n = this->_size - (__final ? 0 : incomplete_tail(_data, this->_size));
+                constexpr auto __max = max_transcoded_size<char, char_t>(256);
+
+                /// Straight into the narrow buffer when it has the room, through the stack when it is bounded (output_file).
+                _out.try_reserve(_out.size() + __max);
+                if (_out.capacity() - _out.size() >= __max)
+                    _out.try_resize(_out.size() + transcode(_data, __n, _out.data() + _out.size()));
+                else
+                {
+                    char __tmp[__max];
+                    _out.append(__tmp, __tmp + transcode(_data, __n, __tmp));
+                }
+                std::char_traits<char_t>::move(_data, _data + __n, this->_size - __n);
+                count_flushed(__n);
+                this->_size -= __n;
+            };
+        };
+
+        /// @brief Formats wide characters into a narrow buffer, as UTF-8.
+        /// @param __buf The narrow buffer.
+        /// @param __fmt The format string.
+        /// @param __args The arguments.
+        template<typename char_t>
+        inline void
+        vformat_to_utf8(format_buffer<char>& __buf, std::basic_string_view<char_t> __fmt, basic_format_args<char_t> __args)
+        {
+            utf8_buffer<char_t> __u(__buf);
+            vformat_to_buffer(__u, __fmt, __args);
+            __u.flush();
+        };
+    };
+
+
+    /// @brief When an output_file writes out what has been printed to it.
+    enum class flush_policy : unsigned char
+    {
+        /// After every print that writes a newline (like a line buffered stdio stream).
+        line,
+        /// After a print leaves at least half of the buffer used, so that writes hold whole prints.
+        threshold,
+        /// Only on flush(), destruction, or when the buffer is full.
+        manual
+    };
+
+    /// @brief A buffered output file that print calls format straight into, the buffer is written out with
+    ///     write(2) in as few calls as the flush policy allows. There is no iostream or stdio in the way, and
+    ///     nothing is flushed per line unless the policy says so.
+    ///     Prints longer than the buffer are written out in pieces as they are formatted, so the buffer never grows.
+    ///     Not synchronized, use one per thread (or lock around it).
+    class output_file final : public __detail::format_buffer<char>
+    {
+    private:
+
+        /// The file descriptor.
+        int _fd;
+        /// Whether the descriptor is closed on destruction.
+        bool _owned;
+        /// The stdio stream the descriptor belongs to (its buffer is flushed first, to keep the order of the output).
+        FILE* _fp = nullptr;
+        /// When the buffer is written out.
+        flush_policy _policy;
+        /// The storage.
+        std::unique_ptr<char[]> _store;
+        /// The amount of times the buffer was written out.
+        std::uint64_t _flushes = 0;
+
+        void grow(std::size_t) override { flush(); };
+
+        /// @brief Writes out all of a range, retrying partial and interrupted writes.
+        void write_all(const char* __p, std::size_t __n)
+        {
+            if (_fp != nullptr)
+                std::fflush(_fp);
+            for (bool __first = true; __n != 0; )
+            {
+                auto __r = ::write(_fd, __p, __n);
+                if (__r < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "output_file: write failed");
+                }
+                __detail::count_write(_fd, static_cast<std::size_t>(__r), std::exchange(__first, false));
+                __p += __r;
+                __n -= static_cast<std::size_t>(__r);
+            }
+        };
+
+    public:
+
+        /// The default buffer size.
+        static constexpr std::size_t default_size = 32768;
+
+        /// @brief Explicit Constructor, for a file descriptor (it is not closed on destruction).
+        /// @param __fd The file descriptor.
+        /// @param __policy When the buffer is written out.
+        /// @param __size The buffer size.
+        explicit output_file(int __fd, flush_policy __policy = flush_policy::threshold, std::size_t __size = default_size)
+            : _fd(__fd), _owned(false), _policy(__policy), _store(std::make_unique_for_overwrite<char[]>(__size))
+        {
+            this->set(_store.get(), __size);
+        };
+
+        /// @brief Explicit Constructor, for a stdio stream (it is not closed on destruction).
+        ///     Writes bypass its buffer, whatever was already printed to it is flushed before each write out.
+        /// @param __fp The stream.
+        /// @param __policy When the buffer is written out.
+        /// @param __size The buffer size.
+        explicit output_file(FILE* __fp, flush_policy __policy = flush_policy::threshold, std::size_t __size = default_size)
+            : output_file(::fileno(__fp), __policy, __size)
+        {
+            _fp = __fp;
+        };
+
+        /// @brief Explicit Constructor, opens (creating or truncating) a file.
+        /// @param __path The path of the file.
+        /// @param __policy When the buffer is written out.
+        /// @param __size The buffer size.
+        /// @param __append Whether to append to the file rather than truncating it.
+        explicit output_file(const char* __path, flush_policy __policy = flush_policy::threshold,
+            std::size_t __size = default_size, bool __append = false)
+            : output_file(::open(__path, O_WRONLY | O_CREAT | O_CLOEXEC | (__append ? O_APPEND : O_TRUNC), 0644), __policy, __size)
+        {
+            if (_fd < 0)
+                throw std::system_error(errno, std::generic_category(), "output_file: open failed");
+            _owned = true;
+        };
+
+        /// @brief Destructor, writes out what is left (errors are ignored here) and closes an owned descriptor.
+        ~output_file()
+        {
+            try { flush(); } catch (...) { }
+            if (_owned)
+                ::close(_fd);
+        };
+
+        output_file(const output_file&) = delete;
+        output_file& operator=(const output_file&) = delete;
+
+        /// @brief Where a print started: the size of the buffer, and the amount of times it was written out before.
+        struct print_mark
+        {
+            std::size_t _size;
+            std::uint64_t _flushes;
+        };
+
+        /// @brief Marks where a print starts, for commit().
+        print_mark mark() const noexcept { return { this->_size, _flushes }; };
+
+        /// @brief Writes out the buffer.
+        void flush()
+        {
+            auto __n = this->_size;
+            __detail::count_flushed(__n);
+            this->_size = 0;
+            if (__n != 0)
+            {
+                ++_flushes;
+                write_all(_store.get(), __n);
+            }
+        };
+
+        /// @brief Applies the flush policy after a print.
+        /// @param __begin Where the print started (see mark()), if the buffer was written out since all of it is the print's.
+        /// @param __newline Whether the print is known to have written a newline.
+        void commit(print_mark __begin, bool __newline = false)
+        {
+            switch (_policy)
+            {
+                case flush_policy::line:
+                    if (__begin._flushes != _flushes)
+                        __begin._size = 0;
+                    if (__newline || std::memchr(_store.get() + __begin._size, '\n', this->_size - __begin._size) != nullptr)
+                        flush();
+                    break;
+                case flush_policy::threshold:
+                    if (this->_size >= this->_capacity / 2)
+                        flush();
+                    break;
+                case flush_policy::manual:
+                    break;
+            }
+        };
+
+        /// @brief Get the file descriptor.
+        int descriptor() const noexcept { return _fd; };
+
+        /// @brief Get the flush policy.
+        flush_policy policy() const noexcept { return _policy; };
+    };
+
+
     /// @brief Prints out to stdout, with formatted args.
     /// @tparam ...pargs_t Packed args (same as virtual arguments).
     /// @param __format The string to be formatted to.
     /// @param __args Format parameters to format the string and print to stdout.
     template<typename ... pargs_t>
     static void 
-    print(const std::string& __format, pargs_t... __args) noexcept 
+    print(format_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        std::cout << __gnu_cxx::v23::vformat(__format, __args...); 
+        __detail::print_buffer<char> __pb;
+        auto& __f = __detail::vformat_to_print(__pb, __format.get(), format_args(make_format_args(__args...)));
+        std::cout.write(__f.data(), static_cast<std::streamsize>(__f.size())); 
     };
     /// @brief Prints out to a file stream, with formatted args.
     template<typename ... pargs_t>
     static void 
-    print(const std::ostream& __fs, const std::string& __format, pargs_t... __args) noexcept 
+    print(std::ostream& __fs, format_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        __fs << __gnu_cxx::v23::vformat(__format, __args...); 
+        __detail::print_buffer<char> __pb;
+        auto& __f = __detail::vformat_to_print(__pb, __format.get(), format_args(make_format_args(__args...)));
+        __fs.write(__f.data(), static_cast<std::streamsize>(__f.size())); 
+    };
+    /// @brief Prints out to a buffered output file, with formatted args (formatted straight into its buffer).
+    template<typename ... pargs_t>
+    static void 
+    print(output_file& __file, format_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        __detail::count(__detail::counter_print_calls);
+        auto __begin = __file.mark();
+        __detail::vformat_to_buffer(__file, __format.get(), format_args(make_format_args(__args...)));
+        __file.commit(__begin);
     };
 
 
@@ -45,16 +391,96 @@ namespace __gnu_cxx::v23 {
     /// @param __args Format parameters to format the string and print a line to stdout.
     template<typename ... pargs_t>
     static void 
-    println(const std::string& __format, pargs_t... __args) noexcept 
+    println(format_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        std::cout << __gnu_cxx::v23::vformat(__format, __args...) << std::endl; 
+        println(std::cout, __format, std::forward<pargs_t>(__args)...); 
     };
     /// @brief Prints a line out to a file stream, with formatted args.
     template<typename ... pargs_t>
     static void 
-    println(const std::ostream& __fs, const std::string& __format, pargs_t... __args) noexcept 
+    println(std::ostream& __fs, format_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        __detail::print_buffer<char> __pb;
+        auto& __f = __detail::vformat_to_print(__pb, __format.get(), format_args(make_format_args(__args...)));
+        __f.push_back('\n');
+        __fs.write(__f.data(), static_cast<std::streamsize>(__f.size()));
+    };
+    /// @brief Prints a line out to a buffered output file, with formatted args (formatted straight into its buffer).
+    template<typename ... pargs_t>
+    static void 
+    println(output_file& __file, format_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        __detail::count(__detail::counter_print_calls);
+        auto __begin = __file.mark();
+        __detail::vformat_to_buffer(__file, __format.get(), format_args(make_format_args(__args...)));
+        __file.push_back('\n');
+        __file.commit(__begin, true);
+    };
+
+
+    /// @brief Prints out to stdout, with formatted args (wide, written out as UTF-8).
+    /// @tparam ...pargs_t Packed args (same as virtual arguments).
+    /// @param __format The wide string to be formatted to.
+    /// @param __args Format parameters to format the wstring and print to stdout.
+    template<typename ... pargs_t>
+    static void 
+    print(wformat_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        print(std::cout, __format, std::forward<pargs_t>(__args)...); 
+    };
+    /// @brief Prints out to a file stream, with formatted args (wide, written out as UTF-8).
+    template<typename ... pargs_t>
+    static void 
+    print(std::ostream& __fs, wformat_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        __detail::print_buffer<char> __pb;
+        __detail::count(__detail::counter_print_calls);
+        __detail::vformat_to_utf8(__pb.get(), __format.get(), wformat_args(make_wformat_args(__args...)));
+        __fs.write(__pb.get().data(), static_cast<std::streamsize>(__pb.get().size())); 
+    };
+    /// @brief Prints out to a buffered output file, with formatted args (wide, transcoded to UTF-8 straight into its buffer).
+    template<typename ... pargs_t>
+    static void 
+    print(output_file& __file, wformat_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        __detail::count(__detail::counter_print_calls);
+        auto __begin = __file.mark();
+        __detail::vformat_to_utf8(__file, __format.get(), wformat_args(make_wformat_args(__args...)));
+        __file.commit(__begin);
+    };
+
+
+    /// @brief Prints a line out to stdout, with formatted args (wide, written out as UTF-8).
+    /// @tparam ...pargs_t Packed args (same as virtual arguments).
+    /// @param __format The wide string to be formatted to.
+    /// @param __args Format parameters to format the wstring and print a line to stdout.
+    template<typename ... pargs_t>
+    static void 
+    println(wformat_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        println(std::cout, __format, std::forward<pargs_t>(__args)...); 
+    };
+    /// @brief Prints a line out to a file stream, with formatted args (wide, written out as UTF-8).
+    template<typename ... pargs_t>
+    static void 
+    println(std::ostream& __fs, wformat_string<pargs_t...> __format, pargs_t&&... __args) 
+    { 
+        __detail::print_buffer<char> __pb;
+        __detail::count(__detail::counter_print_calls);
+        __detail::vformat_to_utf8(__pb.get(), __format.get(), wformat_args(make_wformat_args(__args...)));
+        __pb.get().push_back('\n');
+        __fs.write(__pb.get().data(), static_cast<std::streamsize>(__pb.get().size())); 
+    };
+    /// @brief Prints a line out to a buffered output file, with formatted args (wide, transcoded to UTF-8 straight into its buffer).
+    template<typename ... pargs_t>
+    static void 
+    println(output_file& __file, wformat_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        __fs << __gnu_cxx::v23::vformat(__format, __args...) << std::endl;
+        __detail::count(__detail::counter_print_calls);
+        auto __begin = __file.mark();
+        __detail::vformat_to_utf8(__file, __format.get(), wformat_args(make_wformat_args(__args...)));
+        __file.push_back('\n');
+        __file.commit(__begin, true);
     };
 
 
@@ -65,17 +491,18 @@ namespace __gnu_cxx::v23 {
     /// @param __args Format parameters to format the string and print a line to the file pointer.
     template<typename ... pargs_t>
     static void 
-    vprint(FILE* __fp, const std::string& __format, pargs_t... __args) noexcept 
+    vprint(FILE* __fp, format_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        if (auto __f = __gnu_cxx::v23::vformat(__format, __args...); __f.length() > 0)
-            fwrite(__f.c_str(), __f.length(), 1ul, __fp);
+        __detail::print_buffer<char> __pb;
+        if (auto& __f = __detail::vformat_to_print(__pb, __format.get(), format_args(make_format_args(__args...))); __f.size() > 0)
+            std::fwrite(__f.data(), 1ul, __f.size(), __fp);
     };
     /// @brief Writes out to stdout with formatted args (unicode).
     template<typename ... pargs_t>
     static void 
-    vprint(const std::string& __format, pargs_t... __args) noexcept 
+    vprint(format_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        vprint(stdout, __format, __args...);
+        vprint(stdout, __format, std::forward<pargs_t>(__args)...);
     };
     
     
@@ -86,25 +513,26 @@ namespace __gnu_cxx::v23 {
     /// @param __args Format parameters to format the string and print a line to the file pointer.
     template<typename ... pargs_t>
     static void 
-    vprintln_unicode(FILE* __fp, const std::string& __format, pargs_t... __args) noexcept 
+    vprintln_unicode(FILE* __fp, format_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        if (auto __f = __gnu_cxx::v23::vformat(__format, __args...) + '\n'; __f.length() > 0)
-            fprintf(__fp, __f.c_str());
+        __detail::print_buffer<char> __pb;
+        auto& __f = __detail::vformat_to_print(__pb, __format.get(), format_args(make_format_args(__args...)));
+        __f.push_back('\n');
+        std::fwrite(__f.data(), 1ul, __f.size(), __fp);
     };
     /// @brief Writes out to stdout with formatted args (unicode).
     template<typename ... pargs_t>
     static void 
-    vprintln_unicode(const std::string& __format, pargs_t... __args) noexcept 
+    vprintln_unicode(format_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        vprintln_unicode(stdout, __format, __args...);
+        vprintln_unicode(stdout, __format, std::forward<pargs_t>(__args)...);
     };
-    /// @brief Writes out to std::wostream with formatted args (unicode).
+    /// @brief Writes out to std::ostream, ending the line, with formatted wide args (as UTF-8).
     template<typename ... pargs_t>
     static void 
-    vprintln_unicode(std::ostream& __stream, std::wstring& __format, pargs_t... __args) noexcept 
+    vprintln_unicode(std::ostream& __stream, wformat_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        if (auto __f = __gnu_cxx::v23::wformat(__format, __args...) + std::endl; __f.length() > 0)
-            __stream << __f;
+        println(__stream, __format, std::forward<pargs_t>(__args)...);
     };
         
     
@@ -115,25 +543,39 @@ namespace __gnu_cxx::v23 {
     /// @param __args Format parameters to format the wstring and print a line to the file pointer.
     template<typename ... pargs_t>
     static void 
-    vprintln_nonunicode(FILE* __fp, const std::wstring& __format, pargs_t... __args) noexcept 
+    vprintln_nonunicode(FILE* __fp, wformat_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        if (auto __f = __gnu_cxx::v23::wformat(__format, __args...) + L'\n'; __f.length() > 0)
-            fwprintf(__fp, __f.c_str());
+        /// A wide oriented stream converts with its locale, any other one is written UTF-8 (byte output would fail on the former).
+        if (std::fwide(__fp, 0) > 0)
+        {
+            __detail::print_buffer<wchar_t> __pb;
+            auto& __f = __detail::vformat_to_print(__pb, __format.get(), wformat_args(make_wformat_args(__args...)));
+            __f.push_back(L'\n');
+            __f.push_back(L'\0');
+            std::fputws(__f.data(), __fp);
+            return;
+        }
+        __detail::print_buffer<char> __pb;
+        __detail::count(__detail::counter_print_calls);
+        __detail::vformat_to_utf8(__pb.get(), __format.get(), wformat_args(make_wformat_args(__args...)));
+        __pb.get().push_back('\n');
+        std::fwrite(__pb.get().data(), 1ul, __pb.get().size(), __fp);
     };
     /// @brief Writes out to stdout with formatted args (non-unicode).
     template<typename ... pargs_t>
     static void 
-    vprintln_nonunicode(const std::wstring& __format, pargs_t... __args) noexcept 
+    vprintln_nonunicode(wformat_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        if (auto __f = __gnu_cxx::v23::wformat(__format, __args...) + L'\n'; __f.length() > 0)
-            std::wcout << __f;
+        vprintln_nonunicode(stdout, __format, std::forward<pargs_t>(__args)...);
     };
     /// @brief Writes out to std::wostream with formatted args (non-unicode).
     template<typename ... pargs_t>
     static void 
-    vprintln_nonunicode(std::wostream& __stream, std::wstring& __format, pargs_t... __args) noexcept 
+    vprintln_nonunicode(std::wostream& __stream, wformat_string<pargs_t...> __format, pargs_t&&... __args) 
     { 
-        if (auto __f = __gnu_cxx::v23::wformat(__format, __args...) + L'\n'; __f.length() > 0)
-            __stream << __f;
+        __detail::print_buffer<wchar_t> __pb;
+        auto& __f = __detail::vformat_to_print(__pb, __format.get(), wformat_args(make_wformat_args(__args...)));
+        __f.push_back(L'\n');
+        __stream.write(__f.data(), static_cast<std::streamsize>(__f.size()));
     };
 };
\ No newline at end of file
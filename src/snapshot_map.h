@@ -0,0 +1,297 @@
+/**
+ * 
+ * 
+ *      @author  Sean Hobeck
+ *       @date 2023-02-20
+ * 
+ * 
+ **/
+#pragma once
+
+/// @uses: std::atomic, std::mutex, std::lock_guard, std::optional, std::unique_ptr
+#include <bits/stdc++.h>
+
+/// @uses: flat_map
+#include "flat_map.h"
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+
+    namespace __detail {
+        /// @brief The amount of read counters of a snapshot_map, readers spread over them by thread so that threads only
+        ///     share a cache line once there are more of them than counters.
+        inline constexpr std::size_t snapshot_readers = 64;
+
+        /// @brief The read counters of a group of reader threads, one per version (see snapshot_map).
+        struct alignas(64) snapshot_counter {
+            std::atomic<std::uint64_t> _count[2] = { 0, 0 };
+        };
+
+        /// @brief The counter index of the calling thread, handed out in the order threads first read.
+        inline std::size_t reader_index() {
+            static std::atomic<std::size_t> _next = 0;
+            thread_local std::size_t _index = _next.fetch_add(1, std::memory_order_relaxed) % snapshot_readers;
+            return _index;
+        };
+    };
+
+    /// @brief Read-mostly concurrent map: readers pin an immutable flat_map snapshot without locks or waiting, writers
+    ///     stage updates and commit them as a new snapshot, published with one atomic store. Replaced snapshots are
+    ///     freed once no reader can still hold them.
+    ///
+    ///     Readers announce themselves on a counter of the current version (a version is 0 or 1) before loading the
+    ///     snapshot, and leave it when they let go, so a read is two atomic increments on a counter of their own and a
+    ///     load: nothing a reader does ever waits on anything. Replaced snapshots are retired; once no reader is on the
+    ///     other version, the version is switched, and once no reader is left on the old one, the snapshots retired
+    ///     before the switch are freed (the two waits of the Left-Right algorithm, without the waiting: writers check
+    ///     on every commit, and reclaim() checks on demand). A snapshot held for long only holds up freeing.
+    /// @tparam k Key typename.
+    /// @tparam v Value typename.
+    /// @tparam k_compare Key comparison typename.
+    /// @tparam k_container Key container typename.
+    /// @tparam v_container Value container typename.
+    template <typename k, typename v,
+        typename k_compare = std::less<k>,
+        typename k_container = std::vector<k>,
+        typename v_container = std::vector<v>>
+    class snapshot_map {
+    public:
+
+        using map_type = flat_map<k, v, k_compare, k_container, v_container>;
+        using key_type = k;
+        using mapped_type = v;
+
+        /// @brief A pinned snapshot, the map it points to does not change or go away while it is held.
+        class snapshot {
+        private:
+
+            /// The map.
+            const map_type* _map = nullptr;
+            /// The read counter it was pinned on.
+            std::atomic<std::uint64_t>* _count = nullptr;
+
+            snapshot(const map_type* _m, std::atomic<std::uint64_t>* _c) : _map(_m), _count(_c) { };
+
+            friend class snapshot_map;
+
+        public:
+
+            snapshot() = default;
+            snapshot(const snapshot&) = delete;
+            snapshot& operator=(const snapshot&) = delete;
+
+            /// @brief Move Constructor
+            snapshot(snapshot&& _o) noexcept : _map(std::exchange(_o._map, nullptr)), _count(std::exchange(_o._count, nullptr)) { };
+
+            /// @brief Move Assignment
+            snapshot& operator=(snapshot&& _o) noexcept {
+                if (this != &_o) {
+                    release();
+                    _map = std::exchange(_o._map, nullptr);
+                    _count = std::exchange(_o._count, nullptr);
+                }
+                return *this;
+            };
+
+            ~snapshot() {
+                release();
+            };
+
+            /// @brief Lets go of the snapshot early.
+            void release() {
+                if (_count != nullptr)
+                    _count->fetch_sub(1, std::memory_order_release);
+                _map = nullptr;
+                _count = nullptr;
+            };
+
+            const map_type& operator*() const { return *_map; };
+            const map_type* operator->() const { return _map; };
+        };
+
+    private:
+
+        /// The current snapshot.
+        std::atomic<const map_type*> _current;
+        /// The version readers announce themselves on.
+        std::atomic<std::size_t> _version = 0;
+        /// The read counters.
+        mutable __detail::snapshot_counter _readers[__detail::snapshot_readers];
+        /// Serializes writers.
+        std::mutex _write;
+        /// The staged updates, a key and its value (or std::nullopt to erase it), in the order they were staged.
+        std::vector<std::pair<k, std::optional<v>>> _staged;
+
+        /// Replaced snapshots, before the version switch that frees them.
+        std::vector<const map_type*> _retired;
+        /// Replaced snapshots, freed once the readers of the version before the switch have left.
+        std::vector<const map_type*> _draining;
+
+        /// @brief Checks if no reader is announced on a version. The loads are sequentially consistent like the readers'
+        ///     announcements and the writer's swaps: with acquire loads the check could read a counter before the swap it
+        ///     follows is visible, and miss a reader that still got the old snapshot.
+        bool no_readers(std::size_t _ver) const {
+            for (auto& _r : _readers)
+                if (_r._count[_ver].load(std::memory_order_seq_cst) != 0)
+                    return false;
+            return true;
+        };
+
+        /// @brief Frees the replaced snapshots no reader can hold any more (the writer lock is held).
+        /// @return The amount of replaced snapshots left.
+        std::size_t try_reclaim() {
+            auto _ver = _version.load(std::memory_order_relaxed);
+            if (!_draining.empty() && no_readers(_ver ^ 1)) {
+                for (auto* _m : _draining)
+                    delete _m;
+                _draining.clear();
+            }
+            if (_draining.empty() && !_retired.empty() && no_readers(_ver ^ 1)) {
+                _version.store(_ver ^ 1, std::memory_order_seq_cst);
+                _draining.swap(_retired);
+                if (no_readers(_ver)) {
+                    for (auto* _m : _draining)
+                        delete _m;
+                    _draining.clear();
+                }
+            }
+            return _retired.size() + _draining.size();
+        };
+
+        /// @brief Publishes a snapshot and retires the one it replaces (the writer lock is held).
+        void swap_in(std::unique_ptr<const map_type> _m) {
+            _retired.reserve(_retired.size() + 1);
+            _retired.push_back(_current.exchange(_m.release(), std::memory_order_seq_cst));
+            try_reclaim();
+        };
+
+    public:
+
+        /// @brief Constructor, starts from an empty map.
+        snapshot_map() : _current(new map_type()) { };
+
+        /// @brief Explicit Constructor, starts from a map.
+        /// @param _m The map.
+        explicit snapshot_map(map_type _m) : _current(new map_type(std::move(_m))) { };
+
+        snapshot_map(const snapshot_map&) = delete;
+        snapshot_map& operator=(const snapshot_map&) = delete;
+
+        /// @brief Destructor, no snapshot may be held any more.
+        ~snapshot_map() {
+            for (auto* _m : _retired)
+                delete _m;
+            for (auto* _m : _draining)
+                delete _m;
+            delete _current.load(std::memory_order_relaxed);
+        };
+
+
+        ///------------- @section Reader functions. -------------///
+
+
+        /// @brief Pins the current snapshot (wait-free).
+        /// @return The snapshot, let go of when it is destroyed.
+        snapshot read() const {
+            auto* _count = &_readers[__detail::reader_index()]._count[_version.load(std::memory_order_seq_cst)];
+            _count->fetch_add(1, std::memory_order_seq_cst);
+            return snapshot(_current.load(std::memory_order_seq_cst), _count);
+        };
+
+        /// @brief Checking if the current snapshot contains a key.
+        bool contains(const k& _k) const {
+            return read()->contains(_k);
+        };
+
+        /// @brief Get a copy of the value of a key in the current snapshot.
+        /// @return The value, or std::nullopt if the key does not exist.
+        std::optional<v> get(const k& _k) const {
+            auto _s = read();
+            if (auto _it = _s->find(_k); _it != _s->end())
+                return _it->second;
+            return std::nullopt;
+        };
+
+
+        ///------------- @section Writer functions. -------------///
+
+
+        /// @brief Staging the insertion of a key and value pair (the value is replaced if the key exists), readers see it
+        ///     once the batch is committed.
+        /// @param _k Key
+        /// @param _v Value
+        void insert(const k& _k, const v& _v) {
+            std::lock_guard _l(_write);
+            _staged.emplace_back(_k, _v);
+        };
+
+        /// @brief Staging the erasure of a key, readers see it once the batch is committed.
+        /// @param _k Key
+        void erase(const k& _k) {
+            std::lock_guard _l(_write);
+            _staged.emplace_back(_k, std::nullopt);
+        };
+
+        /// @brief Get the amount of staged updates.
+        std::size_t staged() {
+            std::lock_guard _l(_write);
+            return _staged.size();
+        };
+
+        /// @brief Applies the staged updates to a copy of the current snapshot and publishes it (the last update of a
+        ///     key wins).
+        void commit() {
+            std::lock_guard _l(_write);
+            if (_staged.empty())
+                return;
+            auto _next = std::make_unique<map_type>(*_current.load(std::memory_order_relaxed));
+
+            /// Keeps the last update of every key: erasures mark their key, existing keys get their value replaced, new
+            /// keys are merged in as one batch.
+            auto _cmp = _next->key_comp();
+            std::stable_sort(_staged.begin(), _staged.end(), [&](const auto& _a, const auto& _b) { return _cmp(_a.first, _b.first); });
+            std::vector<std::pair<k, v>> _inserts;
+            for (std::size_t _i = 0; _i < _staged.size(); ++_i) {
+                if (_i + 1 < _staged.size() && !_cmp(_staged[_i].first, _staged[_i + 1].first))
+                    continue;
+                if (!_staged[_i].second)
+                    _next->erase(_staged[_i].first);
+                else if (auto _it = _next->find(_staged[_i].first); _it != _next->end())
+                    _it->second = std::move(*_staged[_i].second);
+                else
+                    _inserts.emplace_back(std::move(_staged[_i].first), std::move(*_staged[_i].second));
+            }
+            _next->compact();
+            _next->insert(sorted_unique, _inserts.begin(), _inserts.end());
+            _staged.clear();
+            swap_in(std::move(_next));
+        };
+
+        /// @brief Applies a function to a copy of the current snapshot (after the staged updates) and publishes it.
+        /// @param _fn The function, gets a map_type&.
+        template <typename fn_t>
+        void update(fn_t&& _fn) {
+            commit();
+            std::lock_guard _l(_write);
+            auto _next = std::make_unique<map_type>(*_current.load(std::memory_order_relaxed));
+            std::forward<fn_t>(_fn)(*_next);
+            swap_in(std::move(_next));
+        };
+
+        /// @brief Frees the replaced snapshots no reader holds any more (commits do this as well).
+        /// @return The amount of replaced snapshots still held by readers.
+        std::size_t reclaim() {
+            std::lock_guard _l(_write);
+            return try_reclaim();
+        };
+
+        /// @brief Publishes a whole new map, dropping the staged updates.
+        /// @param _m The map.
+        void publish(map_type _m) {
+            std::lock_guard _l(_write);
+            _staged.clear();
+            swap_in(std::make_unique<const map_type>(std::move(_m)));
+        };
+    };
+};
@@ -0,0 +1,395 @@
+/**
+ *
+ *
+ *      @author  Sean Hobeck
+ *       @date 2023-02-25
+ *
+ *
+ **/
+#pragma once
+
+/// @uses: std::string, std::wstring, std::u16string, std::u32string
+#include <string>
+
+/// @uses: std::string_view, std::wstring_view, std::u16string_view, std::u32string_view
+#include <string_view>
+
+/// @uses: std::make_unsigned_t, std::is_same_v
+#include <type_traits>
+
+/// @uses: std::memcpy
+#include <cstring>
+
+/// @uses: std::min
+#include <algorithm>
+
+/// @uses: std::uint8_t, std::uint64_t
+#include <cstdint>
+
+
+/// @brief Namespace for the "gnu/linux c++23 standard".
+namespace __gnu_cxx::v23 {
+    /// @brief The character invalid input is replaced with when transcoding (U+FFFD).
+    inline constexpr char32_t replacement_character = U'\uFFFD';
+
+    namespace __detail {
+        /// @brief The width of the vectors ASCII runs are checked and widened or narrowed with (what the target can do in one instruction).
+#if defined(__AVX2__)
+        inline constexpr std::size_t utf_vector_size = 32;
+#else
+        inline constexpr std::size_t utf_vector_size = 16;
+#endif
+
+        /// @brief Checks if a character type is a UTF encoding: char and char8_t hold UTF-8, char16_t UTF-16, char32_t UTF-32,
+        ///     and wchar_t UTF-32 (UTF-16 where it is 2 bytes wide).
+        template<typename char_t>
+        concept utf_char = std::is_same_v<char_t, char> || std::is_same_v<char_t, char8_t> || std::is_same_v<char_t, char16_t> ||
+            std::is_same_v<char_t, char32_t> || std::is_same_v<char_t, wchar_t>;
+
+        /// @brief A decoded code point.
+        struct code_point
+        {
+            /// The code point (replacement_character for invalid input).
+            char32_t value;
+            /// The amount of code units it was decoded from.
+            std::uint8_t length;
+            /// Whether the input was valid.
+            bool valid;
+        };
+
+        /// @brief Checks if any lane of a vector has a code unit past ASCII.
+        ///     The vector is ORed together a register at a time and tested once, against the bits past ASCII of every unit.
+        /// @param __v The vector.
+        /// @return Whether there is one.
+        template<typename vector_t>
+        inline bool
+        any_non_ascii(const vector_t& __v) noexcept
+        {
+            using unit_t = std::remove_cvref_t<decltype(__v[0])>;
+            constexpr std::uint64_t __mask = ~std::uint64_t(0) / static_cast<unit_t>(~unit_t(0)) * static_cast<unit_t>(~unit_t(0x7f));
+            typedef std::uint64_t word_t __attribute__((vector_size(utf_vector_size)));
+
+            word_t __w[sizeof(vector_t) / sizeof(word_t)];
+            std::memcpy(__w, &__v, sizeof(__w));
+            word_t __r = __w[0];
+            for (std::size_t __k = 1; __k < sizeof(__w) / sizeof(word_t); ++__k)
+                __r |= __w[__k];
+            std::uint64_t __x = 0;
+            for (std::size_t __k = 0; __k < sizeof(word_t) / 8; ++__k)
+                __x |= __r[__k];
+            return (__x & __mask) != 0;
+        };
+
+        /// @brief Decodes a code point of UTF-8. An invalid sequence decodes to replacement_character, over its maximal
+        ///     subpart (the longest start of a valid sequence, at least a unit), as the Unicode standard recommends.
+        /// @param __p The code units.
+        /// @param __n The amount of code units (at least one).
+        /// @return The code point.
+        template<typename char_t>
+            requires (sizeof(char_t) == 1)
+        inline code_point
+        decode(const char_t* __p, std::size_t __n) noexcept
+        {
+            auto __b = static_cast<unsigned char>(__p[0]);
+            if (__b < 0x80)
+                return { __b, 1, true };
+
+            /// The length of the sequence, the bits of the lead, and the range of the second unit (which rules out
+            ///     overlong forms, surrogates and code points past U+10FFFF).
+            std::uint8_t __len;
+            char32_t __cp;
+            unsigned char __lo = 0x80, __hi = 0xbf;
+            if (__b >= 0xc2 && __b <= 0xdf)
+            {
+                __len = 2;
+                __cp = __b & 0x1f;
+            }
+            else if (__b >= 0xe0 && __b <= 0xef)
+            {
+                __len = 3;
+                __cp = __b & 0x0f;
+                if (__b == 0xe0)
+                    __lo = 0xa0;
+                else if (__b == 0xed)
+                    __hi = 0x9f;
+            }
+            else if (__b >= 0xf0 && __b <= 0xf4)
+            {
+                __len = 4;
+                __cp = __b & 0x07;
+                if (__b == 0xf0)
+                    __lo = 0x90;
+                else if (__b == 0xf4)
+                    __hi = 0x8f;
+            }
+            else
+                return { replacement_character, 1, false };
+
+            for (std::uint8_t __i = 1; __i < __len; ++__i)
+            {
+                if (__i == __n)
+                    return { replacement_character, __i, false };
+                auto __c = static_cast<unsigned char>(__p[__i]);
+                if (__c < __lo || __c > __hi)
+                    return { replacement_character, __i, false };
+                __cp = (__cp << 6) | (__c & 0x3f);
+                __lo = 0x80;
+                __hi = 0xbf;
+            }
+            return { __cp, __len, true };
+        };
+
+        /// @brief Decodes a code point of UTF-16, a lone surrogate decodes to replacement_character.
+        template<typename char_t>
+            requires (sizeof(char_t) == 2)
+        inline code_point
+        decode(const char_t* __p, std::size_t __n) noexcept
+        {
+            char32_t __u = static_cast<char16_t>(__p[0]);
+            if (__u < 0xd800 || __u > 0xdfff)
+                return { __u, 1, true };
+            if (__u <= 0xdbff && __n > 1)
+                if (char32_t __l = static_cast<char16_t>(__p[1]); __l >= 0xdc00 && __l <= 0xdfff)
+                    return { 0x10000 + ((__u - 0xd800) << 10) + (__l - 0xdc00), 2, true };
+            return { replacement_character, 1, false };
+        };
+
+        /// @brief Decodes a code point of UTF-32, surrogates and values past U+10FFFF decode to replacement_character.
+        template<typename char_t>
+            requires (sizeof(char_t) == 4)
+        inline code_point
+        decode(const char_t* __p, std::size_t) noexcept
+        {
+            auto __u = static_cast<char32_t>(__p[0]);
+            if (__u > 0x10ffff || (__u >= 0xd800 && __u <= 0xdfff))
+                return { replacement_character, 1, false };
+            return { __u, 1, true };
+        };
+
+        /// @brief Encodes a (valid) code point.
+        /// @param __cp The code point.
+        /// @param __out The output, with room for the longest encoding.
+        /// @return The amount of code units written.
+        template<typename char_t>
+        inline std::size_t
+        encode(char32_t __cp, char_t* __out) noexcept
+        {
+            if constexpr (sizeof(char_t) == 1)
+            {
+                if (__cp < 0x80)
+                {
+                    __out[0] = static_cast<char_t>(__cp);
+                    return 1;
+                }
+                if (__cp < 0x800)
+                {
+                    __out[0] = static_cast<char_t>(0xc0 | (__cp >> 6));
+                    __out[1] = static_cast<char_t>(0x80 | (__cp & 0x3f));
+                    return 2;
+                }
+                if (__cp < 0x10000)
+                {
+                    __out[0] = static_cast<char_t>(0xe0 | (__cp >> 12));
+                    __out[1] = static_cast<char_t>(0x80 | ((__cp >> 6) & 0x3f));
+                    __out[2] = static_cast<char_t>(0x80 | (__cp & 0x3f));
+                    return 3;
+                }
+                __out[0] = static_cast<char_t>(0xf0 | (__cp >> 18));
+                __out[1] = static_cast<char_t>(0x80 | ((__cp >> 12) & 0x3f));
+                __out[2] = static_cast<char_t>(0x80 | ((__cp >> 6) & 0x3f));
+                __out[3] = static_cast<char_t>(0x80 | (__cp & 0x3f));
+                return 4;
+            }
+            else if constexpr (sizeof(char_t) == 2)
+            {
+                if (__cp < 0x10000)
+                {
+                    __out[0] = static_cast<char_t>(__cp);
+                    return 1;
+                }
+                __out[0] = static_cast<char_t>(0xd800 + ((__cp - 0x10000) >> 10));
+                __out[1] = static_cast<char_t>(0xdc00 + ((__cp - 0x10000) & 0x3ff));
+                return 2;
+            }
+            else
+            {
+                __out[0] = static_cast<char_t>(__cp);
+                return 1;
+            }
+        };
+
+        /// @brief Copies a vector of ASCII code units to another encoding, widening or narrowing each lane.
+        ///     Through an array on the stack, the loop has no aliasing to check and compiles to vector unpacks (or packs).
+        template<typename to_t, typename from_t, std::size_t __lanes>
+        inline void
+        convert_ascii(const from_t* __in, to_t* __out) noexcept
+        {
+            std::make_unsigned_t<to_t> __b[__lanes];
+            for (std::size_t __k = 0; __k < __lanes; ++__k)
+                __b[__k] = static_cast<std::make_unsigned_t<to_t>>(static_cast<std::make_unsigned_t<from_t>>(__in[__k]));
+            std::memcpy(__out, __b, sizeof(__b));
+        };
+
+        /// @brief Gets the amount of code units at the end of an input that start a sequence it does not complete
+        ///     (a chunk of a longer input ends in the middle of a code point there).
+        /// @param __p The code units.
+        /// @param __n The amount of code units.
+        /// @return The amount of code units of the incomplete sequence (0 if there is none).
+        template<typename char_t>
+        inline std::size_t
+        incomplete_tail(const char_t* __p, std::size_t __n) noexcept
+        {
+            if constexpr (sizeof(char_t) == 1)
+            {
+                /// Back over up to 3 continuation units to the lead of the last sequence.
+                for (std::size_t __k = 1; __k <= 3 && __k <= __n; ++__k)
+                {
+                    auto __b = static_cast<unsigned char>(__p[__n - __k]);
+                    if ((__b & 0xc0) == 0x80)
+                        continue;
+                    std::size_t __len = __b >= 0xf0 ? 4 : __b >= 0xe0 ? 3 : __b >= 0xc0 ? 2 : 1;
+                    return __len > __k ? __k : 0;
+                }
+                return 0;
+            }
+            else if constexpr (sizeof(char_t) == 2)
+                return __n != 0 && static_cast<char16_t>(__p[__n - 1]) >= 0xd800 && static_cast<char16_t>(__p[__n - 1]) <= 0xdbff;
+            else
+                return 0;
+        };
+    };
+
+    /// @brief Get the most code units transcoding an input can write (every input unit may turn into a replacement_character).
+    /// @tparam to_t The output character type.
+    /// @tparam from_t The input character type.
+    /// @param __n The amount of input code units.
+    /// @return The amount of output code units.
+    template<__detail::utf_char to_t, __detail::utf_char from_t>
+    constexpr std::size_t
+    max_transcoded_size(std::size_t __n) noexcept
+    {
+        if constexpr (sizeof(to_t) == 1)
+            return __n * (sizeof(from_t) == 1 ? 3 : sizeof(from_t) == 2 ? 3 : 4);
+        else if constexpr (sizeof(to_t) == 2)
+            return __n * (sizeof(from_t) == 4 ? 2 : 1);
+        else
+            return __n;
+    };
+
+    /// @brief Transcodes between UTF-8, UTF-16 and UTF-32 (wchar_t included) in one pass, invalid input is replaced
+    ///     with replacement_character. Runs of ASCII are checked and converted a vector at a time (SSE2, or AVX2 where
+    ///     the target has it), only the other code points are decoded and encoded one by one.
+    /// @tparam to_t The output character type.
+    /// @tparam from_t The input character type.
+    /// @param __in The input.
+    /// @param __n The amount of input code units.
+    /// @param __out The output, with room for max_transcoded_size<to_t, from_t>(__n) code units.
+    /// @return The amount of code units written.
+    template<__detail::utf_char to_t, __detail::utf_char from_t>
+    static std::size_t
+    transcode(const from_t* __in, std::size_t __n, to_t* __out) noexcept
+    {
+        using unit_t = std::make_unsigned_t<from_t>;
+        /// A vector of bytes at a time, however wide the code units are (wider ones take a few registers).
+        constexpr std::size_t __lanes = __detail::utf_vector_size;
+        typedef unit_t vector_t __attribute__((vector_size(__lanes * sizeof(from_t))));
+
+        std::size_t __i = 0, __w = 0;
+        while (__i < __n)
+        {
+            for (; __i + __lanes <= __n; __i += __lanes, __w += __lanes)
+            {
+                vector_t __v;
+                std::memcpy(&__v, __in + __i, sizeof(__v));
+                if (__detail::any_non_ascii(__v))
+                    break;
+                __detail::convert_ascii<to_t, from_t, __lanes>(__in + __i, __out + __w);
+            }
+
+            /// Up to the next vector, units are taken one by one (ASCII as is, the rest decoded and encoded again).
+            for (auto __end = std::min(__n, __i + __lanes); __i < __end; )
+            {
+                if (static_cast<unit_t>(__in[__i]) < 0x80)
+                {
+                    __out[__w++] = static_cast<to_t>(__in[__i++]);
+                    continue;
+                }
+                auto __cp = __detail::decode(__in + __i, __n - __i);
+                __i += __cp.length;
+                __w += __detail::encode(__cp.value, __out + __w);
+            }
+        }
+        return __w;
+    };
+
+    /// @brief Checks if an input is valid UTF (UTF-8 for char and char8_t, UTF-16 for char16_t, UTF-32 for char32_t,
+    ///     and wchar_t by its width): no overlong forms, lone surrogates or code points past U+10FFFF.
+    ///     Runs of ASCII are checked a vector at a time.
+    /// @param __p The input.
+    /// @param __n The amount of code units.
+    /// @return Whether it is valid.
+    template<__detail::utf_char char_t>
+    static bool
+    is_valid_utf(const char_t* __p, std::size_t __n) noexcept
+    {
+        using unit_t = std::make_unsigned_t<char_t>;
+        constexpr std::size_t __lanes = __detail::utf_vector_size;
+        typedef unit_t vector_t __attribute__((vector_size(__lanes * sizeof(char_t))));
+
+        std::size_t __i = 0;
+        while (__i < __n)
+        {
+            for (; __i + __lanes <= __n; __i += __lanes)
+            {
+                vector_t __v;
+                std::memcpy(&__v, __p + __i, sizeof(__v));
+                if (__detail::any_non_ascii(__v))
+                    break;
+            }
+            for (auto __end = std::min(__n, __i + __lanes); __i < __end; )
+            {
+                if (static_cast<unit_t>(__p[__i]) < 0x80)
+                {
+                    ++__i;
+                    continue;
+                }
+                auto __cp = __detail::decode(__p + __i, __n - __i);
+                if (!__cp.valid)
+                    return false;
+                __i += __cp.length;
+            }
+        }
+        return true;
+    };
+    inline bool is_valid_utf(std::string_view __s) noexcept { return is_valid_utf(__s.data(), __s.size()); };
+    inline bool is_valid_utf(std::u8string_view __s) noexcept { return is_valid_utf(__s.data(), __s.size()); };
+    inline bool is_valid_utf(std::u16string_view __s) noexcept { return is_valid_utf(__s.data(), __s.size()); };
+    inline bool is_valid_utf(std::u32string_view __s) noexcept { return is_valid_utf(__s.data(), __s.size()); };
+    inline bool is_valid_utf(std::wstring_view __s) noexcept { return is_valid_utf(__s.data(), __s.size()); };
+
+    /// @brief Transcodes an input into a string (invalid input is replaced with replacement_character).
+    /// @tparam to_t The character type of the string.
+    /// @param __s The input.
+    /// @return The string.
+    template<__detail::utf_char to_t, __detail::utf_char from_t>
+    static std::basic_string<to_t>
+    transcode_string(std::basic_string_view<from_t> __s)
+    {
+        std::basic_string<to_t> __r;
+        __r.resize_and_overwrite(max_transcoded_size<to_t, from_t>(__s.size()), [&](to_t* __p, std::size_t)
+        {
+            return transcode(__s.data(), __s.size(), __p);
+        });
+        return __r;
+    };
+
+    /// @brief Transcodes UTF-16 or UTF-32 (or wide) text to UTF-8.
+    inline std::string to_utf8(std::wstring_view __s) { return transcode_string<char>(__s); };
+    inline std::string to_utf8(std::u16string_view __s) { return transcode_string<char>(__s); };
+    inline std::string to_utf8(std::u32string_view __s) { return transcode_string<char>(__s); };
+
+    /// @brief Transcodes UTF-8 text to wide, UTF-16 or UTF-32 text.
+    inline std::wstring to_wstring(std::string_view __s) { return transcode_string<wchar_t>(__s); };
+    inline std::u16string to_u16string(std::string_view __s) { return transcode_string<char16_t>(__s); };
+    inline std::u32string to_u32string(std::string_view __s) { return transcode_string<char32_t>(__s); };
+};
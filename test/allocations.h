@@ -0,0 +1,38 @@
+#pragma once
+/// Counts calls to the global operator new, so tests can assert that a code path doesn't allocate.
+/// Replacing operator new is program-wide, include this in exactly one translation unit of a test.
+
+/// @uses: std::malloc, std::free
+#include <cstdlib>
+
+/// @uses: std::bad_alloc, std::align_val_t
+#include <new>
+
+
+/// The amount of allocations made through the global operator new so far, on this thread.
+static thread_local std::size_t allocations = 0;
+
+/// The allocation and the free behind the replacements, kept out of line so the compiler never pairs a free() it inlined
+///     into a caller with the operator new that allocated (it reports that as a mismatched allocation).
+[[gnu::noinline]] static void* allocate(std::size_t n) noexcept
+{
+    ++allocations;
+    return std::malloc(n == 0 ? 1 : n);
+}
+[[gnu::noinline]] static void deallocate(void* p) noexcept { std::free(p); }
+
+void* operator new(std::size_t n)
+{
+    if (void* p = allocate(n))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return allocate(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return allocate(n); }
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
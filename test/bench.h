@@ -0,0 +1,163 @@
+#pragma once
+/// A small timing harness for the benchmarks: runs a body many times and prints the time per call, its percentiles and
+/// the allocations per call. Set V23_BENCH_JSON to a directory to also get every result of a benchmark program in
+/// <directory>/<program>.json when it exits (make bench-json does this).
+
+/// @uses: std::sort, std::min
+#include <algorithm>
+
+/// @uses: std::chrono::steady_clock
+#include <chrono>
+
+/// @uses: program_invocation_short_name
+#include <cerrno>
+
+/// @uses: std::printf, std::fprintf, std::fopen
+#include <cstdio>
+
+/// @uses: std::getenv
+#include <cstdlib>
+
+/// @uses: std::string
+#include <string>
+
+/// @uses: std::vector
+#include <vector>
+
+/// @uses: allocations
+#include "allocations.h"
+
+
+/// @brief Keeps the optimizer from dropping a value that is never used.
+template<typename T>
+static inline void do_not_optimize(const T& v)
+{
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+/// @brief A measured value, for the JSON report.
+struct bench_result
+{
+    std::string group, name, unit;
+    /// The value: the time per call of the fastest repetition for bench(), whatever was measured for bench_report().
+    double value = 0;
+    /// Only set by bench(): the amount of timed calls, the percentiles of the time per call, the allocations per call.
+    std::size_t iterations = 0;
+    double p50 = 0, p90 = 0, p99 = 0, allocations = 0;
+};
+
+/// @brief The results of the program so far, written as JSON when it exits (if V23_BENCH_JSON is set).
+struct bench_results
+{
+    std::string group;
+    std::vector<bench_result> results;
+
+    ~bench_results()
+    {
+        const char* dir = std::getenv("V23_BENCH_JSON");
+        if (dir == nullptr || results.empty())
+            return;
+        std::string path = std::string(dir) + "/" + program_invocation_short_name + ".json";
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (file == nullptr)
+        {
+            std::fprintf(stderr, "bench: cannot write %s\n", path.c_str());
+            return;
+        }
+        auto quoted = [&](const std::string& s)
+        {
+            std::fputc('"', file);
+            for (char c : s)
+                if (c == '"' || c == '\\')
+                    std::fprintf(file, "\\%c", c);
+                else if (static_cast<unsigned char>(c) < 0x20)
+                    std::fprintf(file, "\\u%04x", c);
+                else
+                    std::fputc(c, file);
+            std::fputc('"', file);
+        };
+        std::fprintf(file, "{\n  \"program\": ");
+        quoted(program_invocation_short_name);
+        std::fprintf(file, ",\n  \"results\": [\n");
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& r = results[i];
+            std::fprintf(file, "    { \"group\": ");
+            quoted(r.group);
+            std::fprintf(file, ", \"name\": ");
+            quoted(r.name);
+            std::fprintf(file, ", \"unit\": ");
+            quoted(r.unit);
+            std::fprintf(file, ", \"value\": %.4f", r.value);
+            if (r.iterations != 0)
+                std::fprintf(file, ", \"iterations\": %zu, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"allocations\": %.4f",
+                    r.iterations, r.p50, r.p90, r.p99, r.allocations);
+            std::fprintf(file, " }%s\n", i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        std::fclose(file);
+    }
+};
+static bench_results all_results;
+
+/// @brief Starts a group of results (what the following benchmarks measure).
+static void bench_group(const std::string& group)
+{
+    all_results.group = group;
+    std::printf("-- %s\n", group.c_str());
+}
+
+/// @brief Prints and records a value measured without bench() (a rate, a size, a one-off time).
+static void bench_report(const char* name, double value, const char* unit)
+{
+    std::printf("%-40s %10.2f %s\n", name, value, unit);
+    all_results.results.push_back({ all_results.group, name, unit, value });
+}
+
+/// @brief Runs a body a tenth of the iterations to warm up, then times the rest in five repetitions and prints the
+///     nanoseconds per call of the fastest one (the others mostly measure noise from the rest of the machine).
+///
+///     The calls are timed in batches of 64 as well, the percentiles are those of the time per call of every batch
+///     (timing single calls would mostly measure the clock). The allocations are those of the calling thread.
+/// @param name What is being measured.
+/// @param iterations The amount of timed calls.
+/// @param body The call, gets the iteration index.
+template<typename body_t>
+static void bench(const char* name, std::size_t iterations, body_t&& body)
+{
+    for (std::size_t i = 0; i < iterations / 10; ++i)
+        body(i);
+
+    constexpr int repetitions = 5;
+    constexpr std::size_t batch = 64;
+    const std::size_t calls = iterations / repetitions;
+    std::vector<double> samples;
+    samples.reserve(iterations / batch + repetitions);
+    double best = 0;
+    std::size_t allocated = allocations;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto last = start;
+        for (std::size_t i = 0; i < calls; i += batch)
+        {
+            for (std::size_t j = i, end = std::min(i + batch, calls); j < end; ++j)
+                body(j);
+            auto now = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(now - last).count() / static_cast<double>(std::min(batch, calls - i)));
+            last = now;
+        }
+
+        double ns = std::chrono::duration<double, std::nano>(last - start).count() / static_cast<double>(calls);
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+    allocated = allocations - allocated;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) { return samples.empty() ? 0.0 : samples[static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1))]; };
+    bench_result result { all_results.group, name, "ns", best, calls * repetitions, percentile(0.5), percentile(0.9), percentile(0.99),
+        static_cast<double>(allocated) / static_cast<double>(calls * repetitions) };
+    std::printf("%-40s %10.2f ns   p50 %9.2f   p99 %9.2f   %6.2f allocs\n", name, result.value, result.p50, result.p99, result.allocations);
+    all_results.results.push_back(std::move(result));
+}
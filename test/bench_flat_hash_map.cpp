@@ -0,0 +1,84 @@
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include "bench.h"
+#include "../src/flat_hash_map.h"
+#include "../src/flat_map.h"
+
+
+/// @brief Gets the bytes the heap has handed out.
+static std::size_t heap_bytes()
+{
+    auto info = ::mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+/// @brief Prints the heap bytes per entry of a container built by a function.
+template<typename build_t>
+static auto measure(const char* name, std::size_t n, build_t&& build)
+{
+    auto before = heap_bytes();
+    auto container = build();
+    bench_report(name, static_cast<double>(heap_bytes() - before) / static_cast<double>(n), "B/entry");
+    return container;
+}
+
+
+/// Runs 1K to 10M keys, pass "50M" to run up to 50M keys (which takes a few GiB).
+int main(int argc, char** argv)
+{
+    constexpr std::size_t iterations = 1000000;
+
+    std::vector<std::size_t> sizes { 1000, 65536, 1 << 20, 10000000 };
+    if (argc > 1 && std::string(argv[1]) == "50M")
+        sizes.push_back(50000000);
+
+    /// Lookups of keys that are in the map and of keys that are not, in a random order.
+    std::mt19937_64 rng(12);
+    std::vector<std::uint64_t> hits(1 << 20), misses(1 << 20);
+    constexpr std::size_t mask = (1 << 20) - 1;
+
+    for (std::size_t n : sizes)
+    {
+        std::vector<std::uint64_t> keys(n);
+        for (auto& key : keys)
+            key = rng();
+        for (auto& query : hits)
+            query = keys[rng() % n];
+        for (auto& query : misses)
+            query = rng();
+
+        bench_group(std::to_string(n) + " keys");
+        {
+            auto flat = measure("v23::flat_hash_map", n, [&]()
+            {
+                __gnu_cxx::v23::flat_hash_map<std::uint64_t, std::uint64_t> map;
+                for (auto key : keys)
+                    map.insert(key, key);
+                return map;
+            });
+            bench("v23::flat_hash_map::contains (hit)", iterations, [&](std::size_t i) { do_not_optimize(flat.contains(hits[i & mask])); });
+            bench("v23::flat_hash_map::contains (miss)", iterations, [&](std::size_t i) { do_not_optimize(flat.contains(misses[i & mask])); });
+        }
+        {
+            auto hash = measure("std::unordered_map", n, [&]()
+            {
+                std::unordered_map<std::uint64_t, std::uint64_t> map;
+                for (auto key : keys)
+                    map.emplace(key, key);
+                return map;
+            });
+            bench("std::unordered_map::contains (hit)", iterations, [&](std::size_t i) { do_not_optimize(hash.contains(hits[i & mask])); });
+            bench("std::unordered_map::contains (miss)", iterations, [&](std::size_t i) { do_not_optimize(hash.contains(misses[i & mask])); });
+        }
+        {
+            auto sorted = measure("v23::flat_map", n, [&]()
+            {
+                return __gnu_cxx::v23::flat_map<std::uint64_t, std::uint64_t>(keys, keys);
+            });
+            bench("v23::flat_map::contains (hit)", iterations, [&](std::size_t i) { do_not_optimize(sorted.contains(hits[i & mask])); });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include "bench.h"
+#include "../src/mapped_flat_map.h"
+#include "../src/format.h"
+
+
+int main()
+{
+    constexpr std::size_t iterations = 1000000;
+
+    /// Lookups of keys that are in the map, in a random order (a power of two of them, so the index is a mask).
+    std::mt19937_64 rng(9);
+    std::vector<std::uint64_t> queries(1 << 20);
+    constexpr std::size_t mask = (1 << 20) - 1;
+
+    for (std::size_t n : { 16, 256, 4096, 65536, 1 << 20, 10000000 })
+    {
+        std::vector<std::uint64_t> keys(n);
+        for (auto& key : keys)
+            key = rng();
+        for (auto& query : queries)
+            query = keys[rng() % n];
+
+        bench_group(std::to_string(n) + " keys");
+        {
+            __gnu_cxx::v23::flat_map<std::uint64_t, std::uint64_t> flat(keys, keys);
+            bench("v23::flat_map::contains", iterations, [&](std::size_t i) { do_not_optimize(flat.contains(queries[i & mask])); });
+            const auto& sorted = flat.keys();
+            bench("std::binary_search (sorted vector)", iterations, [&](std::size_t i)
+                { do_not_optimize(std::binary_search(sorted.begin(), sorted.end(), queries[i & mask])); });
+        }
+        {
+            std::map<std::uint64_t, std::uint64_t> tree;
+            for (auto key : keys)
+                tree.emplace(key, key);
+            bench("std::map::contains", iterations, [&](std::size_t i) { do_not_optimize(tree.contains(queries[i & mask])); });
+        }
+        {
+            std::unordered_map<std::uint64_t, std::uint64_t> hash;
+            for (auto key : keys)
+                hash.emplace(key, key);
+            bench("std::unordered_map::contains", iterations, [&](std::size_t i) { do_not_optimize(hash.contains(queries[i & mask])); });
+        }
+    }
+
+    /// Inserting keys one by one in a random order (starting over once the map is full, so the times include every
+    /// size up to it), and iterating over the whole map.
+    for (std::size_t n : { 4096, 1 << 20 })
+    {
+        std::vector<std::uint64_t> keys(n);
+        for (auto& key : keys)
+            key = rng();
+
+        bench_group("insert, up to " + std::to_string(n) + " keys");
+        {
+            __gnu_cxx::v23::flat_map<std::uint64_t, std::uint64_t> flat;
+            bench("v23::flat_map::insert", iterations, [&](std::size_t i)
+            {
+                if (i % n == 0)
+                    flat.clear();
+                do_not_optimize(flat.insert(keys[i % n], i).second);
+            });
+        }
+        {
+            std::map<std::uint64_t, std::uint64_t> tree;
+            bench("std::map::emplace", iterations, [&](std::size_t i)
+            {
+                if (i % n == 0)
+                    tree.clear();
+                do_not_optimize(tree.emplace(keys[i % n], i).second);
+            });
+        }
+        {
+            std::unordered_map<std::uint64_t, std::uint64_t> hash;
+            bench("std::unordered_map::emplace", iterations, [&](std::size_t i)
+            {
+                if (i % n == 0)
+                    hash.clear();
+                do_not_optimize(hash.emplace(keys[i % n], i).second);
+            });
+        }
+
+        /// The time per call is per element.
+        bench_group("iterate, " + std::to_string(n) + " keys (per key)");
+        {
+            __gnu_cxx::v23::flat_map<std::uint64_t, std::uint64_t> flat(keys, keys);
+            auto it = flat.begin();
+            bench("v23::flat_map", iterations, [&](std::size_t)
+            {
+                if (it == flat.end())
+                    it = flat.begin();
+                do_not_optimize((*it++).second);
+            });
+        }
+        {
+            std::map<std::uint64_t, std::uint64_t> tree;
+            for (auto key : keys)
+                tree.emplace(key, key);
+            auto it = tree.begin();
+            bench("std::map", iterations, [&](std::size_t)
+            {
+                if (it == tree.end())
+                    it = tree.begin();
+                do_not_optimize((it++)->second);
+            });
+        }
+        {
+            std::unordered_map<std::uint64_t, std::uint64_t> hash;
+            for (auto key : keys)
+                hash.emplace(key, key);
+            auto it = hash.begin();
+            bench("std::unordered_map", iterations, [&](std::size_t)
+            {
+                if (it == hash.end())
+                    it = hash.begin();
+                do_not_optimize((it++)->second);
+            });
+        }
+    }
+
+    /// A multi map of 64K keys with 4 values each: inserting, counting the values of a key and going over them.
+    {
+        constexpr std::size_t n = 65536, values = 4;
+        std::vector<std::uint64_t> keys(n * values);
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < values; ++j)
+                keys[i * values + j] = i * 7919;
+        std::shuffle(keys.begin(), keys.end(), rng);
+
+        bench_group("multi map, " + std::to_string(n) + " keys x " + std::to_string(values) + " values");
+        {
+            __gnu_cxx::v23::flat_multi_map<std::uint64_t, std::uint64_t> flat;
+            bench("v23::flat_multi_map::insert", iterations, [&](std::size_t i)
+            {
+                if (i % keys.size() == 0)
+                    flat.clear();
+                flat.insert(keys[i % keys.size()], i);
+            });
+            bench("v23::flat_multi_map::count", iterations, [&](std::size_t i) { do_not_optimize(flat.count(keys[i % keys.size()])); });
+            bench("v23::flat_multi_map::equal_range (sum)", iterations, [&](std::size_t i)
+            {
+                std::uint64_t sum = 0;
+                for (auto [it, end] = flat.equal_range(keys[i % keys.size()]); it != end; ++it)
+                    sum += (*it).second;
+                do_not_optimize(sum);
+            });
+        }
+        {
+            std::multimap<std::uint64_t, std::uint64_t> tree;
+            bench("std::multimap::emplace", iterations, [&](std::size_t i)
+            {
+                if (i % keys.size() == 0)
+                    tree.clear();
+                tree.emplace(keys[i % keys.size()], i);
+            });
+            bench("std::multimap::count", iterations, [&](std::size_t i) { do_not_optimize(tree.count(keys[i % keys.size()])); });
+            bench("std::multimap::equal_range (sum)", iterations, [&](std::size_t i)
+            {
+                std::uint64_t sum = 0;
+                for (auto [it, end] = tree.equal_range(keys[i % keys.size()]); it != end; ++it)
+                    sum += it->second;
+                do_not_optimize(sum);
+            });
+        }
+        {
+            std::unordered_multimap<std::uint64_t, std::uint64_t> hash;
+            bench("std::unordered_multimap::emplace", iterations, [&](std::size_t i)
+            {
+                if (i % keys.size() == 0)
+                    hash.clear();
+                hash.emplace(keys[i % keys.size()], i);
+            });
+            bench("std::unordered_multimap::count", iterations, [&](std::size_t i) { do_not_optimize(hash.count(keys[i % keys.size()])); });
+            bench("std::unordered_multimap::equal_range (sum)", iterations, [&](std::size_t i)
+            {
+                std::uint64_t sum = 0;
+                for (auto [it, end] = hash.equal_range(keys[i % keys.size()]); it != end; ++it)
+                    sum += it->second;
+                do_not_optimize(sum);
+            });
+        }
+    }
+
+    /// Startup: rebuilding a 10M key map from unsorted data against mapping a saved one.
+    {
+        auto time = [](const char* name, auto&& body)
+        {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            bench_report(name, std::chrono::duration<double, std::milli>(end - start).count(), "ms");
+        };
+        std::vector<std::uint64_t> keys(10000000);
+        for (auto& key : keys)
+            key = rng();
+        std::string path = "/tmp/v23_bench_flat_map_" + std::to_string(::getpid());
+
+        bench_group("startup, " + std::to_string(keys.size()) + " keys");
+        __gnu_cxx::v23::flat_map<std::uint64_t, std::uint64_t> built;
+        time("v23::flat_map (build)", [&]() { built = __gnu_cxx::v23::flat_map<std::uint64_t, std::uint64_t>(keys, keys); });
+        time("v23::save_flat_map", [&]() { __gnu_cxx::v23::save_flat_map(built, path); });
+        time("v23::mapped_flat_map (open)", [&]()
+        {
+            __gnu_cxx::v23::mapped_flat_map<std::uint64_t, std::uint64_t> mapped(path);
+            do_not_optimize(mapped.contains(keys[0]));
+        });
+        time("v23::mapped_flat_map (open, full check)", [&]()
+        {
+            __gnu_cxx::v23::mapped_flat_map<std::uint64_t, std::uint64_t> mapped(path, __gnu_cxx::v23::map_verify::full);
+            do_not_optimize(mapped.contains(keys[0]));
+        });
+        __gnu_cxx::v23::mapped_flat_map<std::uint64_t, std::uint64_t> mapped(path);
+        bench("v23::mapped_flat_map::contains", iterations, [&](std::size_t i) { do_not_optimize(mapped.contains(keys[(i * 7919) % keys.size()])); });
+        std::remove(path.c_str());
+    }
+    /// Dumping a 100K-entry map for diagnostics: a vformat per entry appended to a string, against the whole map as one
+    /// argument (into a new string, and into a buffer that is reused), per dump.
+    {
+        __gnu_cxx::v23::flat_map<int, double> map;
+        for (int i = 0; i < 100000; ++i)
+            map.insert(i, i * 0.5);
+        bench_group("format a flat_map, 100000 entries");
+        bench("v23::vformat per entry", 20, [&](std::size_t)
+        {
+            std::string s;
+            for (auto [k, v] : map)
+                s += __gnu_cxx::v23::vformat("{}: {}, ", k, v);
+            do_not_optimize(s);
+        });
+        bench("v23::vformat (whole map)", 20, [&](std::size_t) { do_not_optimize(__gnu_cxx::v23::vformat("{}", map)); });
+        __gnu_cxx::v23::memory_buffer buf;
+        bench("v23::format_to (whole map, reused buffer)", 20, [&](std::size_t)
+        {
+            buf.clear();
+            __gnu_cxx::v23::format_to(std::back_inserter(buf), "{}", map);
+            do_not_optimize(buf.data());
+        });
+    }
+
+    /// Lookups of long string keys by a std::string_view (as parsed from a request): a std::string has to be constructed
+    /// per lookup without a transparent comparison, and prefixed keys compare most keys without their characters. Keys
+    /// that start the same way (paths) only differ after the prefix, that is where prefixes do not help.
+    for (bool paths : { false, true })
+    {
+        std::vector<std::string> keys(65536);
+        for (auto& key : keys)
+            key = paths ? __gnu_cxx::v23::vformat("/api/v1/resources/{:016x}", rng()) : __gnu_cxx::v23::vformat("{:016x}{:016x}", rng(), rng());
+        std::vector<std::string_view> views(1 << 16);
+        for (auto& view : views)
+            view = keys[rng() % keys.size()];
+
+        bench_group(std::string(paths ? "paths" : "random keys") + ", 65536 string keys of " + std::to_string(keys[0].size()) + " characters");
+        __gnu_cxx::v23::flat_map<std::string, int> plain;
+        __gnu_cxx::v23::flat_map<std::string, int, std::less<>> transparent;
+        __gnu_cxx::v23::flat_map<__gnu_cxx::v23::prefixed_string, int, std::less<>> prefixed;
+        for (auto& key : keys)
+        {
+            plain.insert(key, 1);
+            transparent.insert(key, 1);
+            prefixed.insert(__gnu_cxx::v23::prefixed_string(key), 1);
+        }
+        bench("v23::flat_map::contains(std::string(view))", iterations, [&](std::size_t i)
+        {
+            do_not_optimize(plain.contains(std::string(views[i & 0xffff])));
+        });
+        bench("v23::flat_map<.., std::less<>>::contains(view)", iterations, [&](std::size_t i)
+        {
+            do_not_optimize(transparent.contains(views[i & 0xffff]));
+        });
+        bench("v23::flat_map<prefixed_string, ..>::contains(view)", iterations, [&](std::size_t i)
+        {
+            do_not_optimize(prefixed.contains(views[i & 0xffff]));
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <clocale>
+#include <cstdio>
+#include <cmath>
+#include <cwchar>
+#include <charconv>
+#include <random>
+#include <tuple>
+#include <vector>
+#if __has_include(<format>)
+#include <format>
+#endif
+#include "bench.h"
+#include "../src/format.h"
+#include "../src/parallel_format.h"
+#include "../src/utf.h"
+
+
+int main()
+{
+    constexpr std::size_t n = 1 << 16;
+    constexpr std::size_t iterations = 2000000;
+
+    std::mt19937_64 rng(12345);
+    std::vector<int> ints(n);
+    std::vector<unsigned long long> wide(n);
+    std::vector<double> doubles(n);
+    std::vector<double> prices(n);
+    std::vector<float> floats(n);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        ints[i] = static_cast<int>(rng());
+        wide[i] = rng();
+        doubles[i] = unit(rng) * std::pow(10.0, static_cast<int>(rng() % 40) - 20);
+        prices[i] = static_cast<double>(rng() % 1000000) / 100.0;
+        floats[i] = static_cast<float>(doubles[i]);
+    }
+
+    char out[512];
+
+    bench_group("int (decimal)");
+    bench("v23::format_to {}", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "{}", ints[i % n])); });
+    bench("std::to_chars", iterations, [&](std::size_t i)
+        { do_not_optimize(std::to_chars(out, out + sizeof(out), ints[i % n]).ptr); });
+    bench("snprintf %d", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "%d", ints[i % n])); });
+
+    bench_group("unsigned long long (hex)");
+    bench("v23::format_to {:x}", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "{:x}", wide[i % n])); });
+    bench("std::to_chars base 16", iterations, [&](std::size_t i)
+        { do_not_optimize(std::to_chars(out, out + sizeof(out), wide[i % n], 16).ptr); });
+    bench("snprintf %llx", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "%llx", wide[i % n])); });
+
+    bench_group("double (shortest round trip)");
+    bench("v23::format_to {}", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "{}", doubles[i % n])); });
+    bench("std::to_chars", iterations, [&](std::size_t i)
+        { do_not_optimize(std::to_chars(out, out + sizeof(out), doubles[i % n]).ptr); });
+    bench("snprintf %.17g", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "%.17g", doubles[i % n])); });
+
+    bench_group("float (shortest round trip)");
+    bench("v23::format_to {}", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "{}", floats[i % n])); });
+    bench("std::to_chars", iterations, [&](std::size_t i)
+        { do_not_optimize(std::to_chars(out, out + sizeof(out), floats[i % n]).ptr); });
+    bench("snprintf %.9g", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "%.9g", static_cast<double>(floats[i % n]))); });
+
+    bench_group("double (fixed, precision 2)");
+    bench("v23::format_to {:.2f}", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "{:.2f}", prices[i % n])); });
+    bench("std::to_chars fixed 2", iterations, [&](std::size_t i)
+        { do_not_optimize(std::to_chars(out, out + sizeof(out), prices[i % n], std::chars_format::fixed, 2).ptr); });
+    bench("snprintf %.2f", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "%.2f", prices[i % n])); });
+
+    bench_group("double (scientific, precision 6)");
+    bench("v23::format_to {:e}", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "{:e}", doubles[i % n])); });
+    bench("std::to_chars scientific 6", iterations, [&](std::size_t i)
+        { do_not_optimize(std::to_chars(out, out + sizeof(out), doubles[i % n], std::chars_format::scientific, 6).ptr); });
+    bench("snprintf %e", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "%e", doubles[i % n])); });
+
+    bench_group("double (general, precision 6)");
+    bench("v23::format_to {:g}", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "{:g}", doubles[i % n])); });
+    bench("std::to_chars general 6", iterations, [&](std::size_t i)
+        { do_not_optimize(std::to_chars(out, out + sizeof(out), doubles[i % n], std::chars_format::general, 6).ptr); });
+    bench("snprintf %g", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "%g", doubles[i % n])); });
+
+    /// Whole strings, the way most callers format: a new string per call (which allocates once it outgrows the small
+    /// string buffer), against snprintf into a buffer and std::format (where the standard library has it).
+    bench_group("string: \"user {} logged in from {}:{} after {:.2f} s\"");
+    bench("v23::vformat", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::vformat("user {} logged in from {}:{} after {:.2f} s", ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    bench("v23::vnformat (64)", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::vnformat("user {} logged in from {}:{} after {:.2f} s", 64, ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    bench("v23::wformat", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::wformat(L"user {} logged in from {}:{} after {:.2f} s", ints[i % n], L"10.0.0.1", 8080, prices[i % n])); });
+    bench("v23::format_to (buffer)", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, "user {} logged in from {}:{} after {:.2f} s", ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    bench("snprintf (buffer)", iterations, [&](std::size_t i)
+        { do_not_optimize(std::snprintf(out, sizeof(out), "user %d logged in from %s:%d after %.2f s", ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+#if __cpp_lib_format
+    bench("std::format", iterations, [&](std::size_t i)
+        { do_not_optimize(std::format("user {} logged in from {}:{} after {:.2f} s", ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    bench("std::format_to (buffer)", iterations, [&](std::size_t i)
+        { do_not_optimize(std::format_to(out, "user {} logged in from {}:{} after {:.2f} s", ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+#endif
+
+    /// The same line from a string only known at runtime: parsed on every call, compiled once, and compiled through the
+    /// per-thread cache.
+    bench_group("runtime string: \"user {} logged in from {}:{} after {:.2f} s\"");
+    std::string configured = "user {} logged in from {}:{} after {:.2f} s";
+    __gnu_cxx::v23::compiled_format<int, const char*, int, double> compiled(configured);
+    bench("v23::format_to (runtime_format)", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, __gnu_cxx::v23::runtime_format(configured), ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    bench("v23::format_to (compiled_format)", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::format_to(out, compiled, ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    bench("v23::vformat (runtime_format)", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::vformat(__gnu_cxx::v23::runtime_format(configured), ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    bench("v23::vcformat", iterations, [&](std::size_t i)
+        { do_not_optimize(__gnu_cxx::v23::vcformat(configured, ints[i % n], "10.0.0.1", 8080, prices[i % n])); });
+    /// A CSV export of a million rows: vformat in a loop appending to one string, against format_range on pools of
+    /// 1, 2 and 4 threads (the calling thread included), in milliseconds per export.
+    bench_group("bulk: 1M rows \"{},{:.2f},{}\\n\"");
+    std::vector<std::tuple<int, double, int>> rows(1 << 20);
+    for (std::size_t i = 0; i < rows.size(); ++i)
+        rows[i] = { ints[i % n], prices[i % n], static_cast<int>(i) };
+    auto export_ms = [&](auto&& body)
+    {
+        double best = 0;
+        for (int r = 0; r < 3; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (r == 0 || ms < best)
+                best = ms;
+        }
+        return best;
+    };
+    bench_report("v23::vformat loop", export_ms([&]()
+    {
+        std::string csv;
+        for (auto& [id, price, seq] : rows)
+            csv += __gnu_cxx::v23::vformat("{},{:.2f},{}\n", id, price, seq);
+        do_not_optimize(csv);
+    }), "ms");
+    for (std::size_t threads : { 1, 2, 4 })
+    {
+        __gnu_cxx::v23::format_pool pool(threads);
+        std::string name = "v23::format_pool::join (" + std::to_string(threads) + " threads)";
+        bench_report(name.c_str(), export_ms([&]() { do_not_optimize(pool.join(rows, "{},{:.2f},{}\n")); }), "ms");
+    }
+
+    /// Transcoding 64 KiB of log text (mostly ASCII, and Greek) between UTF-8 and wchar_t, against the C library
+    /// conversions under a UTF-8 locale, and wide lines printed to /dev/null as UTF-8 against fwprintf on a wide stream.
+    std::setlocale(LC_ALL, "C.UTF-8");
+    for (const char* sample : { "user 1234 logged in from 10.0.0.1:8080 after 0.25 s, session ok\n", "αβγδε ζηθικ λμνξο πρστυ φχψω\n" })
+    {
+        std::string utf8;
+        while (utf8.size() < 65536)
+            utf8 += sample;
+        std::wstring wide = __gnu_cxx::v23::to_wstring(utf8);
+        std::vector<wchar_t> wide_out(utf8.size() + 1);
+        std::vector<char> utf8_out(wide.size() * 4 + 1);
+        bench_group(std::string(sample[0] == 'u' ? "ascii" : "greek") + " text, " + std::to_string(utf8.size()) + " bytes of UTF-8");
+        bench("v23::transcode (UTF-8 -> wchar_t)", 2000, [&](std::size_t)
+            { do_not_optimize(__gnu_cxx::v23::transcode(utf8.data(), utf8.size(), wide_out.data())); });
+        bench("std::mbstowcs", 2000, [&](std::size_t) { do_not_optimize(std::mbstowcs(wide_out.data(), utf8.c_str(), wide_out.size())); });
+        bench("v23::transcode (wchar_t -> UTF-8)", 2000, [&](std::size_t)
+            { do_not_optimize(__gnu_cxx::v23::transcode(wide.data(), wide.size(), utf8_out.data())); });
+        bench("std::wcstombs", 2000, [&](std::size_t) { do_not_optimize(std::wcstombs(utf8_out.data(), wide.c_str(), utf8_out.size())); });
+        bench("v23::is_valid_utf", 2000, [&](std::size_t) { do_not_optimize(__gnu_cxx::v23::is_valid_utf(utf8)); });
+    }
+    {
+        __gnu_cxx::v23::output_file null_file("/dev/null");
+        FILE* null_stream = std::fopen("/dev/null", "w");
+        std::fwide(null_stream, 1);
+        bench_group("wide line: L\"user {} logged in as {} after {:.2f} s\"");
+        bench("v23::println (output_file, UTF-8)", iterations, [&](std::size_t i)
+            { __gnu_cxx::v23::println(null_file, L"user {} logged in as {} after {:.2f} s", ints[i % n], L"σοφία", prices[i % n]); });
+        bench("fwprintf (wide stream)", iterations, [&](std::size_t i)
+            { std::fwprintf(null_stream, L"user %d logged in as %ls after %.2f s\n", ints[i % n], L"σοφία", prices[i % n]); });
+        std::fclose(null_stream);
+    }
+    return 0;
+}
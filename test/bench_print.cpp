@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "bench.h"
+#include "../src/async_print.h"
+#include "../src/binary_print.h"
+
+
+int main()
+{
+    constexpr std::size_t iterations = 1000000;
+
+    /// Everything goes to /dev/null, so what is measured is the formatting, buffering and system calls per line.
+    std::ofstream stream("/dev/null");
+    FILE* file = std::fopen("/dev/null", "w");
+    __gnu_cxx::v23::output_file line("/dev/null", __gnu_cxx::v23::flush_policy::line);
+    __gnu_cxx::v23::output_file threshold("/dev/null", __gnu_cxx::v23::flush_policy::threshold);
+
+    bench_group("one line: \"request {} took {:.3f} ms ({})\"");
+    bench("std::ostream << ... << std::endl", iterations, [&](std::size_t i)
+        { stream << "request " << i << " took " << i * 0.001 << " ms (" << "ok" << ")" << std::endl; });
+    bench("std::fprintf", iterations, [&](std::size_t i)
+        { std::fprintf(file, "request %zu took %.3f ms (%s)\n", i, i * 0.001, "ok"); });
+    bench("v23::println(std::ostream&)", iterations, [&](std::size_t i)
+        { __gnu_cxx::v23::println(stream, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok"); });
+    bench("v23::println(output_file&), line", iterations, [&](std::size_t i)
+        { __gnu_cxx::v23::println(line, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok"); });
+    bench("v23::println(output_file&), threshold", iterations, [&](std::size_t i)
+        { __gnu_cxx::v23::println(threshold, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok"); });
+
+    /// The calling thread only copies the arguments, with a single core the consumer runs in the same time slice
+    /// whenever the queue fills up (blocking), on more cores it runs alongside.
+    {
+        __gnu_cxx::v23::output_file file("/dev/null", __gnu_cxx::v23::flush_policy::threshold);
+        __gnu_cxx::v23::async_printer printer(file, 1 << 16);
+        bench("v23::println(async_printer&), block", iterations, [&](std::size_t i)
+            { __gnu_cxx::v23::println(printer, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok"); });
+    }
+
+    std::fclose(file);
+
+    /// The same line to a regular file (in /tmp, removed afterwards), so writes cost what they cost on a disk cache.
+    bench_group("one line, to a file");
+    std::string path = "/tmp/v23_bench_print_" + std::to_string(::getpid());
+    {
+        std::ofstream stream(path);
+        bench("std::ostream << ... << '\\n'", iterations, [&](std::size_t i)
+            { stream << "request " << i << " took " << i * 0.001 << " ms (" << "ok" << ")" << '\n'; });
+    }
+    {
+        FILE* file = std::fopen(path.c_str(), "w");
+        bench("std::fprintf", iterations, [&](std::size_t i)
+            { std::fprintf(file, "request %zu took %.3f ms (%s)\n", i, i * 0.001, "ok"); });
+        std::fclose(file);
+    }
+    {
+        __gnu_cxx::v23::output_file file(path.c_str(), __gnu_cxx::v23::flush_policy::threshold);
+        bench("v23::println(output_file&), threshold", iterations, [&](std::size_t i)
+            { __gnu_cxx::v23::println(file, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok"); });
+        bench("v23::print(output_file&), threshold", iterations, [&](std::size_t i)
+            { __gnu_cxx::v23::print(file, "request {} took {:.3f} ms ({})\n", i, i * 0.001, "ok"); });
+    }
+    std::remove(path.c_str());
+
+    /// Binary logging stores the arguments instead of formatting them, the bytes per message are against the text.
+    bench_group("one line, binary log");
+    {
+        __gnu_cxx::v23::output_file file("/dev/null", __gnu_cxx::v23::flush_policy::threshold);
+        __gnu_cxx::v23::binary_log log(file);
+        bench("v23::println(binary_log&), file", iterations, [&](std::size_t i)
+            { __gnu_cxx::v23::println(log, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok"); });
+    }
+    {
+        __gnu_cxx::v23::binary_log ring(1 << 20);
+        bench("v23::println(binary_log&), ring", iterations, [&](std::size_t i)
+            { __gnu_cxx::v23::println(ring, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok"); });
+        __gnu_cxx::v23::memory_buffer dump, text;
+        ring.dump(dump);
+        auto n = __gnu_cxx::v23::decode_binary_log(dump.view(), text);
+        bench_report("binary log bytes per message", static_cast<double>(dump.size()) / static_cast<double>(n), "B");
+        bench_report("text bytes per message", static_cast<double>(text.size()) / static_cast<double>(n), "B");
+    }
+    return 0;
+}
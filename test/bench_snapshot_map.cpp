@@ -0,0 +1,101 @@
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include "bench.h"
+#include "../src/snapshot_map.h"
+
+
+/// Reader threads look up random keys of a 64K routing table for a while, as a writer commits a batch of 64 updates
+/// every millisecond. Prints the lookups per second of all readers together, per amount of readers (1, 2, 4, ... up to
+/// the amount of cores, or the amount given as argument).
+constexpr std::size_t keys = 65536;
+constexpr auto duration = std::chrono::milliseconds(500);
+
+/// @brief Runs the readers and the writer, returns the lookups per second.
+template<typename read_t, typename write_t>
+static double run(std::size_t threads, read_t&& read, write_t&& write)
+{
+    std::atomic<bool> stop = false;
+    std::atomic<std::uint64_t> total = 0;
+    std::vector<std::thread> readers;
+    for (std::size_t t = 0; t < threads; ++t)
+        readers.emplace_back([&, t]()
+        {
+            std::mt19937_64 rng(t);
+            std::uint64_t n = 0, found = 0;
+            while (!stop.load(std::memory_order_relaxed))
+                for (int i = 0; i < 256; ++i, ++n)
+                    found += read(rng() % keys);
+            do_not_optimize(found);
+            total += n;
+        });
+    std::thread writer([&]()
+    {
+        std::mt19937_64 rng(99);
+        for (std::uint64_t tick = 0; !stop.load(std::memory_order_relaxed); ++tick)
+        {
+            write(rng, tick);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& r : readers)
+        r.join();
+    writer.join();
+    auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(total.load()) / std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t cores = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+
+    __gnu_cxx::v23::flat_map<std::uint64_t, std::uint64_t> table;
+    for (std::uint64_t key = 0; key < keys; ++key)
+        table.insert(key, key);
+
+    for (std::size_t threads = 1; threads <= cores; threads *= 2)
+    {
+        bench_group(std::to_string(threads) + " readers");
+        {
+            __gnu_cxx::v23::snapshot_map<std::uint64_t, std::uint64_t> map(table);
+            double rate = run(threads, [&](std::uint64_t key) { return map.read()->contains(key); },
+                [&](std::mt19937_64& rng, std::uint64_t tick)
+                {
+                    for (int i = 0; i < 64; ++i)
+                        map.insert(rng() % keys, tick);
+                    map.commit();
+                });
+            bench_report("v23::snapshot_map", rate / 1e6, "M/s");
+        }
+        {
+            auto map = table;
+            std::shared_mutex lock;
+            double rate = run(threads, [&](std::uint64_t key) { std::shared_lock l(lock); return map.contains(key); },
+                [&](std::mt19937_64& rng, std::uint64_t tick)
+                {
+                    std::unique_lock l(lock);
+                    for (int i = 0; i < 64; ++i)
+                        map.insert(rng() % keys, tick);
+                });
+            bench_report("v23::flat_map + std::shared_mutex", rate / 1e6, "M/s");
+        }
+        {
+            auto map = table;
+            std::mutex lock;
+            double rate = run(threads, [&](std::uint64_t key) { std::lock_guard l(lock); return map.contains(key); },
+                [&](std::mt19937_64& rng, std::uint64_t tick)
+                {
+                    std::lock_guard l(lock);
+                    for (int i = 0; i < 64; ++i)
+                        map.insert(rng() % keys, tick);
+                });
+            bench_report("v23::flat_map + std::mutex", rate / 1e6, "M/s");
+        }
+    }
+    return 0;
+}
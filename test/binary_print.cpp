@@ -0,0 +1,121 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include "../src/binary_print.h"
+
+
+/// A user-defined type, messages with one are stored as text.
+struct point
+{
+    int x, y;
+};
+template<>
+struct __gnu_cxx::v23::formatter<point, char> : __gnu_cxx::v23::formatter<int, char>
+{
+    auto format(const point& p, __gnu_cxx::v23::format_context& ctx) const
+    {
+        auto out = formatter<int, char>::format(p.x, ctx);
+        *out++ = ',';
+        ctx.advance_to(out);
+        return formatter<int, char>::format(p.y, ctx);
+    };
+};
+
+/// @brief Reads a whole file.
+static std::string read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+int main() 
+{
+    std::string path = "/tmp/v23_binary_print_" + std::to_string(::getpid());
+    std::string name = "worker";
+    int answer = -42;
+
+    /// Every kind of argument comes back as the text engine formats it, a format string is defined once.
+    std::size_t formats = 0;
+    {
+        __gnu_cxx::v23::output_file file(path.c_str(), __gnu_cxx::v23::flush_policy::manual);
+        __gnu_cxx::v23::binary_log log(file);
+        for (int i = 0; i < 3; ++i)
+            __gnu_cxx::v23::println(log, "{} {:>4} {:#x} {} {}", name, i, 255u + i, -1ll - i, 18446744073709551615ull);
+        __gnu_cxx::v23::print(log, "{:.3f}|{}|{:e}|{}|{}|{}|", 3.14159, 0.1f, 2.5L, true, 'c', "literal");
+        __gnu_cxx::v23::println(log, "{} {}", nullptr, answer);
+        __gnu_cxx::v23::println(log, "at {:>6}", point { 3, -4 });
+        formats = log.formats();
+    }
+    std::string expected =
+        "worker    0 0xff -1 18446744073709551615\n"
+        "worker    1 0x100 -2 18446744073709551615\n"
+        "worker    2 0x101 -3 18446744073709551615\n"
+        "3.142|0.1|2.500000e+00|true|c|literal|0x0 -42\n"
+        "at      3,    -4\n";
+    std::string data = read_file(path);
+    __gnu_cxx::v23::memory_buffer text;
+    if (formats == 3 && __gnu_cxx::v23::decode_binary_log(data, text) == 6 && text.view() == expected)
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 1 Failed (" << text.view() << ")" << std::endl;
+
+    /// Times come back in order, and a log cut off in the middle of a record reads up to it.
+    {
+        __gnu_cxx::v23::binary_log_reader reader(std::string_view(data).substr(0, data.size() - 3));
+        __gnu_cxx::v23::memory_buffer line;
+        std::int64_t time = 0, last = 0, now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::size_t n = 0;
+        bool ordered = true;
+        for (; reader.next(line, time); ++n, last = time)
+            ordered = ordered && time >= last && time <= now && now - time < 60000000000;
+        __gnu_cxx::v23::memory_buffer stamped;
+        __gnu_cxx::v23::decode_binary_log(data, stamped, true);
+        bool bad = false;
+        try { __gnu_cxx::v23::binary_log_reader reader("not a binary log"); } catch (const __gnu_cxx::v23::binary_log_error&) { bad = true; }
+        if (ordered && n == 5 && bad && stamped.view().starts_with("20") && stamped.view().find(" worker    0 0xff") == 29)
+            std::cout << "[+] Test 2 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 2 Failed" << std::endl;
+    }
+
+    /// A ring keeps the most recent messages (and every format string), and is smaller than the text it stands for.
+    {
+        __gnu_cxx::v23::binary_log ring(4096);
+        std::size_t bytes = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            __gnu_cxx::v23::println(ring, "request {} took {:.3f} ms ({})", i, i * 0.001, "ok");
+            bytes += __gnu_cxx::v23::formatted_size("request {} took {:.3f} ms ({})\n", i, i * 0.001, "ok");
+        }
+        __gnu_cxx::v23::memory_buffer dump, lines;
+        ring.dump(dump);
+        auto n = __gnu_cxx::v23::decode_binary_log(dump.view(), lines);
+        bool recent = lines.view().ends_with("request 999 took 0.999 ms (ok)\n") && lines.view().starts_with("request ");
+        if (recent && n + ring.evicted() == 1000 && n > 100 && 1000 * dump.size() < bytes * n)
+            std::cout << "[+] Test 3 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 3 Failed" << std::endl;
+    }
+    /// One literal logged with other argument types is defined again for them, every message decodes with its own types.
+    {
+        __gnu_cxx::v23::binary_log log(1024);
+        for (int i = 0; i < 2; ++i)
+        {
+            __gnu_cxx::v23::println(log, "{}", 42);
+            __gnu_cxx::v23::println(log, "{}", 1.5);
+            __gnu_cxx::v23::println(log, "{}", std::string_view("hello"));
+        }
+        __gnu_cxx::v23::memory_buffer dump, lines;
+        log.dump(dump);
+        __gnu_cxx::v23::decode_binary_log(dump.view(), lines);
+        if (log.formats() == 3 && lines.view() == "42\n1.5\nhello\n42\n1.5\nhello\n")
+            std::cout << "[+] Test 4 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 4 Failed (" << lines.view() << ")" << std::endl;
+    }
+    std::remove(path.c_str());
+};
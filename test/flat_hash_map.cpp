@@ -0,0 +1,148 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "../src/flat_hash_map.h"
+
+
+/// @brief A value that counts its live instances, and throws from a copy once the copies allowed have run out.
+struct fragile
+{
+    static inline int live = 0;
+    static inline int copies_left = 1 << 30;
+
+    fragile() { ++live; }
+    fragile(const fragile&)
+    {
+        if (copies_left-- == 0)
+            throw std::runtime_error("fragile: copy failed");
+        ++live;
+    }
+    fragile(fragile&&) noexcept { ++live; }
+    fragile& operator=(const fragile&) = default;
+    ~fragile() { --live; }
+};
+
+int main() 
+{
+    using map_t = __gnu_cxx::v23::flat_hash_map<int, std::string>;
+
+    map_t map;
+    for (int key : { 5, 1, 4, 2, 3 })
+        map.insert(key, std::to_string(key * 10));
+    auto [replaced, inserted] = map.insert(3, "thirty");
+    map.try_emplace(4, "forty");
+    if (!inserted && replaced->second == "thirty" && map.at(4) == "40" && map.size() == 5 && map.contains(1) && !map.contains(6))
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 1 Failed" << std::endl;
+
+    /// Iteration visits every element once with modifiable values, operator[] inserts a default value.
+    for (auto [key, value] : map)
+        value += "!";
+    map[6];
+    map.erase(2);
+    int sum = 0;
+    std::size_t visited = 0;
+    for (auto it = map.cbegin(); it != map.cend(); ++it, ++visited)
+        sum += it->first + static_cast<int>(it->second.size());
+    bool threw = false;
+    try { (void)map.at(2); } catch (const std::out_of_range&) { threw = true; }
+    if (visited == 5 && sum == 1 + 3 + 4 + 5 + 6 + 3 + 7 + 3 + 3 && map[5] == "50!" && threw)
+        std::cout << "[+] Test 2 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 2 Failed" << std::endl;
+
+    /// Random inserts, erases and lookups agree with std::unordered_map, through growing and rehashing in place.
+    {
+        std::mt19937 rng(12);
+        __gnu_cxx::v23::flat_hash_map<unsigned, unsigned> flat;
+        std::unordered_map<unsigned, unsigned> hash;
+        bool same = true;
+        for (int i = 0; i < 200000; ++i)
+        {
+            unsigned key = rng() % (i < 100000 ? 4096 : 64), value = rng();
+            switch (rng() % 3)
+            {
+                case 0: flat.insert(key, value); hash[key] = value; break;
+                case 1: same = same && flat.erase(key) == hash.erase(key); break;
+                case 2:
+                {
+                    auto f = flat.find(key);
+                    auto h = hash.find(key);
+                    same = same && (f == flat.end() ? h == hash.end() : h != hash.end() && f->second == h->second);
+                    break;
+                }
+            }
+        }
+        std::size_t count = 0;
+        for (auto [key, value] : flat)
+            same = same && hash.contains(key) && hash[key] == value && ++count;
+        if (same && count == hash.size() && flat.size() == hash.size() && flat.load_factor() <= 0.875f)
+            std::cout << "[+] Test 3 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 3 Failed" << std::endl;
+    }
+
+    /// Copies are independent, moves leave an empty table behind, erasing at an iterator moves on to the next element.
+    {
+        __gnu_cxx::v23::flat_hash_map<std::string, int> first { { "a", 1 }, { "b", 2 }, { "c", 3 }, { "a", 4 } };
+        auto copy = first;
+        copy["d"] = 5;
+        auto moved = std::move(copy);
+        std::size_t erased = 0;
+        for (auto it = moved.begin(); it != moved.end(); )
+            if (it->second % 2 == 0) { it = moved.erase(it); ++erased; } else ++it;
+        if (first.size() == 3 && first.at("a") == 4 && copy.empty() && copy.begin() == copy.end() && !copy.contains("a") &&
+            erased == 2 && moved.size() == 2 && moved.contains("c") && moved.contains("d"))
+            std::cout << "[+] Test 4 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 4 Failed" << std::endl;
+    }
+
+    /// Sets agree with std::unordered_set, and reserving up front keeps the slots in place.
+    {
+        std::mt19937_64 rng(5);
+        std::vector<std::uint64_t> keys(50000);
+        for (auto& key : keys)
+            key = rng() % 40000;
+        __gnu_cxx::v23::flat_hash_set<std::uint64_t> flat;
+        flat.reserve(40000);
+        auto capacity = flat.capacity();
+        flat.insert(keys.begin(), keys.end());
+        std::unordered_set<std::uint64_t> hash(keys.begin(), keys.end());
+        bool same = flat.size() == hash.size() && flat.capacity() == capacity;
+        for (auto key : flat)
+            same = same && hash.contains(key);
+        for (std::uint64_t key = 0; key < 40000; ++key)
+            same = same && flat.count(key) == hash.count(key);
+        flat.clear();
+        if (same && flat.empty() && !flat.contains(keys[0]) && flat.insert(keys[0]).second)
+            std::cout << "[+] Test 5 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 5 Failed" << std::endl;
+    }
+
+    /// A copy that throws partway through leaves no element of the half-built copy behind.
+    {
+        bool rolled_back = false;
+        {
+            __gnu_cxx::v23::flat_hash_map<int, fragile> source;
+            for (int key = 0; key < 100; ++key)
+                source.try_emplace(key);
+            fragile::copies_left = 50;
+            try {
+                auto copy = source;
+            }
+            catch (const std::runtime_error&) {
+                rolled_back = fragile::live == 100;
+            }
+            fragile::copies_left = 1 << 30;
+        }
+        if (rolled_back && fragile::live == 0)
+            std::cout << "[+] Test 6 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 6 Failed" << std::endl;
+    }
+};
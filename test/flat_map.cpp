@@ -0,0 +1,441 @@
+#include <iostream>
+#include <memory_resource>
+#include <map>
+#include <random>
+#include <string>
+#include "allocations.h"
+#include "../src/flat_map.h"
+#include "../src/format.h"
+
+
+/// @brief A memory resource that throws std::bad_alloc once the allocations allowed have run out.
+struct failing_resource : std::pmr::memory_resource
+{
+    int allocations_left = 1 << 30;
+
+    void* do_allocate(std::size_t n, std::size_t align) override
+    {
+        if (allocations_left-- == 0)
+            throw std::bad_alloc();
+        return std::pmr::new_delete_resource()->allocate(n, align);
+    }
+    void do_deallocate(void* p, std::size_t n, std::size_t align) override { std::pmr::new_delete_resource()->deallocate(p, n, align); }
+    bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+};
+
+int main() 
+{
+    using map_t = __gnu_cxx::v23::flat_map<int, std::string>;
+
+    map_t map;
+    for (int key : { 5, 1, 4, 2, 3 })
+        map.insert(key, std::to_string(key * 10));
+    if (map.keys() == std::vector<int>{ 1, 2, 3, 4, 5 } && map.values() == std::vector<std::string>{ "10", "20", "30", "40", "50" })
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 1 Failed" << std::endl;
+
+    /// Inserting an existing key replaces its value, try_emplace keeps it.
+    auto [replaced, inserted] = map.insert(3, "thirty");
+    map.try_emplace(4, "forty");
+    if (!inserted && replaced->second == "thirty" && map.at(4) == "40" && map.size() == 5)
+        std::cout << "[+] Test 2 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 2 Failed" << std::endl;
+
+    map.erase(2);
+    map.insert(8, "80");
+    if (map.find(2) == map.end() && map.find(8)->second == "80" && map.lower_bound(2)->first == 3 &&
+        map.upper_bound(5)->first == 8 && map.upper_bound(8) == map.end() && !map.contains(6) && map.count(1) == 1)
+        std::cout << "[+] Test 3 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 3 Failed" << std::endl;
+
+    /// Iteration gives keys in order with modifiable values, operator[] inserts a default value.
+    for (auto [key, value] : map)
+        value += "!";
+    map[6];
+    std::string all;
+    for (auto it = map.cbegin(); it != map.cend(); ++it)
+        all += std::to_string(it->first) + "=" + it->second + " ";
+    bool threw = false;
+    try { (void)map.at(7); } catch (const std::out_of_range&) { threw = true; }
+    if (all == "1=10! 3=thirty! 4=40! 5=50! 6= 8=80! " && threw)
+        std::cout << "[+] Test 4 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 4 Failed" << std::endl;
+
+    /// Random inserts, erases and lookups agree with std::map.
+    {
+        std::mt19937 rng(23);
+        __gnu_cxx::v23::flat_map<unsigned, unsigned> flat;
+        std::map<unsigned, unsigned> tree;
+        bool same = true;
+        for (int i = 0; i < 20000; ++i)
+        {
+            unsigned key = rng() % 512, value = rng();
+            switch (rng() % 3)
+            {
+                case 0: flat.insert(key, value); tree[key] = value; break;
+                case 1: same = same && flat.erase(key) == tree.erase(key); break;
+                case 2:
+                {
+                    auto f = flat.lower_bound(key);
+                    auto t = tree.lower_bound(key);
+                    same = same && (f == flat.end() ? t == tree.end() : t != tree.end() && f->first == t->first && f->second == t->second);
+                    break;
+                }
+            }
+        }
+        same = same && flat.size() == tree.size() && std::equal(flat.begin(), flat.end(), tree.begin(),
+            [](auto a, const auto& b) { return a.first == b.first && a.second == b.second; });
+        if (same)
+            std::cout << "[+] Test 5 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 5 Failed" << std::endl;
+    }
+
+    __gnu_cxx::v23::flat_multi_map<int, int> multi;
+    multi.insert(1, 10);
+    multi.insert(1, 11);
+    multi.insert(2, 20);
+    if (multi.count(1) == 2 && multi.count(3) == 0 && std::ranges::equal(multi[1], std::vector<int>{ 10, 11 }))
+        std::cout << "[+] Test 6 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 6 Failed" << std::endl;
+
+    /// Bulk construction and insertion match inserting the pairs one by one (the last value of a key wins).
+    {
+        std::mt19937 rng(8);
+        std::vector<std::pair<int, int>> first, second;
+        for (int i = 0; i < 5000; ++i)
+            first.emplace_back(static_cast<int>(rng() % 3000), i);
+        for (int i = 0; i < 5000; ++i)
+            second.emplace_back(static_cast<int>(rng() % 6000), -i);
+
+        __gnu_cxx::v23::flat_map<int, int> bulk(first.begin(), first.end()), single;
+        bulk.insert(second.begin(), second.end());
+        for (auto& [key, value] : first)
+            single.insert(key, value);
+        for (auto& [key, value] : second)
+            single.insert(key, value);
+
+        __gnu_cxx::v23::flat_map<int, int> adopted(__gnu_cxx::v23::sorted_unique, single.keys(), single.values());
+        __gnu_cxx::v23::flat_map<int, char> listed { { 3, 'c' }, { 1, 'a' }, { 2, 'b' }, { 1, 'A' } };
+        if (bulk.keys() == single.keys() && bulk.values() == single.values() && adopted.keys() == single.keys() &&
+            listed.keys() == std::vector<int>{ 1, 2, 3 } && listed.values() == std::vector<char>{ 'A', 'b', 'c' })
+            std::cout << "[+] Test 7 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 7 Failed" << std::endl;
+    }
+
+    /// Multi maps keep every value, equal keys in the order they were inserted.
+    {
+        std::vector<std::pair<int, int>> pairs { { 2, 0 }, { 1, 1 }, { 2, 2 }, { 1, 3 }, { 0, 4 } };
+        __gnu_cxx::v23::flat_multi_map<int, int> bulk(pairs.begin(), pairs.end());
+        std::vector<std::pair<int, int>> more { { 1, 5 }, { 3, 6 } };
+        bulk.insert(__gnu_cxx::v23::sorted_equivalent, more.begin(), more.end());
+        __gnu_cxx::v23::flat_multi_map<int, int> adopted(__gnu_cxx::v23::sorted_equivalent, { 1, 1, 2 }, { 7, 8, 9 });
+        if (bulk.keys() == std::vector<int>{ 0, 1, 1, 1, 2, 2, 3 } && bulk.values() == std::vector<int>{ 4, 1, 3, 5, 0, 2, 6 } &&
+            adopted.count(1) == 2 && std::ranges::equal(adopted[2], std::vector<int>{ 9 }))
+            std::cout << "[+] Test 8 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 8 Failed" << std::endl;
+    }
+
+    /// The integer search kernels (linear scans for short maps, branchless binary search for longer ones) agree with
+    /// std::lower_bound and std::upper_bound for every key width and size.
+    {
+        std::mt19937_64 rng(9);
+        bool same = true;
+        auto check = [&]<typename T>(T)
+        {
+            for (std::size_t n : { 0, 1, 2, 7, 16, 33, 64, 129, 1000, 70000 })
+            {
+                std::vector<T> keys(n);
+                for (auto& key : keys)
+                    key = static_cast<T>(rng() % (n * 2 + 1)) - static_cast<T>(std::is_signed_v<T> ? n : 0);
+                std::sort(keys.begin(), keys.end());
+                __gnu_cxx::v23::flat_multi_map<T, int> multi(__gnu_cxx::v23::sorted_equivalent, keys, std::vector<int>(n));
+                for (int i = 0; i < 200; ++i)
+                {
+                    T key = static_cast<T>(rng() % (n * 2 + 3)) - static_cast<T>(std::is_signed_v<T> ? n + 1 : 0);
+                    auto lower = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+                    auto upper = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+                    same = same && multi.lower_bound(key) - multi.begin() == lower && multi.upper_bound(key) - multi.begin() == upper;
+                }
+            }
+        };
+        check(std::int8_t()); check(std::uint16_t()); check(std::int32_t()); check(std::uint32_t()); check(std::int64_t()); check(std::uint64_t());
+        if (same)
+            std::cout << "[+] Test 9 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 9 Failed" << std::endl;
+    }
+
+    /// equal_range, count and the value views agree with std::multimap, for runs of equal keys of any length.
+    {
+        std::mt19937 rng(10);
+        std::vector<std::pair<int, int>> pairs;
+        for (int key = 0; key < 200; ++key)
+            for (int n = key % 37 == 0 ? 300 : key % 5; n > 0; --n)
+                pairs.emplace_back(key * 2, static_cast<int>(rng()));
+        std::shuffle(pairs.begin(), pairs.end(), rng);
+
+        __gnu_cxx::v23::flat_multi_map<int, int> multi(pairs.begin(), pairs.end());
+        std::multimap<int, int> tree(pairs.begin(), pairs.end());
+        bool same = true;
+        for (int key = -1; key < 402; ++key)
+        {
+            auto [fb, fe] = multi.equal_range(key);
+            auto [tb, te] = tree.equal_range(key);
+            std::vector<int> expected;
+            for (; tb != te; ++tb)
+                expected.push_back(tb->second);
+            same = same && multi.count(key) == tree.count(key) && static_cast<std::size_t>(fe - fb) == expected.size() &&
+                std::ranges::equal(std::as_const(multi)[key], expected);
+        }
+
+        /// Views are modifiable through a non-const multi map.
+        for (auto& value : multi[74])
+            value = 0;
+        same = same && std::ranges::all_of(multi[74], [](int value) { return value == 0; }) && multi[75].empty();
+        if (same)
+            std::cout << "[+] Test 10 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 10 Failed" << std::endl;
+    }
+
+    /// Erases only mark elements until a compaction, whatever the ratio that triggers it the map agrees with std::map.
+    {
+        std::mt19937 rng(11);
+        bool same = true;
+        for (float ratio : { 0.0f, 0.25f, 1.0f })
+        {
+            __gnu_cxx::v23::flat_map<int, int> flat;
+            flat.max_tombstone_ratio(ratio);
+            std::map<int, int> tree;
+            auto agree = [&]()
+            {
+                return flat.size() == tree.size() && std::equal(flat.begin(), flat.end(), tree.begin(), tree.end(),
+                    [](auto a, const auto& b) { return a.first == b.first && a.second == b.second; });
+            };
+            for (int i = 0; i < 20000; ++i)
+            {
+                int key = static_cast<int>(rng() % 700), value = static_cast<int>(rng());
+                switch (rng() % 8)
+                {
+                    case 0: case 1: flat.insert(key, value); tree[key] = value; break;
+                    case 2: flat.try_emplace(key, value); tree.try_emplace(key, value); break;
+                    case 3: case 4: same = same && flat.erase(key) == tree.erase(key); break;
+                    case 5:
+                    {
+                        auto f = flat.lower_bound(key);
+                        auto t = tree.lower_bound(key);
+                        if (f != flat.end())
+                        {
+                            same = same && t != tree.end() && t->first == f->first;
+                            auto next = flat.erase(f);
+                            t = tree.erase(t);
+                            same = same && (next == flat.end() ? t == tree.end() : t != tree.end() && next->first == t->first);
+                        }
+                        break;
+                    }
+                    case 6:
+                    {
+                        auto f = flat.erase(flat.lower_bound(key), flat.lower_bound(key + 5));
+                        auto t = tree.erase(tree.lower_bound(key), tree.lower_bound(key + 5));
+                        same = same && (f == flat.end() ? t == tree.end() : t != tree.end() && f->first == t->first);
+                        break;
+                    }
+                    case 7:
+                        same = same && flat.contains(key) == tree.contains(key) && flat.count(key) == tree.count(key) &&
+                            (flat.find(key) == flat.end() || flat.at(key) == tree.at(key));
+                        break;
+                }
+                if (i % 1000 == 0)
+                    same = same && agree();
+            }
+            auto odd = [](auto e) { return e.second % 2 != 0; };
+            same = same && flat.erase_if(odd) == std::erase_if(tree, odd) && agree();
+            flat.erase(flat.begin());
+            tree.erase(tree.begin());
+            flat.compact();
+            same = same && agree() && flat.keys().size() == tree.size();
+        }
+
+        /// The iterator arithmetic counts the elements that are not erased: distances agree with size() and count(),
+        ///     and std::lower_bound() never lands on an erased element.
+        __gnu_cxx::v23::flat_map<int, int> small;
+        for (int i = 0; i < 10; ++i)
+            small.insert(i, i);
+        small.erase(3);
+        small.erase(7);
+        auto key_less = [](const auto& e, int k) { return e.first < k; };
+        auto [b3, e3] = small.equal_range(3);
+        auto [b4, e4] = small.equal_range(4);
+        same = same && std::distance(small.begin(), small.end()) == 8 && small.end() - small.begin() == 8 &&
+            std::distance(b3, e3) == 0 && std::distance(b4, e4) == 1 &&
+            std::lower_bound(small.begin(), small.end(), 3, key_less)->first == 4 &&
+            std::lower_bound(small.begin(), small.end(), 7, key_less)->first == 8 && (small.begin() + 3)->first == 4 &&
+            small.begin()[6].first == 8 && (small.end() - 1)->first == 9 && (small.end() - 3)->first == 6 &&
+            std::ranges::subrange(small.begin(), small.end()).size() == small.size();
+
+        /// Erased elements across several words of positions.
+        __gnu_cxx::v23::flat_map<int, int> big;
+        std::vector<int> live;
+        for (int i = 0; i < 300; ++i)
+            big.insert(i, i);
+        for (int i = 0; i < 300; ++i)
+        {
+            if (i % 5 == 0 || (i >= 64 && i < 70))
+                big.erase(i);
+            else
+                live.push_back(i);
+        }
+        same = same && big.size() == live.size() && std::distance(big.begin(), big.end()) == static_cast<std::ptrdiff_t>(live.size());
+        for (std::size_t i = 0; same && i < live.size(); ++i)
+        {
+            auto it = big.begin() + static_cast<std::ptrdiff_t>(i);
+            auto back = big.end() - static_cast<std::ptrdiff_t>(live.size() - i);
+            same = it->first == live[i] && back == it && it - big.begin() == static_cast<std::ptrdiff_t>(i) &&
+                big.begin() - it == -static_cast<std::ptrdiff_t>(i) && std::lower_bound(big.begin(), big.end(), live[i], key_less) == it;
+        }
+        if (same)
+            std::cout << "[+] Test 11 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 11 Failed" << std::endl;
+    }
+
+    /// Maps over an arena take everything from it: their elements, the values' own memory, bulk insert scratch space and
+    /// erased bits, and copies into another arena carry their elements over.
+    {
+        static char storage[1 << 20];
+        std::pmr::monotonic_buffer_resource arena(storage, sizeof(storage), std::pmr::null_memory_resource());
+        std::vector<std::pair<int, int>> pairs;
+        for (int i = 0; i < 2000; ++i)
+            pairs.emplace_back((i * 7919) % 3000, i);
+
+        auto before = allocations;
+        __gnu_cxx::v23::pmr::flat_map<int, std::pmr::string> map(&arena);
+        for (auto [key, value] : pairs)
+            map.insert(key, std::pmr::string(200, static_cast<char>('a' + value % 26)));
+        __gnu_cxx::v23::pmr::flat_map<int, int> bulk(pairs.begin(), pairs.end(), &arena);
+        bulk.insert(pairs.rbegin(), pairs.rbegin() + 100);
+        for (int key = 0; key < 3000; key += 3)
+            bulk.erase(key);
+        __gnu_cxx::v23::pmr::flat_multi_map<int, int> multi({ { 2, 1 }, { 1, 2 }, { 2, 3 } }, &arena);
+        __gnu_cxx::v23::pmr::flat_map<int, int> moved(std::move(bulk), &arena);
+        bool arena_only = allocations == before;
+
+        std::pmr::unsynchronized_pool_resource other;
+        __gnu_cxx::v23::pmr::flat_map<int, std::pmr::string> copy(map, &other);
+        if (arena_only && map.size() == 2000 && map.at(7919 % 3000).size() == 200 &&
+            map.values()[0].get_allocator().resource() == &arena && moved.size() == 2000 - 667 && !moved.contains(3) &&
+            multi.count(2) == 2 && copy.keys() == map.keys() && copy.values()[5] == map.values()[5] &&
+            copy.values()[5].get_allocator().resource() == &other)
+            std::cout << "[+] Test 12 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 12 Failed" << std::endl;
+    }
+
+    /// Flat maps format like maps, straight into the output: nothing is allocated formatting into a buffer that is big
+    /// enough already, whatever the size of the map.
+    {
+        __gnu_cxx::v23::flat_map<int, std::string> map;
+        map.insert(2, "two");
+        map.insert(1, "one");
+        map.insert(3, "three");
+        map.erase(3);
+        __gnu_cxx::v23::flat_multi_map<std::string, int> multi;
+        multi.insert("k", 1);
+        multi.insert("j", 2);
+        multi.insert("k", 3);
+        __gnu_cxx::v23::flat_map<int, int> large;
+        for (int i = 0; i < 100000; ++i)
+            large.insert(i, i * 2);
+        __gnu_cxx::v23::memory_buffer buf;
+        buf.reserve(2000000);
+        auto before = allocations;
+        __gnu_cxx::v23::format_to(std::back_inserter(buf), "{:n::#x}", large);
+        bool quiet = allocations == before;
+        if (quiet && __gnu_cxx::v23::vformat("{}", map) == "{1: \"one\", 2: \"two\"}" &&
+            __gnu_cxx::v23::vformat("{} {:n}", multi, multi) == "{\"j\": 2, \"k\": 1, \"k\": 3} \"j\": 2, \"k\": 1, \"k\": 3" &&
+            buf.view().starts_with("0x0: 0x0, 0x1: 0x2, ") && buf.view().ends_with("0x1869f: 0x30d3e"))
+            std::cout << "[+] Test 13 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 13 Failed" << std::endl;
+    }
+
+    /// Maps with a transparent comparison are looked up with string views and C strings without constructing a key, a
+    /// key is only constructed by operator[] when it is inserted. Prefixed string keys order like their strings.
+    {
+        std::string long_key(40, 'x');
+        __gnu_cxx::v23::flat_map<std::string, int, std::less<>> map;
+        map.insert("alpha", 1);
+        map.insert(long_key + "b", 2);
+        map.insert(long_key + "a", 3);
+        __gnu_cxx::v23::flat_multi_map<std::string, int, std::less<>> multi;
+        multi.insert(long_key, 1);
+        multi.insert(long_key, 2);
+        multi.insert("beta", 3);
+        std::string probe = long_key + "a";
+        std::string_view view = probe;
+        auto before = allocations;
+        bool found = map.contains(view) && !map.contains("alph") && map.count("alpha") == 1 && map.at(view) == 3 &&
+            map["alpha"] == 1 && map.find(std::string_view(long_key)) == map.end() && map.lower_bound(std::string_view(long_key))->second == 3 &&
+            map.upper_bound(view)->second == 2 && map.equal_range("alpha").first->second == 1 && multi.count(std::string_view(long_key)) == 2 &&
+            multi[std::string_view(long_key)].size() == 2 && multi["beta"][0] == 3 && multi.equal_range("zeta").first == multi.end();
+        bool quiet = allocations == before;
+        map[std::string_view("gamma")] = 4;
+        bool inserted = map.size() == 4 && map.keys()[1] == "gamma" && map.try_emplace(view, 9).second == false;
+
+        std::vector<std::string> words = { "", "a", std::string("a\0", 2), "abcdefgh", "abcdefg", "abcdefghi", std::string("abcdefgh\0", 9),
+            long_key + "a", long_key, long_key + "b", "b", std::string(8, '\0'), "\xff", "\x7f" };
+        __gnu_cxx::v23::flat_map<__gnu_cxx::v23::prefixed_string, std::size_t, std::less<>> prefixed;
+        for (std::size_t i = 0; i < words.size(); ++i)
+            prefixed.insert(__gnu_cxx::v23::prefixed_string(words[i]), i);
+        std::vector<std::string> sorted(words);
+        std::sort(sorted.begin(), sorted.end());
+        bool ordered = prefixed.size() == words.size();
+        for (std::size_t i = 0; ordered && i < sorted.size(); ++i)
+            ordered = prefixed.keys()[i].str() == sorted[i] && prefixed.at(std::string_view(sorted[i])) < words.size();
+        before = allocations;
+        bool prefixed_found = prefixed.contains(view) && !prefixed.contains("abcdef") && prefixed.at("abcdefgh") == 3 &&
+            prefixed.count(long_key) == 1 && prefixed.find("a")->first == "a";
+        bool prefixed_quiet = allocations == before;
+        if (found && quiet && inserted && ordered && prefixed_found && prefixed_quiet)
+            std::cout << "[+] Test 14 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 14 Failed" << std::endl;
+    }
+
+    /// A bulk insert that runs out of memory at any allocation leaves the map as it was before, sorted and whole.
+    {
+        bool intact = true;
+        std::vector<std::pair<int, int>> batch = { { 9, 90 }, { 2, 20 }, { 7, 70 }, { 4, 40 }, { 11, 110 }, { 0, 0 } };
+        for (int budget = 0; budget < 16 && intact; ++budget)
+        {
+            failing_resource resource;
+            __gnu_cxx::v23::pmr::flat_map<int, int> map(&resource);
+            for (int key : { 1, 3, 5, 8, 10 })
+                map.insert(key, key * 10);
+            auto keys = std::vector<int>(map.keys().begin(), map.keys().end());
+            resource.allocations_left = budget;
+            try {
+                map.insert(batch.begin(), batch.end());
+                resource.allocations_left = 1 << 30;
+                intact = map.size() == 11 && std::is_sorted(map.keys().begin(), map.keys().end()) && map.at(7) == 70;
+            }
+            catch (const std::bad_alloc&) {
+                resource.allocations_left = 1 << 30;
+                intact = std::equal(map.keys().begin(), map.keys().end(), keys.begin(), keys.end()) && map.at(5) == 50 &&
+                    map.values().size() == keys.size() && map.insert(6, 60).second && map.at(6) == 60;
+            }
+        }
+        if (intact)
+            std::cout << "[+] Test 15 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 15 Failed" << std::endl;
+    }
+};
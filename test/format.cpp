@@ -1,46 +1,234 @@
+#include <array>
 #include <iostream>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+#include "allocations.h"
 #include "../src/format.h"
 
+using namespace std::string_literals;
+
 
 int main() 
 {
-    if (auto str = __gnu_cxx::v23::vformat("%x  ", 12); str == std::string("c  "))
+    if (auto str = __gnu_cxx::v23::vformat("{:x}  ", 12); str == std::string("c  "))
         std::cout << "[+] Test 1 Passing" << std::endl;
     else 
         std::cout << "[-] Test 1 Failed" << std::endl;
 
-    if (auto str = __gnu_cxx::v23::vformat("%d", 14882); str == std::string("14882"))
+    if (auto str = __gnu_cxx::v23::vformat("{}", 14882); str == std::string("14882"))
         std::cout << "[+] Test 2 Passing" << std::endl;
     else 
         std::cout << "[-] Test 2 Failed" << std::endl;
 
-    if (auto str = __gnu_cxx::v23::vformat("%c", 78); str == std::string("N"))
+    if (auto str = __gnu_cxx::v23::vformat("{:c}", 78); str == std::string("N"))
         std::cout << "[+] Test 3 Passing" << std::endl;
     else 
         std::cout << "[-] Test 3 Failed" << std::endl;
 
-    if (auto str = __gnu_cxx::v23::vformat("Hello, %s!", "World"); str == std::string("Hello, World!"))
+    if (auto str = __gnu_cxx::v23::vformat("Hello, {}!", "World"); str == std::string("Hello, World!"))
         std::cout << "[+] Test 4 Passing" << std::endl;
     else 
         std::cout << "[-] Test 4 Failed" << std::endl;
 
-    if (auto str = __gnu_cxx::v23::vformat("%s  %X", "()", 0xabc); str == std::string("()  ABC"))
+    if (auto str = __gnu_cxx::v23::vformat("{}  {:X}", "()", 0xabc); str == std::string("()  ABC"))
         std::cout << "[+] Test 5 Passing" << std::endl;
     else 
         std::cout << "[-] Test 5 Failed" << std::endl;
 
-    if (auto str = __gnu_cxx::v23::vnformat("%s", 7, "This sentence is going to be cut off..."); str == std::string("This s"))
+    if (auto str = __gnu_cxx::v23::vnformat("{}", 7, "This sentence is going to be cut off..."); str == std::string("This s"))
         std::cout << "[+] Test 6 Passing" << std::endl;
     else 
         std::cout << "[-] Test 6 Failed" << std::endl;
 
-    if (auto str = __gnu_cxx::v23::vnformat("%c%c%c", 3, 32, 32, 32); str == std::string("  "))
+    if (auto str = __gnu_cxx::v23::vnformat("{:c}{:c}{:c}", 3, 32, 32, 32); str == std::string("  "))
         std::cout << "[+] Test 7 Passing" << std::endl;
     else 
         std::cout << "[-] Test 7 Failed" << std::endl;
 
-    if (auto str = __gnu_cxx::v23::vformat("%f", 0.0123); str == std::string("0.012300"))
+    if (auto str = __gnu_cxx::v23::vformat("{:f}", 0.0123); str == std::string("0.012300"))
         std::cout << "[+] Test 8 Passing" << std::endl;
     else 
         std::cout << "[-] Test 8 Failed" << std::endl;
+
+    if (auto str = __gnu_cxx::v23::vformat("{1}-{0}-{1} {{}}", 'a', 2.5); str == std::string("2.5-a-2.5 {}"))
+        std::cout << "[+] Test 9 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 9 Failed" << std::endl;
+
+    if (auto str = __gnu_cxx::v23::vformat("[{:*^9}|{:<5}|{:+06d}|{:#x}|{:>{}}]", "mid", true, 42, 255, 7, 3); str == std::string("[***mid***|true |+00042|0xff|  7]"))
+        std::cout << "[+] Test 10 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 10 Failed" << std::endl;
+
+    if (auto str = __gnu_cxx::v23::vformat("{:.3} {:e} {:g} {:.2f} {}", 3.14159, 1500.0, 0.0001, -2.005, 1e300); str == std::string("3.14 1.500000e+03 0.0001 -2.00 1e+300"))
+        std::cout << "[+] Test 11 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 11 Failed" << std::endl;
+
+    if (auto str = __gnu_cxx::v23::wformat(L"{} {:>4} {}", L"wide", 12, L'c'); str == std::wstring(L"wide   12 c"))
+        std::cout << "[+] Test 12 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 12 Failed" << std::endl;
+
+    try {
+        (void) __gnu_cxx::v23::vformat(__gnu_cxx::v23::runtime_format("{} {}"), 1);
+        std::cout << "[-] Test 13 Failed" << std::endl;
+    }
+    catch (const __gnu_cxx::v23::format_error&) {
+        std::cout << "[+] Test 13 Passing" << std::endl;
+    }
+
+    if (char buf[32] = {}; __gnu_cxx::v23::format_to(buf, "{}-{}", 12, "ab") == buf + 5 && std::string(buf) == "12-ab")
+        std::cout << "[+] Test 14 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 14 Failed" << std::endl;
+
+    if (std::string str = "> "; __gnu_cxx::v23::format_to(std::back_inserter(str), "{:>5}", 3.5), str == "> "s + "  3.5")
+        std::cout << "[+] Test 15 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 15 Failed" << std::endl;
+
+    if (char buf[8] = {}; __gnu_cxx::v23::format_to_n(buf, 4, "{}", 1234567).size == 7 && std::string(buf) == "1234")
+        std::cout << "[+] Test 16 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 16 Failed" << std::endl;
+
+    if (__gnu_cxx::v23::formatted_size("{:08.3f}|{}", 2.0, "four") == 13)
+        std::cout << "[+] Test 17 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 17 Failed" << std::endl;
+
+    if (auto buf = std::make_shared<std::string>(); buf->reserve(64), __gnu_cxx::v23::vsformat(buf, "{} {}", "first", 1), *buf == "first 1")
+    {
+        auto data = buf->data();
+        __gnu_cxx::v23::vsformat(buf, "{}", 2);
+        __gnu_cxx::v23::vsnformat(buf, "{}", 4, "truncated");
+        if (*buf == "tru" && buf->data() == data)
+            std::cout << "[+] Test 18 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 18 Failed" << std::endl;
+    }
+    else 
+        std::cout << "[-] Test 18 Failed" << std::endl;
+
+    if (auto before = allocations; __gnu_cxx::v23::vformat("{}:{}", "id", 7).size() == 4 && allocations == before)
+        std::cout << "[+] Test 19 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 19 Failed" << std::endl;
+
+    if (auto before = allocations; true)
+    {
+        __gnu_cxx::v23::basic_memory_buffer<char, 16> buf;
+        __gnu_cxx::v23::format_to(std::back_inserter(buf), "{:08x}", 0xbeef);
+        bool inline_ok = buf.view() == "0000beef" && allocations == before;
+        __gnu_cxx::v23::format_to(std::back_inserter(buf), "{:>64}", "spill");
+        if (inline_ok && buf.size() == 72 && buf.capacity() >= 72 && allocations > before)
+            std::cout << "[+] Test 20 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 20 Failed" << std::endl;
+    }
+
+    if (auto str = __gnu_cxx::v23::vformat("{} {} {:x} {:#b} {:o} {:+}", -9223372036854775807ll - 1, 18446744073709551615ull, 0xdeadbeefu, 5, 8, 0);
+        str == std::string("-9223372036854775808 18446744073709551615 deadbeef 0b101 10 +0"))
+        std::cout << "[+] Test 21 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 21 Failed" << std::endl;
+
+    if (auto str = __gnu_cxx::v23::vformat("{} {} {} {} {} {}", 0.1, 5e-324, 1e23, 0.3f, 123456789012345678.0, 1e-5);
+        str == std::string("0.1 5e-324 1e+23 0.3 123456789012345680 1e-05"))
+        std::cout << "[+] Test 22 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 22 Failed" << std::endl;
+
+    if (auto str = __gnu_cxx::v23::vformat("{:.0f} {:.0f} {:.2f} {:.3e} {:.17g} {:.20f} {:#.3g}", 0.5, 2.5, 1.005, 5e-324, 0.1, 0.1, 100.0);
+        str == std::string("0 2 1.00 4.941e-324 0.10000000000000001 0.10000000000000000555 100."))
+        std::cout << "[+] Test 23 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 23 Failed" << std::endl;
+
+    /// Strings formatted into an arena take all of their memory from it, long ones as well.
+    {
+        char storage[4096];
+        std::pmr::monotonic_buffer_resource arena(storage, sizeof(storage), std::pmr::null_memory_resource());
+        std::string line(600, '-');
+        auto before = allocations;
+        auto str = __gnu_cxx::v23::vformat(&arena, "{}|{:>4}", line, 42);
+        auto wstr = __gnu_cxx::v23::wformat(&arena, L"{} {}", 1.5, L"w");
+        if (str.size() == 605 && str.ends_with("|  42") && str.get_allocator().resource() == &arena && wstr == L"1.5 w" &&
+            allocations == before)
+            std::cout << "[+] Test 24 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 24 Failed" << std::endl;
+    }
+
+    /// A runtime format string compiled once: checked against the argument types when it is built, then formatted
+    /// without parsing (and without allocating, into a buffer).
+    {
+        std::string configured = "{:>5}|{:.2f}|{}{{}}|{:{}}";
+        __gnu_cxx::v23::compiled_format<int, double, std::string, int, int> line(configured);
+        __gnu_cxx::v23::wcompiled_format<int, const wchar_t*> wline(L"{:#x} {}");
+        bool bad = false, out_of_range = false;
+        try { __gnu_cxx::v23::compiled_format<double> f("{:d}"); } catch (const __gnu_cxx::v23::format_error&) { bad = true; }
+        try { __gnu_cxx::v23::compiled_format<int> f("{} {}"); } catch (const __gnu_cxx::v23::format_error&) { out_of_range = true; }
+
+        __gnu_cxx::v23::basic_memory_buffer<char> buf;
+        auto before = allocations;
+        for (int i = 0; i < 3; ++i)
+            __gnu_cxx::v23::format_to(std::back_inserter(buf), line, 42, 3.14159, "ok", 7, 3);
+        bool quiet = allocations == before;
+        if (bad && out_of_range && quiet && buf.view() == "   42|3.14|ok{}|  7   42|3.14|ok{}|  7   42|3.14|ok{}|  7" &&
+            __gnu_cxx::v23::vformat(line, 1, 0.5, "", 10, 0) == "    1|0.50|{}|10" && line.segments() == 4 &&
+            __gnu_cxx::v23::formatted_size(line, 42, 3.14159, "ok", 7, 3) == 19 && __gnu_cxx::v23::wformat(wline, 255, L"w") == L"0xff w")
+            std::cout << "[+] Test 25 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 25 Failed" << std::endl;
+    }
+
+    /// The cache compiles a format string once per address, evicts the least recently used one, and recompiles when an
+    /// address holds other text.
+    {
+        __gnu_cxx::v23::format_cache<int> cache(2);
+        char first[] = "[{}]", second[] = "<{}>", third[] = "({})";
+        auto* compiled = &cache.get(first);
+        bool hit = &cache.get(first) == compiled;
+        cache.get(second);
+        cache.get(first);
+        cache.get(third);
+        bool evicted = cache.size() == 2 && &cache.get(first) == compiled && cache.get(second).format(1) == "<1>";
+        first[0] = '{', first[3] = '}', first[1] = '{', first[2] = '}';
+        bool changed = cache.get(first).format(2) == "{}";
+        std::string configured = "{} took {:.1f} ms";
+        if (hit && evicted && changed && __gnu_cxx::v23::vcformat(configured, "load", 1.25) == "load took 1.2 ms" &&
+            __gnu_cxx::v23::vcformat(configured, "save", 2.0) == "save took 2.0 ms" && __gnu_cxx::v23::wcformat(L"{}{}", 1, L'x') == L"1x")
+            std::cout << "[+] Test 26 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 26 Failed" << std::endl;
+    }
+    /// Ranges and tuples are formatted element by element: sequences in brackets, sets and maps in braces, strings and
+    /// characters quoted, with a spec for the whole range ('n', 'm', fill and width) and one for every element.
+    {
+        std::vector<int> ints = { 1, 2, 3 };
+        std::vector<std::string> words = { "a", "b\"c", "d\n" };
+        std::map<int, std::string> names = { { 1, "one" }, { 2, "two" } };
+        std::vector<std::vector<int>> nested = { { 1 }, { 2, 3 } };
+        std::vector<std::pair<int, char>> pairs = { { 1, 'x' } };
+        __gnu_cxx::v23::range_formatter<int> custom;
+        custom.set_brackets("<", ">");
+        custom.set_separator("|");
+        __gnu_cxx::v23::memory_buffer buf;
+        __gnu_cxx::v23::format_context ctx(__gnu_cxx::v23::__detail::buffer_appender<char>(buf), {});
+        custom.format(ints, ctx);
+        if (__gnu_cxx::v23::vformat("{} {::#x} {:n} {:*^13}", ints, ints, ints, ints) == "[1, 2, 3] [0x1, 0x2, 0x3] 1, 2, 3 **[1, 2, 3]**" &&
+            __gnu_cxx::v23::vformat("{} {::>3}", words, words) == "[\"a\", \"b\\\"c\", \"d\\n\"] [  a, b\"c,  d\n]" &&
+            __gnu_cxx::v23::vformat("{} {} {:m}", names, std::set<char> { 'b', 'a' }, pairs) == "{1: \"one\", 2: \"two\"} {'a', 'b'} {1: 'x'}" &&
+            __gnu_cxx::v23::vformat("{} {::n}", nested, nested) == "[[1], [2, 3]] [1, 2, 3]" &&
+            __gnu_cxx::v23::vformat("{} {:n} {:::.1f}", std::tuple<int, double, const char*> { 1, 2.5, "x" }, std::pair<int, int> { 3, 4 },
+                std::array<std::pair<double, double>, 1> { { { 0.25, 1.0 } } }) == "(1, 2.5, \"x\") 3, 4 [(0.2, 1.0)]" &&
+            __gnu_cxx::v23::wformat(L"{}", std::vector<std::wstring> { L"w" }) == L"[\"w\"]" && buf.view() == "<1|2|3>")
+            std::cout << "[+] Test 27 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 27 Failed" << std::endl;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <random>
+#include "../src/frozen_map.h"
+
+
+enum class errc { ok, not_found, denied, timeout };
+
+/// Built by the compiler, the static_asserts below run on it.
+constexpr auto opcodes = __gnu_cxx::v23::make_frozen_map<std::string_view, int>({
+    { "add", 1 }, { "sub", 2 }, { "mul", 3 }, { "div", 4 }, { "mod", 5 }, { "and", 6 }, { "or", 7 }, { "xor", 8 },
+    { "not", 9 }, { "shl", 10 }, { "shr", 11 }, { "load", 12 }, { "store", 13 }, { "jmp", 14 }, { "jz", 15 },
+    { "jnz", 16 }, { "call", 17 }, { "ret", 18 }, { "push", 19 }, { "pop", 20 }, { "nop", 21 }, { "halt", 22 } });
+static_assert(opcodes.at("ret") == 18 && opcodes["add"] == 1 && !opcodes.contains("addx") && opcodes.size() == 22);
+static_assert(opcodes.begin()->first == "add" && opcodes.lower_bound("k")->first == "load");
+
+constexpr auto errors = __gnu_cxx::v23::make_frozen_map<errc, std::string_view>({
+    { errc::timeout, "timeout" }, { errc::ok, "ok" }, { errc::denied, "denied" }, { errc::not_found, "not found" } });
+static_assert(errors.at(errc::denied) == "denied" && errors.begin()->first == errc::ok);
+
+constexpr auto ports = __gnu_cxx::v23::make_frozen_set<int>({ 443, 80, 22, 8080, 25 });
+static_assert(ports.contains(22) && !ports.contains(21) && *ports.begin() == 22 && ports.count(8080) == 1);
+
+/// 500 integral keys, every one found in its place and nothing else found.
+constexpr auto squares = []()
+{
+    std::array<std::pair<std::uint32_t, std::uint32_t>, 500> e{};
+    for (std::uint32_t i = 0; i < 500; ++i)
+        e[i] = { (i * 2654435761u) % 100000u, i };
+    return __gnu_cxx::v23::frozen_flat_map<std::uint32_t, std::uint32_t, 500>(e);
+}();
+
+int main() 
+{
+    bool same = true;
+    for (std::uint32_t i = 0; i < 500; ++i)
+        same = same && squares.at((i * 2654435761u) % 100000u) == i;
+    std::mt19937 rng(16);
+    std::size_t found = 0;
+    for (int i = 0; i < 100000; ++i)
+        found += squares.count(rng() % 100000u);
+    std::size_t expected = 0;
+    for (std::uint32_t key = 0; key < 100000; ++key)
+        expected += squares.count(key);
+    if (same && expected == 500 && found > 0 && std::is_sorted(squares.begin(), squares.end()))
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 1 Failed" << std::endl;
+
+    /// Lookups with runtime strings, of every length.
+    std::string name = "sto";
+    name += "re";
+    bool threw = false;
+    try { (void)opcodes.at(std::string_view(name).substr(1)); } catch (const std::out_of_range&) { threw = true; }
+    if (opcodes.at(std::string_view(name)) == 13 && opcodes.find(std::string_view("")) == opcodes.end() && threw &&
+        errors[errc::timeout] == "timeout" && ports.lower_bound(100) == ports.begin() + 3)
+        std::cout << "[+] Test 2 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 2 Failed" << std::endl;
+};
@@ -0,0 +1,127 @@
+#define V23_INSTRUMENT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
+#include "../src/print.h"
+
+
+int main()
+{
+    namespace v23 = __gnu_cxx::v23;
+    std::string path = "/tmp/v23_instrument_" + std::to_string(::getpid());
+
+    /// Formatting counts calls, characters and allocations, the strings that outgrow SSO and buffers that outgrow
+    /// their inline storage allocate.
+    auto before = v23::snapshot_counters();
+    auto s1 = v23::vformat("{}-{}", 12, 34);
+    auto s2 = v23::vformat("{:>40}", "right");
+    auto s3 = v23::vformat("{:>600}", 'x');
+    std::string s4;
+    v23::format_to(std::back_inserter(s4), "{}{}", "ab", 'c');
+    auto d1 = v23::snapshot_counters().totals - before.totals;
+    if (d1.format_calls == 4 && d1.bytes_formatted == s1.size() + s2.size() + s3.size() + s4.size() && d1.print_calls == 0 &&
+        d1.allocations == 3 && d1.buffer_grows == 2 && d1.writes == 0)
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 1 Failed" << std::endl;
+
+    /// Prints to an output file count the flushes and the write(2) calls of its descriptor, characters formatted into a
+    /// buffer that is written out in the middle of a print are counted too.
+    int fd = -1;
+    before = v23::snapshot_counters();
+    {
+        v23::output_file file(path.c_str(), v23::flush_policy::manual, 64);
+        fd = file.descriptor();
+        for (int i = 0; i < 10; ++i)
+            v23::println(file, "line {:>3} of the file", i);
+        v23::print(file, "{:>100}", "long");
+        file.flush();
+    }
+    auto after = v23::snapshot_counters();
+    auto d2 = after.totals - before.totals;
+    bool stream = false;
+    for (auto& c : after.streams)
+        if (c.descriptor == fd && c.bytes_written >= 10 * 21 + 100 && c.flushes == c.writes && c.writes > 3)
+            stream = true;
+    if (d2.format_calls == 11 && d2.print_calls == 11 && d2.bytes_formatted == 10 * 20 + 100 && d2.bytes_written == 10 * 21 + 100 &&
+        d2.flushes == d2.writes && d2.allocations == 0 && stream)
+        std::cout << "[+] Test 2 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 2 Failed" << std::endl;
+    ::unlink(path.c_str());
+
+    /// Counters of other threads are added up, the ones of threads that exited included, per format string as well.
+    before = v23::snapshot_counters();
+    std::thread worker([]()
+    {
+        for (int i = 0; i < 100; ++i)
+            (void) v23::vformat("worker {}", i);
+    });
+    worker.join();
+    std::uint64_t reports = 0, reported = 0;
+    {
+        v23::counters_reporter reporter(std::chrono::milliseconds(1), [&](const v23::counters_snapshot& s)
+        {
+            ++reports;
+            reported = s.totals.format_calls;
+        });
+        for (int i = 0; i < 5; ++i)
+            (void) v23::wformat(L"wide {}", i);
+    }
+    after = v23::snapshot_counters();
+    bool worker_site = false, wide_site = false;
+    for (auto& c : after.call_sites)
+    {
+        if (c.format == "worker {}" && c.calls == 100 && c.bytes == 100 * 7 + 10 + 90 * 2)
+            worker_site = true;
+        if (c.format == "wide {}" && c.calls == 5 && c.bytes == 5 * 6)
+            wide_site = true;
+    }
+    if (worker_site && wide_site && (after.totals - before.totals).format_calls == 105 && reports >= 1 &&
+        reported == after.totals.format_calls && !after.call_sites.empty() && after.call_sites.front().bytes >= after.call_sites.back().bytes)
+        std::cout << "[+] Test 3 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 3 Failed" << std::endl;
+
+    /// Format strings are counted by their text: runtime strings that reuse one buffer are told apart, one text at two
+    /// addresses is one call site, and the call sites of a thread past the cap are counted together.
+    {
+        char buf[16] = "alpha {}", copy[16] = "alpha {}";
+        for (int i = 0; i < 3; ++i)
+            (void) v23::vformat(v23::runtime_format(std::string_view(buf)), i);
+        std::memcpy(buf, "omega {}", 8);
+        for (int i = 0; i < 2; ++i)
+            (void) v23::vformat(v23::runtime_format(std::string_view(buf)), i);
+        (void) v23::vformat(v23::runtime_format(std::string_view(copy)), 9);
+
+        char site[32];
+        for (int i = 0; i < 2000; ++i)
+        {
+            auto n = std::snprintf(site, sizeof(site), "site %d {}", i);
+            (void) v23::vformat(v23::runtime_format(std::string_view(site, static_cast<std::size_t>(n))), i);
+        }
+        auto snapshot = v23::snapshot_counters();
+        std::uint64_t alpha = 0, omega = 0, sites = 0, site_calls = 0, other = 0;
+        for (auto& c : snapshot.call_sites)
+        {
+            if (c.format == "alpha {}")
+                alpha = c.calls;
+            else if (c.format == "omega {}")
+                omega = c.calls;
+            else if (c.format == "(other)")
+                other = c.calls;
+            else if (c.format.starts_with("site "))
+            {
+                ++sites;
+                site_calls += c.calls;
+            }
+        }
+        if (alpha == 4 && omega == 2 && sites < v23::__detail::max_call_sites && other != 0 && site_calls + other == 2000)
+            std::cout << "[+] Test 4 Passing" << std::endl;
+        else
+            std::cout << "[-] Test 4 Failed (" << alpha << ", " << omega << ", " << sites << ", " << other << ")" << std::endl;
+    }
+};
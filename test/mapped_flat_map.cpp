@@ -0,0 +1,96 @@
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include "../src/mapped_flat_map.h"
+
+
+struct point
+{
+    float x, y;
+};
+
+int main() 
+{
+    std::string path = "/tmp/v23_mapped_flat_map_" + std::to_string(::getpid());
+
+    /// A map with erased elements is saved without them, the mapping finds, bounds and iterates like the map.
+    std::mt19937_64 rng(15);
+    __gnu_cxx::v23::flat_map<std::uint64_t, double> map;
+    for (int i = 0; i < 20000; ++i)
+        map.insert(rng() % 100000, i * 0.5);
+    for (int i = 0; i < 3000; ++i)
+        map.erase(rng() % 100000);
+    __gnu_cxx::v23::save_flat_map(map, path);
+    {
+        __gnu_cxx::v23::mapped_flat_map<std::uint64_t, double> mapped(path, __gnu_cxx::v23::map_verify::full);
+        bool same = mapped.size() == map.size();
+        auto it = map.begin();
+        for (auto [key, value] : mapped)
+            same = same && it != map.end() && key == it->first && value == it->second && ++it != map.begin();
+        same = same && it == map.end();
+        for (std::uint64_t key = 0; key < 100000; key += 7)
+        {
+            auto it = map.lower_bound(key);
+            auto m = mapped.lower_bound(key);
+            same = same && mapped.contains(key) == map.contains(key) && (it == map.end() ? m == mapped.end() : m->first == it->first) &&
+                (mapped.find(key) == mapped.end()) == (map.find(key) == map.end());
+        }
+        if (same && mapped.keys().size() == map.size() && reinterpret_cast<std::uintptr_t>(mapped.keys().data()) % 64 == 0)
+            std::cout << "[+] Test 1 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 1 Failed" << std::endl;
+    }
+
+    /// Other key types, structs as values, and empty maps round trip, moving keeps the mapping.
+    {
+        __gnu_cxx::v23::flat_map<int, point> points { { 3, { 1, 2 } }, { -1, { 3, 4 } } };
+        __gnu_cxx::v23::save_flat_map(points, path);
+        __gnu_cxx::v23::mapped_flat_map<int, point> first(path);
+        auto second = std::move(first);
+        __gnu_cxx::v23::save_flat_map(__gnu_cxx::v23::flat_map<int, point>(), path + "e");
+        __gnu_cxx::v23::mapped_flat_map<int, point> empty(path + "e", __gnu_cxx::v23::map_verify::full);
+        bool threw = false;
+        try { (void)second.at(2); } catch (const std::out_of_range&) { threw = true; }
+        if (first.empty() && second.size() == 2 && second.begin()->first == -1 && second.at(3).y == 2 && threw && empty.empty() &&
+            empty.begin() == empty.end())
+            std::cout << "[+] Test 2 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 2 Failed" << std::endl;
+        std::remove((path + "e").c_str());
+    }
+
+    /// Damaged values are caught by a full check (a header check does not read them), other types, damaged headers and
+    /// truncated files by either.
+    {
+        __gnu_cxx::v23::save_flat_map(map, path);
+        auto fails = [&](auto tag, __gnu_cxx::v23::map_verify how)
+        {
+            try { decltype(tag) mapped(path, how); } catch (const __gnu_cxx::v23::mapped_file_error&) { return true; }
+            return false;
+        };
+        using right = __gnu_cxx::v23::mapped_flat_map<std::uint64_t, double>;
+        using wrong = __gnu_cxx::v23::mapped_flat_map<std::uint32_t, double>;
+        auto poke = [&](std::streamoff at)
+        {
+            std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+            f.seekg(at);
+            char c = static_cast<char>(f.get());
+            f.seekp(at);
+            f.put(static_cast<char>(c ^ 1));
+        };
+        bool types = fails(wrong(), __gnu_cxx::v23::map_verify::header);
+        poke(static_cast<std::streamoff>(std::filesystem::file_size(path) - 3));
+        bool values = fails(right(), __gnu_cxx::v23::map_verify::full) && !fails(right(), __gnu_cxx::v23::map_verify::header);
+        poke(40);
+        bool header = fails(right(), __gnu_cxx::v23::map_verify::header);
+        poke(40);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+        bool truncated = fails(right(), __gnu_cxx::v23::map_verify::header);
+        if (types && values && header && truncated)
+            std::cout << "[+] Test 3 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 3 Failed" << std::endl;
+    }
+    std::remove(path.c_str());
+};
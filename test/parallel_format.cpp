@@ -0,0 +1,101 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <tuple>
+#include <unistd.h>
+#include "../src/parallel_format.h"
+
+
+/// A record formatted as a whole.
+struct metric
+{
+    int id;
+    double value;
+};
+template<>
+struct __gnu_cxx::v23::formatter<metric, char> : __gnu_cxx::v23::formatter<int, char>
+{
+    auto format(const metric& m, __gnu_cxx::v23::format_context& ctx) const
+    {
+        return __gnu_cxx::v23::format_to(ctx.out(), "m{}={:.1f}", m.id, m.value);
+    };
+};
+
+/// @brief Reads a whole file.
+static std::string read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+int main()
+{
+    namespace v23 = __gnu_cxx::v23;
+
+    /// Tuple-like records are formatted with their elements as the arguments, chunks come back in order whatever
+    /// thread formatted them.
+    std::vector<std::tuple<int, std::string, double>> rows;
+    std::string expected;
+    for (int i = 0; i < 10000; ++i)
+    {
+        rows.emplace_back(i, "row" + std::to_string(i % 7), i * 0.5);
+        expected += v23::vformat("{},{},{:.2f}\n", i, "row" + std::to_string(i % 7), i * 0.5);
+    }
+    v23::format_pool pool(4);
+    pool.set_chunk_size(100);
+    std::string csv = pool.join(rows, "{},{},{:.2f}\n");
+    if (csv == expected && v23::format_range(rows, "{},{},{:.2f}\n") == expected && pool.concurrency() == 4)
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 1 Failed" << std::endl;
+
+    /// Other records are the single argument, separators go between records (and so between chunks too).
+    std::vector<metric> metrics = { { 1, 0.5 }, { 2, 1.25 }, { 3, -2.0 } };
+    std::vector<int> numbers(1000);
+    std::string numbers_expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        numbers[i] = i;
+        numbers_expected += (i == 0 ? "" : "; ") + std::to_string(i);
+    }
+    v23::memory_buffer buf;
+    pool.join_to(buf, metrics, "[{:}]", ", ");
+    if (v23::format_join(metrics, "[{}]", ", ") == "[m1=0.5], [m2=1.2], [m3=-2.0]" && buf.view() == "[m1=0.5], [m2=1.2], [m3=-2.0]" &&
+        pool.join(numbers, "{}", "; ") == numbers_expected && v23::format_join(std::vector<int>(), "{}", ",").empty())
+        std::cout << "[+] Test 2 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 2 Failed" << std::endl;
+
+    /// Written out with writev(2), to a descriptor and to an output file after what was already printed to it.
+    std::string path = "/tmp/v23_parallel_format_" + std::to_string(::getpid());
+    std::size_t written = 0, joined = 0;
+    {
+        v23::output_file file(path.c_str(), v23::flush_policy::manual);
+        v23::println(file, "id,name,value");
+        written = pool.write(file, rows, "{},{},{:.2f}\n");
+        joined = v23::format_join(file.descriptor(), numbers, "{}", "; ");
+    }
+    if (written == expected.size() && joined == numbers_expected.size() &&
+        read_file(path) == "id,name,value\n" + expected + numbers_expected)
+        std::cout << "[+] Test 3 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 3 Failed" << std::endl;
+    ::unlink(path.c_str());
+
+    /// A formatting error on a worker is rethrown on the calling thread, and the pool keeps working.
+    bool thrown = false;
+    try
+    {
+        (void) pool.join(numbers, v23::runtime_format("{:d}{}"));
+    }
+    catch (const v23::format_error&)
+    {
+        thrown = true;
+    }
+    if (thrown && pool.join(numbers, "{}", "; ") == numbers_expected)
+        std::cout << "[+] Test 4 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 4 Failed" << std::endl;
+};
@@ -1,4 +1,11 @@
-#include "../src/print.h"
+#define V23_PRINT_THREAD_LOCAL_BUFFER
+#include <array>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "allocations.h"
+#include "../src/async_print.h"
 
 int main() 
 {
@@ -6,4 +13,243 @@ int main()
     __gnu_cxx::v23::vprintln_unicode("This is Printing with a FILE*");
     __gnu_cxx::v23::vprintln_unicode("Now we are printing with non-unicode characters...");
     __gnu_cxx::v23::vprintln_nonunicode(L"Alpha:  Beta: β");
-};
\ No newline at end of file
+
+    FILE* null = std::fopen("/dev/null", "w");
+    std::string line(2000, '-');
+
+    /// The first call grows the thread-local buffer, every call after it has to reuse it.
+    __gnu_cxx::v23::vprint(null, "{} {}\n", line, 0);
+    auto before = allocations;
+    for (int i = 0; i < 1000; ++i)
+    {
+        __gnu_cxx::v23::vprint(null, "{} {} {}\n", line, i, 0.5 * i);
+        __gnu_cxx::v23::vprintln_unicode(null, "{:>8}|{:<8}|", i, "short");
+    }
+    if (allocations == before)
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 1 Failed (" << allocations - before << " allocations)" << std::endl;
+
+    std::fclose(null);
+
+    /// Reads what is waiting in the pipe without blocking.
+    int fds[2];
+    if (::pipe(fds) != 0 || ::fcntl(fds[0], F_SETFL, O_NONBLOCK) != 0)
+        return 1;
+    auto drain = [&]()
+    {
+        std::string s;
+        char chunk[4096];
+        for (ssize_t n; (n = ::read(fds[0], chunk, sizeof(chunk))) > 0; )
+            s.append(chunk, static_cast<std::size_t>(n));
+        return s;
+    };
+
+    {
+        __gnu_cxx::v23::output_file out(fds[1], __gnu_cxx::v23::flush_policy::manual);
+        std::string expected;
+        for (int i = 0; i < 100; ++i)
+        {
+            __gnu_cxx::v23::println(out, "line {} {:.2f}", i, i / 3.0);
+            expected += __gnu_cxx::v23::vformat("line {} {:.2f}\n", i, i / 3.0);
+        }
+        bool buffered = drain().empty();
+        out.flush();
+        if (buffered && drain() == expected)
+            std::cout << "[+] Test 2 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 2 Failed" << std::endl;
+    }
+
+    {
+        __gnu_cxx::v23::output_file out(fds[1], __gnu_cxx::v23::flush_policy::line);
+        __gnu_cxx::v23::print(out, "{}-", "partial");
+        bool held = drain().empty();
+        __gnu_cxx::v23::println(out, "{}", "done");
+        bool line = drain() == "partial-done\n";
+
+        /// A print that fills the buffer up is written out partway through, the newline it ends up with lands before
+        ///     where the print started in the buffer and is still found.
+        std::string head(40, 'h'), body(20, 'b'), tail = "\n" + std::string(45, 't');
+        {
+            __gnu_cxx::v23::output_file small(fds[1], __gnu_cxx::v23::flush_policy::line, 64);
+            __gnu_cxx::v23::print(small, "{}", head);
+            __gnu_cxx::v23::print(small, "{}{}", body, tail);
+            line = line && drain() == head + body + tail;
+        }
+        if (held && line)
+            std::cout << "[+] Test 3 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 3 Failed" << std::endl;
+    }
+
+    /// A print longer than the buffer is written out in pieces, the rest on destruction.
+    {
+        std::string wide(1000, 'w');
+        {
+            __gnu_cxx::v23::output_file out(fds[1], __gnu_cxx::v23::flush_policy::threshold, 64);
+            __gnu_cxx::v23::print(out, "[{}]", wide);
+            __gnu_cxx::v23::print(out, "{}", 7);
+        }
+        if (drain() == "[" + wide + "]7")
+            std::cout << "[+] Test 4 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 4 Failed" << std::endl;
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    /// Reads a whole file back.
+    auto slurp = [](FILE* f)
+    {
+        std::string s;
+        char chunk[4096];
+        off_t at = 0;
+        for (ssize_t n; (n = ::pread(::fileno(f), chunk, sizeof(chunk), at)) > 0; at += n)
+            s.append(chunk, static_cast<std::size_t>(n));
+        return s;
+    };
+
+    /// Every message of every thread arrives, in the order of its thread, strings are copied (the temporaries are gone
+    /// by the time they are written) and messages too long for a slot are formatted on the calling thread.
+    {
+        FILE* tmp = std::tmpfile();
+        __gnu_cxx::v23::output_file out(tmp, __gnu_cxx::v23::flush_policy::manual);
+        constexpr int threads = 4, count = 2000;
+        std::string expected[threads];
+        for (int t = 0; t < threads; ++t)
+            for (int i = 0; i < count; ++i)
+                expected[t] += __gnu_cxx::v23::vformat("t{} {} {} {:.1f}\n", t, i,
+                    i % 100 == 0 ? std::string(300, 'x') : std::to_string(i * 7), i * 0.5);
+
+        std::string actual[threads];
+        {
+            __gnu_cxx::v23::async_printer printer(out, 64);
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t)
+                workers.emplace_back([&, t]()
+                {
+                    for (int i = 0; i < count; ++i)
+                        __gnu_cxx::v23::println(printer, "t{} {} {} {:.1f}", t, i,
+                            i % 100 == 0 ? std::string(300, 'x') : std::to_string(i * 7), i * 0.5);
+                });
+            for (auto& w : workers)
+                w.join();
+            printer.flush();
+
+            std::string all = slurp(tmp);
+            for (std::size_t b = 0, e; (e = all.find('\n', b)) != std::string::npos; b = e + 1)
+                actual[all[b + 1] - '0'] += all.substr(b, e - b + 1);
+        }
+        bool same = true;
+        for (int t = 0; t < threads; ++t)
+            same = same && actual[t] == expected[t];
+        if (same)
+            std::cout << "[+] Test 5 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 5 Failed" << std::endl;
+        std::fclose(tmp);
+    }
+
+    /// With a tiny queue some messages are dropped, whatever is not written out is counted and reported.
+    {
+        FILE* tmp = std::tmpfile();
+        constexpr int count = 20000;
+        std::uint64_t dropped;
+        {
+            __gnu_cxx::v23::output_file out(tmp, __gnu_cxx::v23::flush_policy::manual);
+            __gnu_cxx::v23::async_printer printer(out, 2, __gnu_cxx::v23::overflow_policy::count_drops);
+            for (int i = 0; i < count; ++i)
+                __gnu_cxx::v23::println(printer, "message {}", i);
+            printer.flush();
+            dropped = printer.dropped();
+        }
+        std::string all = slurp(tmp);
+        std::uint64_t written = 0, reported = 0;
+        for (std::size_t b = 0, e; (e = all.find('\n', b)) != std::string::npos; b = e + 1)
+        {
+            if (all.compare(b, 8, "message ") == 0)
+                ++written;
+            else
+                reported += std::stoull(all.substr(b + 1));
+        }
+        if (written + dropped == count && reported == dropped)
+            std::cout << "[+] Test 6 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 6 Failed (" << written << " written, " << dropped << " dropped, " << reported << " reported)" << std::endl;
+        std::fclose(tmp);
+    }
+
+    /// Ranges and tuples print straight into an output file (and through a std::ostream).
+    {
+        FILE* tmp = std::tmpfile();
+        std::vector<std::pair<std::string, int>> scores = { { "ann", 3 }, { "bob", 5 } };
+        {
+            __gnu_cxx::v23::output_file out(tmp, __gnu_cxx::v23::flush_policy::manual);
+            __gnu_cxx::v23::println(out, "{} {:m}", std::vector<int> { 1, 2 }, scores);
+            __gnu_cxx::v23::print(out, "{:n}", std::array<char, 2> { 'a', 'b' });
+        }
+        std::ostringstream os;
+        __gnu_cxx::v23::println(os, "{}", std::tuple<int, const char*> { 7, "seven" });
+        if (slurp(tmp) == "[1, 2] {\"ann\": 3, \"bob\": 5}\n'a', 'b'" && os.str() == "(7, \"seven\")\n")
+            std::cout << "[+] Test 7 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 7 Failed" << std::endl;
+        std::fclose(tmp);
+    }
+
+    /// A bad runtime format string is reported by throwing format_error out of every print, nothing is printed and the
+    ///     scratch buffer is still usable after it.
+    {
+        auto bad = __gnu_cxx::v23::runtime_format("{:d}");
+        int thrown = 0;
+        auto attempt = [&](auto print_call)
+        {
+            try { print_call(); }
+            catch (const __gnu_cxx::v23::format_error&) { ++thrown; }
+        };
+        std::ostringstream os;
+        FILE* tmp = std::tmpfile();
+        attempt([&]() { __gnu_cxx::v23::print(bad, "x"); });
+        attempt([&]() { __gnu_cxx::v23::println(bad, "x"); });
+        attempt([&]() { __gnu_cxx::v23::print(os, bad, "x"); });
+        attempt([&]() { __gnu_cxx::v23::println(os, bad, "x"); });
+        attempt([&]() { __gnu_cxx::v23::vprint(tmp, bad, "x"); });
+        attempt([&]() { __gnu_cxx::v23::vprintln_unicode(tmp, bad, "x"); });
+        __gnu_cxx::v23::println(os, "{} {}", "after", 1);
+        std::fflush(tmp);
+        if (thrown == 6 && os.str() == "after 1\n" && slurp(tmp).empty())
+            std::cout << "[+] Test 8 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 8 Failed (" << thrown << " thrown)" << std::endl;
+        std::fclose(tmp);
+    }
+
+    /// Runtime format strings printed from a background thread are copied (overwritten right after the print), literal
+    ///     ones are only referenced and leave the whole slot to the arguments.
+    {
+        FILE* tmp = std::tmpfile();
+        std::string expected;
+        {
+            __gnu_cxx::v23::output_file out(tmp, __gnu_cxx::v23::flush_policy::manual);
+            __gnu_cxx::v23::async_printer printer(out, 8);
+            std::string fmt;
+            for (int i = 0; i < 50; ++i)
+            {
+                fmt = "runtime " + std::to_string(i) + " {}";
+                __gnu_cxx::v23::println(printer, __gnu_cxx::v23::runtime_format(fmt), i * 3);
+                expected += "runtime " + std::to_string(i) + " " + std::to_string(i * 3) + "\n";
+                fmt.assign(fmt.size(), '#');
+            }
+            std::string wide(200, 'w');
+            __gnu_cxx::v23::print(printer, "literal {} {}|", wide, 7);
+            expected += "literal " + wide + " 7|";
+            printer.flush();
+        }
+        if (slurp(tmp) == expected)
+            std::cout << "[+] Test 9 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 9 Failed" << std::endl;
+        std::fclose(tmp);
+    }
+};
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <thread>
+#include "../src/snapshot_map.h"
+
+
+/// A value that counts its live instances, to see that replaced snapshots are freed.
+static std::atomic<long> live = 0;
+struct counted
+{
+    int value = 0;
+    counted(int v = 0) : value(v) { ++live; }
+    counted(const counted& o) : value(o.value) { ++live; }
+    counted& operator=(const counted&) = default;
+    ~counted() { --live; }
+};
+
+int main() 
+{
+    __gnu_cxx::v23::snapshot_map<int, int> map;
+    map.insert(1, 10);
+    map.insert(2, 20);
+    auto before = map.read();
+    bool unseen = !map.contains(1) && map.staged() == 2;
+    map.insert(1, 11);
+    map.erase(2);
+    map.insert(3, 30);
+    map.commit();
+    if (unseen && before->empty() && map.get(1) == 11 && !map.get(2) && map.get(3) == 30 && map.staged() == 0)
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 1 Failed" << std::endl;
+    before.release();
+
+    /// A held snapshot keeps its contents through later commits (which free it once it is let go of), update() and
+    /// publish() replace them.
+    auto held = map.read();
+    map.update([](auto& m) { m.insert(4, 40); m.erase(1); });
+    auto updated = map.read();
+    map.publish(__gnu_cxx::v23::flat_map<int, int> { { 9, 90 } });
+    if (held->size() == 2 && held->at(1) == 11 && updated->size() == 2 && updated->at(4) == 40 && map.read()->size() == 1 && map.get(9) == 90)
+        std::cout << "[+] Test 2 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 2 Failed" << std::endl;
+    bool kept = map.reclaim() != 0;
+    held.release();
+    updated.release();
+    if (kept && map.reclaim() == 0)
+        std::cout << "[+] Test 3 Passing" << std::endl;
+    else 
+        std::cout << "[-] Test 3 Failed" << std::endl;
+
+    /// Readers racing a writer only ever see whole commits, never going back, and every replaced snapshot gets freed.
+    {
+        constexpr int keys = 256, commits = 300, threads = 4;
+        __gnu_cxx::v23::snapshot_map<int, counted> versions;
+        for (int key = 0; key < keys; ++key)
+            versions.insert(key, 0);
+        versions.commit();
+
+        std::atomic<bool> done = false, torn = false;
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads; ++t)
+            readers.emplace_back([&]()
+            {
+                int last = 0;
+                while (!done.load())
+                {
+                    auto s = versions.read();
+                    int version = s->at(0).value;
+                    for (int key = 1; key < keys; ++key)
+                        if (s->at(key).value != version)
+                            torn = true;
+                    if (version < last || s->size() != keys)
+                        torn = true;
+                    last = version;
+                }
+            });
+        for (int c = 1; c <= commits; ++c)
+        {
+            for (int key = 0; key < keys; ++key)
+                versions.insert(key, c);
+            versions.commit();
+        }
+        done = true;
+        for (auto& r : readers)
+            r.join();
+        bool freed = versions.reclaim() == 0 && live == keys;
+        if (!torn && freed && versions.get(keys - 1)->value == commits)
+            std::cout << "[+] Test 4 Passing" << std::endl;
+        else 
+            std::cout << "[-] Test 4 Failed (" << live << " live values)" << std::endl;
+    }
+};
@@ -0,0 +1,73 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include "../src/print.h"
+
+
+/// @brief Reads a whole file.
+static std::string read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+int main()
+{
+    namespace v23 = __gnu_cxx::v23;
+
+    /// Text with code points of every length, between runs of ASCII longer than a vector, goes from UTF-8 to UTF-16 and
+    /// UTF-32 and back unchanged.
+    std::string ascii(100, 'a');
+    std::string text = ascii + "β" + ascii + "日本" + "x" + "\U0001f600" + ascii + "é";
+    std::u32string text32 = v23::to_u32string(text);
+    std::u16string text16 = v23::to_u16string(text);
+    std::u32string expected32 = std::u32string(100, U'a') + U"β" + std::u32string(100, U'a') + U"日本x\U0001f600" +
+        std::u32string(100, U'a') + U"é";
+    if (text32 == expected32 && text16.size() == expected32.size() + 1 && v23::to_utf8(text32) == text && v23::to_utf8(text16) == text &&
+        v23::to_wstring(text) == std::wstring(expected32.begin(), expected32.end()) && v23::to_utf8(v23::to_wstring(text)) == text &&
+        v23::is_valid_utf(text) && v23::is_valid_utf(text16) && v23::is_valid_utf(text32) && v23::to_utf8(std::wstring_view()).empty())
+        std::cout << "[+] Test 1 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 1 Failed" << std::endl;
+
+    /// Invalid input is rejected, and replaced with U+FFFD over its maximal subparts when transcoding: overlong forms,
+    /// surrogates, code points past U+10FFFF, stray continuations and cut off sequences.
+    std::u32string r = U"�";
+    if (!v23::is_valid_utf("\xc0\x80") && !v23::is_valid_utf("\xe0\x80\x80") && !v23::is_valid_utf("\xed\xa0\x80") &&
+        !v23::is_valid_utf("\xf4\x90\x80\x80") && !v23::is_valid_utf(ascii + "\x80") && !v23::is_valid_utf("\xe2\x82") &&
+        !v23::is_valid_utf(std::u16string_view(u"a\xd800")) && !v23::is_valid_utf(std::u32string_view(U"\x110000")) &&
+        v23::to_u32string("a\xe2\x82" "b") == U"a" + r + U"b" && v23::to_u32string("\xf0\x80\x80") == r + r + r &&
+        v23::to_u32string(ascii + "\xff") == std::u32string(100, U'a') + r && v23::to_utf8(std::u16string(u"\xdc00x")) == "�x" &&
+        v23::to_utf8(std::u32string(U"\xd800")) == "�")
+        std::cout << "[+] Test 2 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 2 Failed" << std::endl;
+
+    /// Wide prints come out as UTF-8 whatever the locale is, to streams, stdio and output files (one smaller than a line,
+    /// so the line is written out in pieces that split code points).
+    std::string path = "/tmp/v23_utf_" + std::to_string(::getpid());
+    std::wstring greek(300, L'β');
+    {
+        v23::output_file file(path.c_str(), v23::flush_policy::manual, 64);
+        v23::println(file, L"Alpha: {} Beta: {:>3}", L'α', 42);
+        v23::print(file, L"{}", greek);
+    }
+    std::ostringstream stream;
+    v23::println(stream, L"日{}", L"本");
+    v23::vprintln_unicode(stream, L"{} \U0001f600", 1);
+    FILE* fp = std::tmpfile();
+    v23::vprintln_nonunicode(fp, L"été {}", 2023);
+    std::rewind(fp);
+    char line[32] = {};
+    std::size_t read = std::fread(line, 1, sizeof(line), fp);
+    std::fclose(fp);
+    if (read_file(path) == "Alpha: α Beta:  42\n" + v23::to_utf8(greek) && v23::to_utf8(greek).size() == 600 &&
+        stream.str() == "日本\n1 \U0001f600\n" && std::string(line, read) == "été 2023\n")
+        std::cout << "[+] Test 3 Passing" << std::endl;
+    else
+        std::cout << "[-] Test 3 Failed" << std::endl;
+    ::unlink(path.c_str());
+};
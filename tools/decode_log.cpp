@@ -0,0 +1,39 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "../src/binary_print.h"
+
+
+/// Renders a binary log (see binary_log in src/binary_print.h) as text on stdout.
+/// Usage: decode_log [-t] <file>, -t starts every message with the UTC time it was logged at.
+int main(int argc, char** argv)
+{
+    bool timestamps = argc > 1 && std::strcmp(argv[1], "-t") == 0;
+    if (argc != 2 + timestamps)
+    {
+        std::fprintf(stderr, "usage: %s [-t] <file>\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream in(argv[1 + timestamps], std::ios::binary);
+    if (!in)
+    {
+        std::fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1 + timestamps]);
+        return 1;
+    }
+    std::stringstream data;
+    data << in.rdbuf();
+
+    try
+    {
+        __gnu_cxx::v23::output_file out(STDOUT_FILENO);
+        __gnu_cxx::v23::decode_binary_log(data.view(), out, timestamps);
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 1;
+    }
+    return 0;
+}